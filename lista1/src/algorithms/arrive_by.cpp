@@ -0,0 +1,113 @@
+#include "arrive_by.h"
+
+namespace {
+
+// Kolejka maksymalna – najpóźniejsza etykieta na szczycie, remisy po identyfikatorze przystanku
+bool earlier(const heap_entry &a, const heap_entry &b) {
+    if (a.key == b.key) {
+        return a.tie < b.tie;
+    }
+    return a.key < b.key;
+}
+
+// Slot etykiety odejścia pieszo z przystanku (za slotami par przystanek-linia, jak w query_workspace::begin)
+uint32_t walk_slot(const timetable &tt, uint32_t stop) {
+    return static_cast<uint32_t>(tt.slot_count()) + 1 + stop;
+}
+
+} // namespace
+
+std::pair<std::vector<edge>, double> latest_departure(const timetable &tt,
+                                                      query_workspace &ws,
+                                                      const std::string &start,
+                                                      const std::string &end,
+                                                      const std::chrono::system_clock::time_point &deadline) {
+    const uint32_t source = tt.stop_id(start);
+    const uint32_t target = tt.stop_id(end);
+    if (source == timetable::NONE || target == timetable::NONE) {
+        return {{}, -1.0};
+    }
+    if (source == target) {
+        return {{}, 0.0};
+    }
+
+    // Etykieta: najpóźniejszy moment obecności na przystanku oraz krawędź, którą z niego odjeżdżamy
+    // (parent – następna etykieta w stronę celu). Wyszukiwanie obejmuje dzień kursowania terminu
+    // i poprzedni (przejazdy przez północ)
+    const auto horizon = tt.day_start(tt.day_of(deadline) - 1);
+    ws.begin(tt);
+    ws.mark(target);
+    ws.best_time(target) = deadline;
+    const uint32_t root = ws.add_label({target, timetable::NONE, timetable::NONE, timetable::NONE, 0, deadline});
+    ws.push({time_key(deadline), target, root}, earlier);
+
+    while (!ws.heap_empty()) {
+        const uint32_t index = ws.pop(earlier).label;
+        const search_label current = ws.label(index);
+        const uint32_t stop = current.stop;
+        const bool on_foot = tt.is_walk(current.edge);
+        const uint32_t slot = on_foot ? walk_slot(tt, stop) : stop;
+        // Odjazd pojazdem nie wcześniejszy niż odejście pieszo dominuje je
+        if (ws.settled(slot) || (on_foot && ws.has(stop) && ws.best_time(stop) >= current.time)) {
+            SEARCH_COUNT(ws.stats(), dominated_labels, 1);
+            continue;
+        }
+        ws.settle(slot);
+        const auto time = current.time;
+
+        if (stop == source) {
+            size_t length = 0;
+            for (uint32_t l = index; ws.label(l).edge != timetable::NONE; l = ws.label(l).parent) {
+                ++length;
+            }
+            std::vector<edge> route;
+            route.reserve(length);
+            for (uint32_t l = index; ws.label(l).edge != timetable::NONE; l = ws.label(l).parent) {
+                const search_label &leg = ws.label(l);
+                if (tt.is_walk(leg.edge)) {
+                    const uint32_t w = tt.walk_index(leg.edge);
+                    route.push_back(tt.walk_leg(leg.stop, tt.walk_from(w), leg.time, tt.walk_time(w)));
+                } else {
+                    route.push_back(tt.edge_at(leg.edge, leg.time - tt.departure_of(leg.edge)));
+                }
+            }
+            double cost = std::chrono::duration_cast<std::chrono::seconds>(deadline - time).count();
+            return {std::move(route), cost};
+        }
+
+        // Połączenia przyjeżdżające na przystanek nie później niż etykieta tworzą sufiks zakresu
+        tt.for_each_arrival(stop, horizon, time, [&](uint32_t pos, timetable::duration shift) {
+            const uint32_t from = tt.in_from(pos);
+            const auto departure = tt.in_dep(pos) + shift;
+            SEARCH_COUNT(ws.stats(), edges_scanned, 1);
+            if (!ws.settled(from) && (!ws.has(from) || departure > ws.best_time(from))) {
+                SEARCH_COUNT(ws.stats(), edges_relaxed, 1);
+                ws.mark(from);
+                ws.best_time(from) = departure;
+                const uint32_t next = ws.add_label({from, tt.in_edge(pos), index, timetable::NONE, 0, departure});
+                ws.push({time_key(departure), from, next}, earlier);
+            }
+        });
+
+        // Przejścia piesze z pobliskich przystanków – są symetryczne, więc wystarczy lista bieżącego.
+        // Po przejściu pieszym wsiada się do pojazdu, więc z etykiety odejścia pieszo nie idzie się dalej pieszo
+        if (on_foot) {
+            continue;
+        }
+        for (uint32_t w = tt.walk_begin(stop); w < tt.walk_end(stop); ++w) {
+            const uint32_t from = tt.walk_to(w);
+            const uint32_t from_slot = walk_slot(tt, from);
+            const auto departure = time - tt.walk_time(w);
+            SEARCH_COUNT(ws.stats(), edges_scanned, 1);
+            if (!ws.settled(from_slot) && (!ws.has(from_slot) || departure > ws.best_time(from_slot)) &&
+                (!ws.has(from) || departure > ws.best_time(from))) {
+                SEARCH_COUNT(ws.stats(), edges_relaxed, 1);
+                ws.mark(from_slot);
+                ws.best_time(from_slot) = departure;
+                const uint32_t next = ws.add_label({from, tt.walk_id(w), index, timetable::NONE, 0, departure});
+                ws.push({time_key(departure), from, next}, earlier);
+            }
+        }
+    }
+    return {{}, -1.0};
+}
@@ -0,0 +1,33 @@
+#ifndef ARRIVE_BY_H
+#define ARRIVE_BY_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include "../graph/edge.h"
+#include "../graph/timetable.h"
+#include "../algorithms_utils/query_workspace.h"
+
+/**
+ * @brief Wyszukiwanie wsteczne: najpóźniejszy odjazd pozwalający dotrzeć na czas.
+ *
+ * Algorytm Dijkstry działający od przystanku docelowego po połączeniach przychodzących
+ * (indeks przychodzący rozkładu). Etykietą przystanku jest najpóźniejszy moment, w którym można na nim być
+ * i nadal zdążyć do celu przed `deadline`; z kolejki zdejmowane są najpierw etykiety najpóźniejsze.
+ * Jedno zapytanie zastępuje wyszukiwanie binarne po czasie odjazdu z wielokrotnym dijkstra_time.
+ *
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania należąca do bieżącego wątku.
+ * @param start Nazwa przystanku początkowego.
+ * @param end Nazwa przystanku docelowego.
+ * @param deadline Najpóźniejszy dopuszczalny czas przyjazdu do celu.
+ * @return std::pair<std::vector<edge>, double> Trasa oraz koszt – liczba sekund między najpóźniejszym
+ *         odjazdem (route.front().getDepartureTime()) a `deadline`; {pusta trasa, -1.0}, jeśli nie da się zdążyć.
+ */
+std::pair<std::vector<edge>, double> latest_departure(const timetable &tt,
+                                                      query_workspace &ws,
+                                                      const std::string &start,
+                                                      const std::string &end,
+                                                      const std::chrono::system_clock::time_point &deadline);
+
+#endif // ARRIVE_BY_H
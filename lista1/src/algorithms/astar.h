@@ -2,14 +2,13 @@
 #define ASTAR_H
 
 #include <iostream>
-#include <queue>
 #include <vector>
 #include <string>
-#include <unordered_map>
 #include <chrono>
 #include <cmath>
-#include <sstream>
 #include "../graph/edge.h"
+#include "../graph/timetable.h"
+#include "../algorithms_utils/query_workspace.h"
 
 /**
  * @brief Stała do przeliczenia stopni na radiany.
@@ -30,81 +29,77 @@ double haversine(double lat1, double lon1, double lat2, double lon2);
 /**
  * @brief Funkcja heurystyczna szacująca czas przejazdu pomiędzy przystankami.
  *
- * @param current Nazwa przystanku początkowego.
- * @param target Nazwa przystanku docelowego.
- * @param edges Lista krawędzi (używana do wyznaczenia współrzędnych przystanków).
+ * Współrzędne i zbiory linii przystanków pochodzą z rozkładu, a wynik dla danego przystanku
+ * jest zapamiętywany w przestrzeni roboczej do końca zapytania.
+ *
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza bieżącego zapytania.
+ * @param current Identyfikator przystanku początkowego.
+ * @param target Identyfikator przystanku docelowego (stały w obrębie zapytania).
  * @return std::chrono::system_clock::duration Szacowany czas podróży.
  */
-std::chrono::system_clock::duration heuristic(const std::string &current,
-                                                const std::string &target,
-                                                const std::vector<edge> &edges);
-
-/**
- * @struct AStarState
- * @brief Reprezentuje stan w algorytmie A* optymalizującym czas przejazdu.
- */
-struct AStarState {
-    std::string stop;  ///< Aktualny przystanek
-    std::chrono::system_clock::time_point time;  ///< Rzeczywisty czas przybycia (g)
-    std::vector<edge> route;  ///< Dotychczasowa trasa (ciąg krawędzi)
-    std::chrono::system_clock::time_point estimated; ///< Szacowany koszt f = g + h
-
-    bool operator>(const AStarState &other) const;
-};
+std::chrono::system_clock::duration heuristic(const timetable &tt,
+                                                query_workspace &ws,
+                                                uint32_t current,
+                                                uint32_t target);
 
 /**
  * @brief Funkcja A* wyszukująca trasę o minimalnym czasie przejazdu z uwzględnieniem heurystyki.
  *
- * @param adj Wygenerowany graf (lista sąsiedztwa).
- * @param edges Lista krawędzi (do celów obliczeń heurystycznych).
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania należąca do bieżącego wątku.
  * @param start Nazwa przystanku początkowego.
  * @param end Nazwa przystanku docelowego.
  * @param startTime Czas rozpoczęcia podróży.
  * @return std::pair<std::vector<edge>, double> Para zawierająca wyznaczoną trasę oraz koszt trasy (czas w sekundach).
  */
 std::pair<std::vector<edge>, double> astar_time(
-    const std::unordered_map<std::string, std::vector<edge>>& adj,
-    const std::vector<edge>& edges,
+    const timetable& tt,
+    query_workspace& ws,
     const std::string &start,
     const std::string &end,
     const std::chrono::system_clock::time_point &startTime);
 
-/**
- * @brief Struktura stanu dla A* optymalizującego liczbę przesiadek.
- */
-struct TransferState {
-    std::string stop;  ///< Aktualny przystanek
-    std::chrono::system_clock::time_point time;  ///< Czas przybycia
-    int transfers;     ///< Liczba przesiadek wykonanych do tej pory
-    std::vector<edge> route;  ///< Dotychczasowa trasa (ciąg krawędzi)
-    int estimated;     ///< Szacowany koszt f = transfers (tu h = 0)
-
-    bool operator>(const TransferState &other) const;
-};
-
-/**
- * @brief Struktura przechowująca najlepszy stan dla danego przystanku.
- */
-struct BestState {
-    int transfers;  ///< Minimalna liczba przesiadek dotychczas uzyskana
-    std::chrono::system_clock::time_point time; ///< Najwcześniejszy czas przybycia dla tej liczby przesiadek
-};
-
 /**
  * @brief Funkcja A* wyszukująca trasę o minimalnej liczbie przesiadek.
  *
- * @param adj Wygenerowany graf (lista sąsiedztwa).
- * @param edges Lista krawędzi.
+ * Dla każdego przystanku pamiętany jest najlepszy stan: minimalna liczba przesiadek oraz
+ * najwcześniejszy czas przybycia przy tej liczbie przesiadek.
+ *
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania należąca do bieżącego wątku.
  * @param start Nazwa przystanku początkowego.
  * @param end Nazwa przystanku docelowego.
  * @param startTime Czas rozpoczęcia podróży.
  * @return std::pair<std::vector<edge>, double> Para zawierająca wyznaczoną trasę oraz koszt trasy (liczba przesiadek).
  */
 std::pair<std::vector<edge>, double> astar_change(
-    std::unordered_map<std::string, std::vector<edge>>& adj,
-    const std::vector<edge>& edges,
+    const timetable& tt,
+    query_workspace& ws,
     const std::string &start,
     const std::string &end,
     const std::chrono::system_clock::time_point &startTime);
 
+/**
+ * @brief Jak astar_change, ale dopisuje odcinki trasy do `legs` zamiast budować listę krawędzi edge.
+ *
+ * Używana przez Tabu Search do oceny porządków przystanków – fragmenty tras trzymane są w arenie
+ * zapytania, a krawędzie odtwarzane tylko dla zwracanej trasy.
+ *
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania należąca do bieżącego wątku.
+ * @param start Nazwa przystanku początkowego.
+ * @param end Nazwa przystanku docelowego.
+ * @param startTime Czas rozpoczęcia podróży.
+ * @param legs Wektor, na którego koniec dopisywane są odcinki trasy.
+ * @return double Liczba przesiadek; -1.0, jeśli trasy nie znaleziono (0.0 bez odcinków, gdy start == end).
+ */
+double astar_change_legs(
+    const timetable& tt,
+    query_workspace& ws,
+    const std::string &start,
+    const std::string &end,
+    const std::chrono::system_clock::time_point &startTime,
+    std::pmr::vector<route_leg> &legs);
+
 #endif // ASTAR_H
@@ -3,103 +3,126 @@
 //
 
 #include "dijkstra.h"
+#include "label_setting_engine.h"
 
-bool State::operator>(const State& other) const {
-    return time > (other.time);
-}
+#include <numeric>
 
-bool StateChange::operator>(const StateChange &other) const {
-    return transfers > other.transfers;
-}
+namespace {
+
+// Kryterium czasowe bez heurystyki
+typedef label_setting_engine<earliest_arrival, no_heuristic, min_key_queue> earliest_arrival_search;
+// Etykiety indeksowane parą (przystanek, linia przyjazdu); kolejka tylko po liczbie przesiadek
+typedef label_setting_engine<fewest_transfers_by_line, no_heuristic, min_key_queue> fewest_transfers_search;
 
+} // namespace
 
-std::pair<std::vector<edge>, double> dijkstra_time(std::unordered_map<std::string, std::vector<edge>>& adj,
+
+std::pair<std::vector<edge>, double> dijkstra_time(const timetable& tt,
+                                                   query_workspace& ws,
                                                    const std::string& start,
                                                    const std::string& end,
                                                    const std::chrono::system_clock::time_point& startTime) {
+    if (start == end) {
+        return {{}, 0.0};
+    }
+    const uint32_t source = tt.stop_id(start);
+    const uint32_t target = tt.stop_id(end);
+    if (source == timetable::NONE || target == timetable::NONE) {
+        return {{}, -1.0};
+    }
 
-    std::unordered_map<std::string, std::chrono::system_clock::time_point> best;
-    best[start] = startTime;
-
-    std::priority_queue<State, std::vector<State>, std::greater<State>> pq;
-    pq.push({start, startTime, {}});
-
-    while (!pq.empty()) {
-        State current = pq.top();
-        pq.pop();
-
-        if (current.stop == end) {
-            // Obliczamy funkcję kosztu: różnica czasu w sekundach
-            double cost = std::chrono::duration_cast<std::chrono::seconds>(current.time - startTime).count();
-            return {current.route, cost};
-        }
-
-        if (adj.find(current.stop) == adj.end()) {
-            continue;
-        }
-
-        for (const auto &e : adj[current.stop]) {
-            if (e.getDepartureTime() >= current.time) {
-                auto arrival = e.getArrivalTime();
-                if (best.find(e.getEndStop()) == best.end() || arrival < best[e.getEndStop()]) {
-                    best[e.getEndStop()] = arrival;
-                    std::vector<edge> newRoute = current.route;
-                    newRoute.push_back(e);
-                    pq.push({e.getEndStop(), arrival, newRoute});
-                }
-            }
-        }
+    // Wyszukiwanie obejmuje dzień kursowania zapytania i następny (przejazdy przez północ)
+    const auto horizon = tt.day_start(tt.day_of(startTime) + 2);
+    const uint32_t found = earliest_arrival_search(tt, ws).run(source, target, startTime, horizon);
+    if (found == timetable::NONE) {
+        // Jeśli nie znaleziono trasy, zwracamy pustą trasę oraz koszt równy -1 (lub inną wartość sygnalizującą błąd)
+        return {{}, -1.0};
     }
-    // Jeśli nie znaleziono trasy, zwracamy pustą trasę oraz koszt równy -1 (lub inną wartość sygnalizującą błąd)
-    return {{}, -1.0};
+    // Obliczamy funkcję kosztu: różnica czasu w sekundach
+    double cost = std::chrono::duration_cast<std::chrono::seconds>(ws.label(found).time - startTime).count();
+    return {ws.route_to(tt, found), cost};
 }
 
-std::pair<std::vector<edge>, double> dijkstra_change(std::unordered_map<std::string, std::vector<edge>>& adj,
-                                                  const std::string& start,
-                                                  const std::string& end,
-                                                  const std::chrono::system_clock::time_point& startTime) {
-
-
-    std::unordered_map<std::string, std::unordered_map<std::string, int>> best;
-    std::priority_queue<StateChange, std::vector<StateChange>, std::greater<StateChange>> pq;
-    pq.push({start, startTime, 0, "", {}});
-    best[start][""] = 0;
-
-    while (!pq.empty()) {
-        StateChange current = pq.top();
-        pq.pop();
-
-        if (current.stop == end) {
-            return {current.route, current.transfers};
-        }
-
-        if (adj.find(current.stop) == adj.end()) {
+std::vector<std::pair<std::vector<edge>, double>> dijkstra_time_many(const timetable& tt,
+                                                                    query_workspace& ws,
+                                                                    const std::string& start,
+                                                                    const std::vector<std::string>& ends,
+                                                                    const std::chrono::system_clock::time_point& startTime) {
+    std::vector<std::pair<std::vector<edge>, double>> results(ends.size(), {{}, -1.0});
+    const uint32_t source = tt.stop_id(start);
+    if (source == timetable::NONE) {
+        return results;
+    }
+    // Cele różne od startu i występujące w rozkładzie oraz ich pozycje w `ends`
+    std::vector<uint32_t> targets;
+    std::vector<size_t> positions;
+    for (size_t i = 0; i < ends.size(); ++i) {
+        if (ends[i] == start) {
+            results[i] = {{}, 0.0};
             continue;
         }
-
-        for (const auto &e : adj[current.stop]) {
-            if (e.getDepartureTime() >= current.time) {
-                int new_transfers = current.transfers;
-                std::string next_line = e.getLine();
-
-                if (!current.current_line.empty() && current.current_line != next_line) {
-                    new_transfers++;
-                }
-
-                auto arrival = e.getArrivalTime();
-                if (best[e.getEndStop()].find(next_line) == best[e.getEndStop()].end() ||
-                    new_transfers < best[e.getEndStop()][next_line]) {
-                    best[e.getEndStop()][next_line] = new_transfers;
-                    std::vector<edge> newRoute = current.route;
-                    newRoute.push_back(e);
-                    pq.push({e.getEndStop(), arrival, new_transfers, next_line, newRoute});
-                }
-            }
+        const uint32_t target = tt.stop_id(ends[i]);
+        if (target != timetable::NONE) {
+            targets.push_back(target);
+            positions.push_back(i);
         }
     }
-    // Jeśli nie znaleziono trasy, zwracamy pustą trasę oraz koszt równy -1 (lub inną wartość sygnalizującą błąd)
-    return {{}, -1.0};
+    if (targets.empty()) {
+        return results;
+    }
+
+    const auto horizon = tt.day_start(tt.day_of(startTime) + 2);
+    const std::vector<uint32_t> found = earliest_arrival_search(tt, ws).run_many(source, targets, startTime, horizon);
+    for (size_t k = 0; k < found.size(); ++k) {
+        if (found[k] == timetable::NONE) continue;
+        double cost = std::chrono::duration_cast<std::chrono::seconds>(ws.label(found[k]).time - startTime).count();
+        results[positions[k]] = {ws.route_to(tt, found[k]), cost};
+    }
+    return results;
 }
 
+void dijkstra_time_all(const timetable& tt,
+                       query_workspace& ws,
+                       uint32_t source,
+                       const std::chrono::system_clock::time_point& startTime,
+                       std::vector<int32_t>& seconds) {
+    std::vector<uint32_t> targets(tt.stop_count());
+    std::iota(targets.begin(), targets.end(), 0);
+    const auto horizon = tt.day_start(tt.day_of(startTime) + 2);
+    const std::vector<uint32_t> found = earliest_arrival_search(tt, ws).run_many(source, targets, startTime, horizon);
+    seconds.resize(found.size());
+    for (size_t stop = 0; stop < found.size(); ++stop) {
+        seconds[stop] = found[stop] == timetable::NONE
+                            ? -1
+                            : static_cast<int32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                                                       ws.label(found[stop]).time - startTime).count());
+    }
+}
 
+std::pair<std::vector<edge>, double> dijkstra_change(const timetable& tt,
+                                                     query_workspace& ws,
+                                                     const std::string& start,
+                                                     const std::string& end,
+                                                     const std::chrono::system_clock::time_point& startTime) {
+    if (start == end) {
+        return {{}, 0.0};
+    }
+    const uint32_t source = tt.stop_id(start);
+    const uint32_t target = tt.stop_id(end);
+    if (source == timetable::NONE || target == timetable::NONE) {
+        return {{}, -1.0};
+    }
 
+    // Najpierw w dniu kursowania zapytania – inaczej trasa z tą samą liczbą przesiadek mogłaby czekać do rana;
+    // następny dzień dopiero, gdy tego dnia trasy nie ma
+    const int32_t day = tt.day_of(startTime);
+    fewest_transfers_search search(tt, ws);
+    uint32_t found = search.run(source, target, startTime, tt.day_start(day + 1));
+    if (found == timetable::NONE) {
+        found = search.run(source, target, startTime, tt.day_start(day + 2));
+    }
+    if (found == timetable::NONE) {
+        return {{}, -1.0};
+    }
+    return {ws.route_to(tt, found), ws.label(found).transfers};
+}
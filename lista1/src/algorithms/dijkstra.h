@@ -7,59 +7,11 @@
 
 #include <iostream>
 #include <vector>
-#include <queue>
-#include <unordered_map>
 #include <string>
 #include <chrono>
 #include "../graph/edge.h"  // Pełna definicja klasy edge
-
-/**
- * @struct State
- * @brief Reprezentuje stan w algorytmie Dijkstry, przyjmowany jako element kolejki priorytetowej.
- *
- * Struktura ta przechowuje informacje o aktualnym przystanku, czasie przybycia oraz ścieżce (ciągu krawędzi)
- * prowadzącej do tego przystanku.
- */
-struct State {
-    std::string stop;  ///< Nazwa aktualnego przystanku
-    std::chrono::system_clock::time_point time;  ///< Czas przybycia na ten przystanek
-    std::vector<edge> route;  ///< Ścieżka (ciąg krawędzi) prowadząca do przystanku
-
-    /**
-     * @brief Operator porównania wykorzystywany przez kolejkę priorytetową.
-     *
-     * Porównuje stany na podstawie czasu przybycia (mniejsze czasy mają wyższy priorytet).
-     *
-     * @param other Inny stan do porównania.
-     * @return true, jeśli czas bieżącego stanu jest większy od czasu stanu 'other'.
-     */
-    bool operator>(const State& other) const;
-};
-
-/**
- * @struct StateChange
- * @brief Reprezentuje stan w algorytmie Dijkstry uwzględniającym liczbę przesiadek.
- *
- * Oprócz danych z klasy State, struktura ta przechowuje liczbę przesiadek oraz
- * nazwę ostatniej użytej linii komunikacyjnej. Umożliwia to wyszukiwanie tras o minimalnej liczbie przesiadek.
- */
-struct StateChange {
-    std::string stop;  ///< Nazwa aktualnego przystanku
-    std::chrono::system_clock::time_point time;  ///< Czas przybycia na przystanek
-    int transfers;  ///< Liczba wykonanych przesiadek
-    std::string current_line; ///< Nazwa ostatniej użytej linii (początkowo pusta)
-    std::vector<edge> route;  ///< Ścieżka prowadząca do tego stanu
-
-    /**
-     * @brief Operator porównania wykorzystywany przez kolejkę priorytetową.
-     *
-     * Porównuje stany na podstawie liczby przesiadek (mniejsza liczba ma wyższy priorytet).
-     *
-     * @param other Inny stan do porównania.
-     * @return true, jeśli liczba przesiadek w bieżącym stanie jest większa niż w stanie 'other'.
-     */
-    bool operator>(const StateChange& other) const;
-};
+#include "../graph/timetable.h"
+#include "../algorithms_utils/query_workspace.h"
 
 /**
  * @brief Funkcja Dijkstry wyszukująca najkrótszą trasę według kryterium czasu.
@@ -67,27 +19,71 @@ struct StateChange {
  * Funkcja przeszukuje graf (przedstawiony jako lista krawędzi) od przystanku startowego do docelowego,
  * wybierając trasy o najkrótszym czasie przejazdu. Funkcja wykorzystuje kolejkę priorytetową,
  * a funkcję kosztu definiuje jako różnicę czasu (w sekundach) między momentem przybycia a czasem rozpoczęcia.
+ * Z przystanku przeglądane są tylko połączenia odjeżdżające nie wcześniej niż czas przybycia
+ * (wyszukiwanie binarne w indeksie CSR rozkładu).
  *
- * @param adj Wygenerowany graf
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania (etykiety i kolejka) należąca do bieżącego wątku.
  * @param start Nazwa przystanku początkowego.
  * @param end Nazwa przystanku docelowego.
  * @param startTime Czas rozpoczęcia podróży.
  * @return std::pair<std::vector<edge>, double> Para, gdzie pierwszy element to wyznaczona trasa,
  *         a drugi element to koszt trasy (różnica czasu w sekundach). W przypadku braku trasy zwraca parę {pusta trasa, -1.0}.
  */
-std::pair<std::vector<edge>, double> dijkstra_time(std::unordered_map<std::string, std::vector<edge>>& adj,
+std::pair<std::vector<edge>, double> dijkstra_time(const timetable& tt,
+                                query_workspace& ws,
                                 const std::string& start,
                                 const std::string& end,
                                 const std::chrono::system_clock::time_point& startTime
                                 );
 
+/**
+ * @brief Funkcja Dijkstry wyszukująca najkrótsze trasy według kryterium czasu z jednego przystanku do wielu.
+ *
+ * Jedno przeszukiwanie (jeden-do-wielu) zamiast osobnego dijkstra_time dla każdego celu: kończy się, gdy
+ * wszystkie cele zostaną osiągnięte. Koszt każdej trasy jest taki sam jak w dijkstra_time; przy kilku
+ * trasach o tym samym czasie przyjazdu wybrana może być inna z nich.
+ *
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania należąca do bieżącego wątku.
+ * @param start Nazwa przystanku początkowego.
+ * @param ends Nazwy przystanków docelowych.
+ * @param startTime Czas rozpoczęcia podróży.
+ * @return std::vector<std::pair<std::vector<edge>, double>> Wynik dla każdego celu (w kolejności `ends`),
+ *         jak z dijkstra_time.
+ */
+std::vector<std::pair<std::vector<edge>, double>> dijkstra_time_many(const timetable& tt,
+                                query_workspace& ws,
+                                const std::string& start,
+                                const std::vector<std::string>& ends,
+                                const std::chrono::system_clock::time_point& startTime);
+
+/**
+ * @brief Najwcześniejsze przyjazdy z jednego przystanku do wszystkich – jedno przeszukiwanie jeden-do-wszystkich.
+ *
+ * Wiersz macierzy czasów przejazdu: bez odtwarzania tras, czasy jak koszty dijkstra_time.
+ *
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza należąca do bieżącego wątku (arenę zeruje wywołujący).
+ * @param source Identyfikator przystanku początkowego (timetable::stop_id).
+ * @param startTime Czas rozpoczęcia podróży.
+ * @param seconds Wypełniany czas dojazdu do każdego przystanku w sekundach (-1 – nieosiągalny); rozmiar tt.stop_count().
+ */
+void dijkstra_time_all(const timetable& tt,
+                       query_workspace& ws,
+                       uint32_t source,
+                       const std::chrono::system_clock::time_point& startTime,
+                       std::vector<int32_t>& seconds);
+
 /**
  * @brief Funkcja Dijkstry wyszukująca trasę z uwzględnieniem liczby przesiadek.
  *
  * Funkcja wyszukuje trasę od przystanku startowego do docelowego, minimalizując liczbę przesiadek.
  * W algorytmie brane są pod uwagę zmiany linii – każda zmiana linii zwiększa licznik przesiadek.
+ * Najlepsza liczba przesiadek pamiętana jest osobno dla każdej pary (przystanek, linia przyjazdu).
  *
- * @param edges Lista krawędzi reprezentujących połączenia.
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania należąca do bieżącego wątku.
  * @param start Nazwa przystanku początkowego.
  * @param end Nazwa przystanku docelowego.
  * @param startTime Czas rozpoczęcia podróży.
@@ -95,7 +91,8 @@ std::pair<std::vector<edge>, double> dijkstra_time(std::unordered_map<std::strin
  *         a drugi element to koszt trasy (liczba przesiadek). Jeśli trasa nie zostanie znaleziona,
  *         zwracana jest para {pusta trasa, -1.0}.
  */
-std::pair<std::vector<edge>, double> dijkstra_change(std::unordered_map<std::string, std::vector<edge>>& adj,
+std::pair<std::vector<edge>, double> dijkstra_change(const timetable& tt,
+                                query_workspace& ws,
                                 const std::string& start,
                                 const std::string& end,
                                 const std::chrono::system_clock::time_point& startTime);
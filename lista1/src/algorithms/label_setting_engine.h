@@ -0,0 +1,428 @@
+#ifndef LABEL_SETTING_ENGINE_H
+#define LABEL_SETTING_ENGINE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+#include "../graph/timetable.h"
+#include "../algorithms_utils/query_workspace.h"
+
+/**
+ * @file label_setting_engine.h
+ * @brief Wspólny silnik przeszukiwania etykiet (Dijkstra, A*) z politykami wybieranymi przy kompilacji.
+ *
+ * Wyszukiwania dijkstra_time, dijkstra_change, astar_time i astar_change różnią się tylko kryterium
+ * (co jest etykietą, kiedy etykieta dominuje inną, jaki jest klucz kolejki), heurystyką i porządkiem
+ * kolejki. Każda z tych części jest parametrem szablonu label_setting_engine, więc w pętli głównej
+ * porównania i heurystyka rozwijane są w miejscu, bez rozgałęzień w czasie wykonania.
+ *
+ * Kryterium (Criterion) udostępnia:
+ *  - root_slot / departure_slot / walk_slot (i wait_slot) – indeks etykiety w przestrzeni roboczej,
+ *  - improves / record – dominację i zapis najlepszej etykiety, improves_on_foot – dominację dojścia
+ *    pieszego (ma własny slot, bo po nim nie wolno iść dalej pieszo, a przyjazd pojazdem – tak),
+ *  - stale – pomijanie nieaktualnych wpisów kolejki,
+ *  - entry – klucz kolejki dla liczby przesiadek i czasu (z dodaną heurystyką),
+ *  - stałe counts_transfers (czy etykiety liczą przesiadki), compares_time (czy dominacja zależy od
+ *    czasu przyjazdu), target_bound (odcinanie połączeń przyjeżdżających nie wcześniej niż znany
+ *    przyjazd do celu), waits (etykiety oczekiwania na przystanku, co WAIT), walks_first (przejścia
+ *    piesze przed odjazdami) i rare_improvements (połączenie rzadko poprawia etykietę – nowa etykieta
+ *    powstaje poza pętlą przeglądu, która nie przygotowuje jej dla każdego połączenia).
+ */
+
+/// Heurystyka zerowa – silnik działa jak algorytm Dijkstry.
+struct no_heuristic {
+    std::chrono::system_clock::duration operator()(const timetable &, query_workspace &, uint32_t, uint32_t) const {
+        return std::chrono::system_clock::duration::zero();
+    }
+};
+
+/// Kolejka minimalna po kluczu (odpowiednik std::priority_queue z std::greater).
+struct min_key_queue {
+    bool operator()(const heap_entry &a, const heap_entry &b) const {
+        return a.key > b.key;
+    }
+};
+
+/// Kolejka minimalna po kluczu, a przy remisie – po kluczu rozstrzygającym.
+struct lexicographic_queue {
+    bool operator()(const heap_entry &a, const heap_entry &b) const {
+        if (a.key == b.key) {
+            return a.tie > b.tie;
+        }
+        return a.key > b.key;
+    }
+};
+
+/**
+ * @struct earliest_arrival
+ * @brief Kryterium czasowe: etykieta na przystanek, najlepsza jest najwcześniejsza.
+ *
+ * Dojście piesze ma osobny slot za slotami linii – późniejszy przyjazd pojazdem nie jest przez nie
+ * odrzucany, bo tylko z niego można iść dalej pieszo.
+ */
+struct earliest_arrival {
+    typedef std::chrono::system_clock::time_point time_point;
+
+    static constexpr bool counts_transfers = false;
+    static constexpr bool compares_time = true;
+    static constexpr bool target_bound = true;
+    static constexpr bool waits = false;
+    static constexpr bool walks_first = false;
+    static constexpr bool rare_improvements = false;
+
+    static uint32_t root_slot(const timetable &, uint32_t source) { return source; }
+    static uint32_t departure_slot(const timetable &tt, uint32_t pos) { return tt.out_to(pos); }
+    static uint32_t walk_slot(const timetable &tt, uint32_t to) { return static_cast<uint32_t>(tt.slot_count()) + 1 + to; }
+
+    static bool improves(query_workspace &ws, uint32_t slot, int32_t, const time_point &time) {
+        return !ws.has(slot) || time < ws.best_time(slot);
+    }
+    // Przyjazd pojazdem nie później niż dojście piesze dominuje je – z niego można jeszcze iść pieszo
+    static bool improves_on_foot(const timetable &tt, query_workspace &ws, uint32_t to, int32_t,
+                                 const time_point &time) {
+        return improves(ws, walk_slot(tt, to), 0, time) && improves(ws, to, 0, time);
+    }
+    static void record(query_workspace &ws, uint32_t slot, int32_t, const time_point &time) {
+        ws.best_time(slot) = time;
+    }
+    // Przystanek osiągnięto już wcześniej i stamtąd przejrzano połączenia
+    static bool stale(const timetable &tt, query_workspace &ws, const search_label &label) {
+        if (tt.is_walk(label.edge)) {
+            return label.time > ws.best_time(walk_slot(tt, label.stop)) || !improves(ws, label.stop, 0, label.time);
+        }
+        return label.time > ws.best_time(label.stop);
+    }
+    static heap_entry entry(int32_t, const time_point &estimate, uint32_t label) {
+        return {time_key(estimate), 0, label};
+    }
+};
+
+/**
+ * @struct fewest_transfers_by_line
+ * @brief Kryterium przesiadkowe: etykieta na parę (przystanek, linia przyjazdu), najlepsza ma najmniej przesiadek.
+ *
+ * Stan początkowy ma własny slot za slotami linii, a dojścia piesze – po jednym slocie na przystanek.
+ */
+struct fewest_transfers_by_line {
+    typedef std::chrono::system_clock::time_point time_point;
+
+    static constexpr bool counts_transfers = true;
+    static constexpr bool compares_time = false;
+    static constexpr bool target_bound = false;
+    static constexpr bool waits = false;
+    static constexpr bool walks_first = false;
+    static constexpr bool rare_improvements = false;
+
+    static uint32_t root_slot(const timetable &tt, uint32_t) { return static_cast<uint32_t>(tt.slot_count()); }
+    static uint32_t departure_slot(const timetable &tt, uint32_t pos) { return tt.out_slot(pos); }
+    static uint32_t walk_slot(const timetable &tt, uint32_t to) { return static_cast<uint32_t>(tt.slot_count()) + 1 + to; }
+
+    static bool improves(query_workspace &ws, uint32_t slot, int32_t transfers, const time_point &) {
+        return !ws.has(slot) || transfers < ws.best_transfers(slot);
+    }
+    static bool improves_on_foot(const timetable &tt, query_workspace &ws, uint32_t to, int32_t transfers,
+                                 const time_point &time) {
+        return improves(ws, walk_slot(tt, to), transfers, time);
+    }
+    static void record(query_workspace &ws, uint32_t slot, int32_t transfers, const time_point &) {
+        ws.best_transfers(slot) = transfers;
+    }
+    static bool stale(const timetable &, query_workspace &, const search_label &) { return false; }
+    static heap_entry entry(int32_t transfers, const time_point &, uint32_t label) {
+        return {transfers, 0, label};
+    }
+};
+
+/**
+ * @struct fewest_transfers_then_arrival
+ * @brief Kryterium przesiadkowe z czasem: etykieta na przystanek, porządek (przesiadki, przyjazd).
+ *
+ * Dopuszcza oczekiwanie na przystanku (o WAIT) na późniejsze połączenie. Dojście piesze ma osobny slot,
+ * jak w earliest_arrival.
+ */
+struct fewest_transfers_then_arrival {
+    typedef std::chrono::system_clock::time_point time_point;
+
+    static constexpr bool counts_transfers = true;
+    static constexpr bool compares_time = true;
+    static constexpr bool target_bound = false;
+    static constexpr bool waits = true;
+    static constexpr bool walks_first = true;
+    static constexpr bool rare_improvements = true;
+    static constexpr std::chrono::minutes WAIT{15};
+
+    static uint32_t root_slot(const timetable &, uint32_t source) { return source; }
+    static uint32_t departure_slot(const timetable &tt, uint32_t pos) { return tt.out_to(pos); }
+    static uint32_t walk_slot(const timetable &tt, uint32_t to) { return static_cast<uint32_t>(tt.slot_count()) + 1 + to; }
+    static uint32_t wait_slot(const timetable &, uint32_t stop) { return stop; }
+
+    static bool improves(query_workspace &ws, uint32_t slot, int32_t transfers, const time_point &time) {
+        return !ws.has(slot) || transfers < ws.best_transfers(slot) ||
+               (transfers == ws.best_transfers(slot) && time < ws.best_time(slot));
+    }
+    // Jak w earliest_arrival: dojście piesze musi poprawić też etykietę przyjazdu pojazdem
+    static bool improves_on_foot(const timetable &tt, query_workspace &ws, uint32_t to, int32_t transfers,
+                                 const time_point &time) {
+        return improves(ws, walk_slot(tt, to), transfers, time) && improves(ws, to, transfers, time);
+    }
+    static void record(query_workspace &ws, uint32_t slot, int32_t transfers, const time_point &time) {
+        ws.best_transfers(slot) = transfers;
+        ws.best_time(slot) = time;
+    }
+    static bool stale(const timetable &tt, query_workspace &ws, const search_label &label) {
+        if (tt.is_walk(label.edge)) {
+            return worse(ws, walk_slot(tt, label.stop), label) || !improves(ws, label.stop, label.transfers, label.time);
+        }
+        return worse(ws, label.stop, label);
+    }
+    static heap_entry entry(int32_t transfers, const time_point &estimate, uint32_t label) {
+        return {transfers, time_key(estimate), label};
+    }
+
+private:
+    static bool worse(query_workspace &ws, uint32_t slot, const search_label &label) {
+        return label.transfers > ws.best_transfers(slot) ||
+               (label.transfers == ws.best_transfers(slot) && label.time > ws.best_time(slot));
+    }
+};
+
+/**
+ * @class label_setting_engine
+ * @brief Przeszukiwanie etykiet od przystanku początkowego do pierwszego zdjęcia z kolejki etykiety celu
+ *        (run) albo etykiet wszystkich celów (run_many).
+ *
+ * Połączenia przeglądane są indeksem wychodzącym rozkładu (for_each_departure), przejścia piesze
+ * nie następują po sobie, a wejście do pojazdu innej linii niż poprzednia zwiększa liczbę przesiadek.
+ *
+ * @tparam Criterion Kryterium (earliest_arrival, fewest_transfers_by_line, fewest_transfers_then_arrival).
+ * @tparam Heuristic Oszacowanie czasu dojazdu do celu dodawane do klucza kolejki (no_heuristic – Dijkstra).
+ * @tparam Queue Porządek kolejki (min_key_queue, lexicographic_queue).
+ */
+template<typename Criterion, typename Heuristic = no_heuristic, typename Queue = min_key_queue>
+class label_setting_engine {
+public:
+    typedef std::chrono::system_clock::time_point time_point;
+
+    label_setting_engine(const timetable &tt, query_workspace &ws, Heuristic estimator = Heuristic())
+        : tt(tt), ws(ws), estimator(estimator) {}
+
+    /**
+     * @brief Wyszukuje etykietę celu wśród połączeń odjeżdżających przed `horizon`.
+     *
+     * @param source Przystanek początkowy.
+     * @param target Przystanek docelowy.
+     * @param startTime Czas rozpoczęcia podróży.
+     * @param horizon Połączenia odjeżdżające od tej chwili nie są rozważane.
+     * @return uint32_t Etykieta celu (trasa – query_workspace::route_to) lub timetable::NONE, jeśli trasy nie ma.
+     */
+    uint32_t run(uint32_t source, uint32_t target, const time_point &startTime, const time_point &horizon) {
+        single_target goal{target};
+        search(source, startTime, horizon, goal);
+        return goal.found;
+    }
+
+    /**
+     * @brief Jedno przeszukiwanie dla wielu celów – trwa, aż z kolejki zdjęte zostaną etykiety wszystkich celów.
+     *
+     * Bez odcinania po przyjeździe do celu i tylko bez heurystyki (heurystyka prowadzi do jednego celu).
+     * Tablica celów pochodzi z areny przestrzeni roboczej.
+     *
+     * @param targets Przystanki docelowe (mogą się powtarzać).
+     * @return std::vector<uint32_t> Etykieta każdego celu (w kolejności `targets`) lub timetable::NONE.
+     */
+    std::vector<uint32_t> run_many(uint32_t source, const std::vector<uint32_t> &targets, const time_point &startTime,
+                                   const time_point &horizon) {
+        static_assert(std::is_same_v<Heuristic, no_heuristic>, "run_many wymaga wyszukiwania bez heurystyki");
+        target_set goal{std::pmr::vector<uint32_t>(tt.stop_count(), timetable::NONE, ws.memory())};
+        for (uint32_t target : targets) {
+            if (goal.label_of[target] == timetable::NONE) {
+                goal.label_of[target] = target_set::PENDING;
+                ++goal.remaining;
+            }
+        }
+        if (goal.remaining > 0) {
+            search(source, startTime, horizon, goal);
+        }
+        std::vector<uint32_t> found;
+        found.reserve(targets.size());
+        for (uint32_t target : targets) {
+            const uint32_t label = goal.label_of[target];
+            found.push_back(label == target_set::PENDING ? timetable::NONE : label);
+        }
+        return found;
+    }
+
+private:
+    // Cel jednego przeszukiwania: koniec po zdjęciu etykiety celu, odcinanie po znanym przyjeździe do celu
+    struct single_target {
+        uint32_t target;
+        uint32_t found = timetable::NONE;
+
+        uint32_t heuristic_target() const { return target; }
+        // Najwcześniejszy znany przyjazd do celu – pojazdem albo pieszo
+        bool bound(const timetable &tt, query_workspace &ws, time_point &limit) const {
+            const uint32_t on_foot = Criterion::walk_slot(tt, target);
+            if (!ws.has(target) && !ws.has(on_foot)) {
+                return false;
+            }
+            limit = ws.has(target) ? ws.best_time(target) : time_point::max();
+            if (ws.has(on_foot)) {
+                limit = std::min(limit, ws.best_time(on_foot));
+            }
+            return true;
+        }
+        bool reached(uint32_t index, const search_label &label) {
+            if (label.stop != target) {
+                return false;
+            }
+            found = index;
+            return true;
+        }
+    };
+
+    // Zbiór celów: pierwsza zdjęta etykieta każdego z nich, koniec po ostatnim
+    struct target_set {
+        static constexpr uint32_t PENDING = timetable::NONE - 1;
+        std::pmr::vector<uint32_t> label_of; ///< Przystanek -> etykieta celu (NONE – nie cel, PENDING – nieosiągnięty)
+        size_t remaining = 0;
+
+        uint32_t heuristic_target() const { return timetable::NONE; }
+        bool bound(const timetable &, query_workspace &, time_point &) const { return false; }
+        bool reached(uint32_t index, const search_label &label) {
+            if (label_of[label.stop] != PENDING) {
+                return false;
+            }
+            label_of[label.stop] = index;
+            return --remaining == 0;
+        }
+    };
+
+    template<typename Goal>
+    void search(uint32_t source, const time_point &startTime, const time_point &horizon, Goal &goal) {
+        // Lokalne referencje – po zapisach do puli etykiet kompilator nie musi ich odczytywać ponownie przez this
+        const timetable &tt = this->tt;
+        query_workspace &ws = this->ws;
+        const Heuristic estimator = this->estimator;
+
+        // Nowa etykieta w slocie, którego najlepszą etykietę poprawia
+        auto add = [&](uint32_t slot, const search_label &label) {
+            ws.mark(slot);
+            Criterion::record(ws, slot, label.transfers, label.time);
+            const auto estimate = estimator(tt, ws, label.stop, goal.heuristic_target());
+            const uint32_t next = ws.add_label(label);
+            ws.push(Criterion::entry(label.transfers, label.time + estimate, next), Queue());
+        };
+
+        // Oczekiwanie na przystanku, o ile później coś jeszcze odjeżdża
+        auto wait = [&](uint32_t index, const search_label &current) {
+            if constexpr (Criterion::waits) {
+                const auto until = current.time + Criterion::WAIT;
+                const uint32_t slot = Criterion::wait_slot(tt, current.stop);
+                if (tt.out_begin(current.stop) < tt.out_end(current.stop) &&
+                    tt.departs_between(current.stop, until, horizon) &&
+                    Criterion::improves(ws, slot, current.transfers, until)) {
+                    add(slot, {current.stop, timetable::NONE, index, current.line, current.transfers, until});
+                }
+            }
+        };
+
+        // Wejście do pojazdu poza pętlą przeglądu (rare_improvements)
+        auto board = [&](uint32_t index, uint32_t pos, timetable::duration shift, uint32_t slot,
+                         int32_t transfers) SCAN_NOINLINE {
+            add(slot, {tt.out_to(pos), tt.out_edge(pos), index, tt.out_line(pos), transfers, tt.out_arr(pos) + shift});
+        };
+
+        auto relax_departures = [&](uint32_t index, const search_label &current) SCAN_ALWAYS_INLINE {
+            if (tt.out_begin(current.stop) == tt.out_end(current.stop)) {
+                return;
+            }
+            auto relax = [&](uint32_t pos, timetable::duration shift) SCAN_ALWAYS_INLINE {
+                // Linia połączenia potrzebna jest do porównania dopiero wtedy, gdy kryterium liczy przesiadki,
+                // a kolumna przyjazdów – gdy porównuje czas albo powstaje nowa etykieta
+                SEARCH_COUNT(ws.stats(), edges_scanned, 1);
+                int32_t transfers = 0;
+                if constexpr (Criterion::counts_transfers) {
+                    const uint32_t line = tt.out_line(pos);
+                    transfers = current.transfers + (current.line != timetable::NONE && current.line != line);
+                }
+                const uint32_t slot = Criterion::departure_slot(tt, pos);
+                const time_point arrival = Criterion::compares_time ? tt.out_arr(pos) + shift : time_point();
+                if (Criterion::improves(ws, slot, transfers, arrival)) {
+                    SEARCH_COUNT(ws.stats(), edges_relaxed, 1);
+                    if constexpr (Criterion::rare_improvements) {
+                        board(index, pos, shift, slot, transfers);
+                    } else {
+                        add(slot, {tt.out_to(pos), tt.out_edge(pos), index, tt.out_line(pos), transfers,
+                                   Criterion::compares_time ? arrival : tt.out_arr(pos) + shift});
+                    }
+                }
+            };
+            if constexpr (Criterion::target_bound) {
+                time_point limit;
+                if (goal.bound(tt, ws, limit)) {
+                    // Połączenia przyjeżdżające nie wcześniej niż znany przyjazd do celu nie poprawią wyniku
+                    tt.for_each_departure(current.stop, current.time, horizon, limit, relax);
+                    return;
+                }
+            }
+            tt.for_each_departure(current.stop, current.time, horizon, relax);
+        };
+
+        // Przejścia piesze nie zmieniają liczby przesiadek – kolejne wejście do pojazdu już tak
+        auto relax_walks = [&](uint32_t index, const search_label &current) {
+            if (tt.is_walk(current.edge)) {
+                return;
+            }
+            for (uint32_t w = tt.walk_begin(current.stop); w < tt.walk_end(current.stop); ++w) {
+                const uint32_t to = tt.walk_to(w);
+                const uint32_t slot = Criterion::walk_slot(tt, to);
+                const auto arrival = current.time + tt.walk_time(w);
+                SEARCH_COUNT(ws.stats(), edges_scanned, 1);
+                if (Criterion::improves_on_foot(tt, ws, to, current.transfers, arrival)) {
+                    SEARCH_COUNT(ws.stats(), edges_relaxed, 1);
+                    add(slot, {to, tt.walk_id(w), index, timetable::line_after_walk(current.line), current.transfers,
+                               arrival});
+                }
+            }
+        };
+
+        ws.begin(tt);
+        const uint32_t root_slot = Criterion::root_slot(tt, source);
+        ws.mark(root_slot);
+        Criterion::record(ws, root_slot, 0, startTime);
+        const auto estimate = estimator(tt, ws, source, goal.heuristic_target());
+        uint32_t root = ws.add_label({source, timetable::NONE, timetable::NONE, timetable::NONE, 0, startTime});
+        ws.push(Criterion::entry(0, startTime + estimate, root), Queue());
+
+        while (!ws.heap_empty()) {
+            const uint32_t index = ws.pop(Queue()).label;
+            const search_label current = ws.label(index);
+
+            if (goal.reached(index, current)) {
+                return;
+            }
+            if (Criterion::stale(tt, ws, current)) {
+                SEARCH_COUNT(ws.stats(), dominated_labels, 1);
+                continue;
+            }
+
+            wait(index, current);
+            if constexpr (Criterion::walks_first) {
+                relax_walks(index, current);
+                relax_departures(index, current);
+            } else {
+                relax_departures(index, current);
+                relax_walks(index, current);
+            }
+        }
+    }
+
+    const timetable &tt;
+    query_workspace &ws;
+    Heuristic estimator;
+};
+
+#endif // LABEL_SETTING_ENGINE_H
@@ -8,43 +8,68 @@
  */
 
 #include "tabu_search.h"
-#include "astar.h"  // Zawiera deklarację zmodyfikowanej wersji funkcji astar_change przyjmującej listę sąsiedztwa
+#include "astar.h"  // Zawiera deklarację funkcji astar_change i astar_change_legs działających na rozkładzie (timetable)
 #include <algorithm>
 #include <climits>
-#include <unordered_set>
-#include <deque>
-#include <queue>
+#include <memory_resource>
 #include <chrono>
 #include <string>
 #include <vector>
 #include <iostream>
+#include "../algorithms_utils/trace.h"
 
 using namespace std;
 using namespace chrono;
 
 //-----------------------------------------------------------------------------
-// Funkcja hashująca wektor stringów (używana przy liście tabu)
-size_t VectorHash::operator()(const vector<string>& v) const {
-    hash<string> hasher;
-    size_t seed = 0;
-    for (const auto& s : v) {
-        seed ^= hasher(s) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+// Klucze Zobrista porządków przystanków (używane przy liście tabu)
+zobrist_table::zobrist_table(const vector<string>& stops, pmr::memory_resource* memory)
+    : size(stops.size()), value(memory), keys(memory) {
+    // Przystanki o tej samej nazwie dostają wartość pierwszego z nich
+    value.resize(size);
+    for (size_t s = 0; s < size; ++s) {
+        value[s] = static_cast<uint32_t>(s);
+        for (size_t t = 0; t < s; ++t) {
+            if (stops[t] == stops[s]) {
+                value[s] = value[t];
+                break;
+            }
+        }
+    }
+    // SplitMix64 o stałym ziarnie
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    keys.resize(size * size);
+    for (uint64_t& key : keys) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        key = z ^ (z >> 31);
+    }
+}
+
+uint64_t zobrist_table::hash(const stop_order& order) const {
+    uint64_t h = 0;
+    for (size_t position = 0; position < order.size(); ++position) {
+        h ^= keys[position * size + value[order[position]]];
     }
-    return seed;
+    return h;
 }
 
 //-----------------------------------------------------------------------------
-// Generowanie sąsiadów (wszystkich możliwych permutacji przez zamianę dwóch elementów)
-vector<vector<string>> generate_neighbors(const vector<string>& current) {
-    vector<vector<string>> neighbors;
-    for (size_t i = 0; i < current.size(); ++i) {
-        for (size_t j = i + 1; j < current.size(); ++j) {
-            vector<string> neighbor = current;
-            swap(neighbor[i], neighbor[j]);
-            neighbors.push_back(neighbor);
+// Porządek początkowy i ruchy sąsiedztwa (zamiany par elementów)
+stop_order initial_order(size_t count, pmr::memory_resource* memory) {
+    stop_order order(count, 0, memory);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+    return order;
+}
+
+void generate_moves(size_t count, pmr::vector<stop_swap>& moves) {
+    moves.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        for (uint32_t j = i + 1; j < count; ++j) {
+            moves.emplace_back(i, j);
         }
     }
-    return neighbors;
 }
 
 //-----------------------------------------------------------------------------
@@ -62,52 +87,65 @@ int count_transfers(const vector<edge>& route) {
     return transfers;
 }
 
+int count_transfers(const pmr::vector<route_leg>& route) {
+    if (route.empty()) return 0;
+    int transfers = 0;
+    uint32_t last_line = route[0].line;
+    for (size_t i = 1; i < route.size(); ++i) {
+        if (route[i].line != last_line) {
+            transfers++;
+            last_line = route[i].line;
+        }
+    }
+    return transfers;
+}
+
 //-----------------------------------------------------------------------------
 // Funkcja budująca pełną trasę na podstawie zadanego porządku przystanków
-vector<edge> construct_route(const vector<string> &order,
-                             std::unordered_map<std::string, std::vector<edge>> &adj,
-                             const vector<edge> &edges,
-                             const string &start,
-                             const string &end,
-                             const system_clock::time_point &startTime) {
-    vector<edge> full_route;
-    string current_stop = start;
+bool construct_route(const stop_order &order,
+                     const vector<string> &stops,
+                     const timetable &tt,
+                     query_workspace &ws,
+                     const string &start,
+                     const string &end,
+                     const system_clock::time_point &startTime,
+                     pmr::vector<route_leg> &route) {
+    route.clear();
+    const string* current_stop = &start;
     auto current_time = startTime;
 
-    // Iteracja po kolejnych przystankach pośrednich
-    for (const auto& next_stop : order) {
-        // Używamy zmodyfikowanej funkcji astar_change, która przyjmuje listę sąsiedztwa
-        auto segment = astar_change(adj, edges, current_stop, next_stop, current_time).first;
-        if (segment.empty()) return {}; // Brak połączenia dla danego segmentu
-        full_route.insert(full_route.end(), segment.begin(), segment.end());
-        current_stop = next_stop;
-        current_time = segment.back().getArrivalTime();
+    // Iteracja po kolejnych przystankach pośrednich, a na końcu – do przystanku docelowego
+    for (size_t i = 0; i <= order.size(); ++i) {
+        const string& next_stop = i < order.size() ? stops[order[i]] : end;
+        // Każdy segment to osobne wyszukiwanie na tej samej przestrzeni roboczej, dopisujące odcinki do trasy
+        const size_t before = route.size();
+        if (astar_change_legs(tt, ws, *current_stop, next_stop, current_time, route) < 0 || route.size() == before) {
+            route.clear(); // Brak połączenia dla danego segmentu
+            return false;
+        }
+        current_stop = &next_stop;
+        current_time = route.back().arrival;
     }
-
-    // Łączymy ostatni segment od ostatniego przystanku pośredniego do przystanku docelowego
-    auto final_segment = astar_change(adj, edges, current_stop, end, current_time).first;
-    if (final_segment.empty()) return {};
-    full_route.insert(full_route.end(), final_segment.begin(), final_segment.end());
-
-    return full_route;
+    return true;
 }
 
 //-----------------------------------------------------------------------------
 // Funkcja obliczająca koszt trasy (liczbę przesiadek) dla zadanego porządku przystanków
-double calculate_cost(const vector<string> &order,
-                      std::unordered_map<std::string, std::vector<edge>> &adj,
-                      const vector<edge> &edges,
+double calculate_cost(const stop_order &order,
+                      const vector<string> &stops,
+                      const timetable &tt,
+                      query_workspace &ws,
                       const string &start,
                       const string &end,
-                      const system_clock::time_point &startTime) {
-    auto route = construct_route(order, adj, edges, start, end, startTime);
-    return route.empty() ? INT_MAX : count_transfers(route);
+                      const system_clock::time_point &startTime,
+                      pmr::vector<route_leg> &route) {
+    return construct_route(order, stops, tt, ws, start, end, startTime, route) ? count_transfers(route) : INT_MAX;
 }
 
 //-----------------------------------------------------------------------------
 // Główna funkcja Tabu Search wykorzystująca zbudowaną listę sąsiedztwa
-pair<vector<edge>, double> tabu_search(std::unordered_map<std::string, std::vector<edge>> &adj,
-                                       const vector<edge> &edges,
+pair<vector<edge>, double> tabu_search(const timetable &tt,
+                                       query_workspace &ws,
                                        const string &start,
                                        const string &end,
                                        const vector<string> &required_stops,
@@ -115,83 +153,87 @@ pair<vector<edge>, double> tabu_search(std::unordered_map<std::string, std::vect
                                        int max_iterations) {
     // Jeśli nie podano przystanków pośrednich, szukamy bezpośredniej trasy (używając astar_change)
     if (required_stops.empty()) {
-        auto route = astar_change(adj, edges, start, end, startTime).first;
+        auto route = astar_change(tt, ws, start, end, startTime).first;
         double cost = route.empty() ? INT_MAX : count_transfers(route);
-        return {route, cost};
+        return {std::move(route), cost};
     }
 
+    // Porządki, ruchy, fragmenty tras i lista tabu korzystają z areny zapytania
+    pmr::memory_resource* memory = ws.memory();
+
     // Inicjalizacja bieżącego porządku przystanków pośrednich oraz globalnie najlepszego rozwiązania
-    vector<string> current_order = required_stops;
-    vector<string> best_order = current_order;
-    vector<edge> best_route = construct_route(best_order, adj, edges, start, end, startTime);
+    stop_order current_order = initial_order(required_stops.size(), memory);
+    stop_order best_order(current_order, memory);
+    pmr::vector<route_leg> best_route(memory), route(memory);
+    construct_route(best_order, required_stops, tt, ws, start, end, startTime, best_route);
     double best_cost = best_route.empty() ? INT_MAX : count_transfers(best_route);
 
-    VectorHash hash_fn;
-    // Lista tabu realizowana jako kolejka FIFO
-    deque<size_t> tabu_queue;
-    unordered_set<size_t> tabu_set;
-    // Rozmiar listy tabu ustawiony na 2 * liczba przystanków pośrednich
-    size_t tabu_max_size = 2 * required_stops.size();
+    // Skrót bieżącego porządku aktualizowany przy każdym ruchu
+    const zobrist_table zobrist(required_stops, memory);
+    uint64_t current_hash = zobrist.hash(current_order);
+    // Lista tabu – bufor cykliczny o rozmiarze 2 * liczba przystanków pośrednich
+    tabu_list tabu(2 * required_stops.size(), memory);
 
+    pmr::vector<stop_swap> moves(memory);
+    generate_moves(required_stops.size(), moves);
     for (int iter = 0; iter < max_iterations; ++iter) {
-        auto neighbors = generate_neighbors(current_order);
+        TRACE_SCOPE("tabu_iteration", "iteration", iter);
         double current_best_cost = INT_MAX;
-        vector<string> current_best_order;
+        stop_swap current_best_move;
+        uint64_t current_best_hash = 0;
 
-        // Przeglądanie wszystkich sąsiadów
-        for (const auto& neighbor : neighbors) {
-            size_t neighbor_hash = hash_fn(neighbor);
-            int cost = calculate_cost(neighbor, adj, edges, start, end, startTime);
+        // Przeglądanie wszystkich sąsiadów – zamiana w miejscu, ocena i cofnięcie zamiany
+        for (const stop_swap& move : moves) {
+            const uint64_t neighbor_hash = zobrist.swapped(current_hash, current_order, move);
+            swap(current_order[move.first], current_order[move.second]);
+            int cost = calculate_cost(current_order, required_stops, tt, ws, start, end, startTime, route);
+            swap(current_order[move.first], current_order[move.second]);
 
             // Warunek aspiracji: jeśli sąsiad poprawia globalny wynik, wybieramy go natychmiast
             if (cost < best_cost) {
                 current_best_cost = cost;
-                current_best_order = neighbor;
+                current_best_move = move;
+                current_best_hash = neighbor_hash;
                 break;
             }
 
             // Pomijamy rozwiązania znajdujące się na liście tabu
-            if (tabu_set.find(neighbor_hash) != tabu_set.end()) continue;
+            if (tabu.contains(neighbor_hash)) continue;
 
             if (cost < current_best_cost) {
                 current_best_cost = cost;
-                current_best_order = neighbor;
+                current_best_move = move;
+                current_best_hash = neighbor_hash;
             }
         }
 
         // Jeśli nie znaleziono żadnego poprawiającego sąsiada, kończymy iteracje
         if (current_best_cost == INT_MAX) break;
 
+        // Aktualizacja listy tabu – bieżący porządek zastępuje najstarszy wpis
+        tabu.push(current_hash);
+
+        // Uaktualniamy bieżący porządek do najlepszego znalezionego rozwiązania w tej iteracji
+        swap(current_order[current_best_move.first], current_order[current_best_move.second]);
+        current_hash = current_best_hash;
+
         // Aktualizacja globalnie najlepszego rozwiązania
         if (current_best_cost < best_cost) {
             best_cost = current_best_cost;
-            best_order = current_best_order;
-            best_route = construct_route(best_order, adj, edges, start, end, startTime);
-        }
-
-        // Aktualizacja listy tabu – dodajemy bieżący porządek i usuwamy najstarszy, gdy przekroczymy limit
-        size_t current_hash = hash_fn(current_order);
-        tabu_queue.push_back(current_hash);
-        tabu_set.insert(current_hash);
-        if (tabu_queue.size() > tabu_max_size) {
-            size_t old_hash = tabu_queue.front();
-            tabu_queue.pop_front();
-            tabu_set.erase(old_hash);
+            best_order = current_order;
+            construct_route(best_order, required_stops, tt, ws, start, end, startTime, best_route);
         }
-
-        // Uaktualniamy bieżący porządek do najlepszego znalezionego rozwiązania w tej iteracji
-        current_order = current_best_order;
     }
 
-    return {best_route, best_cost};
+    return {route_edges(tt, best_route), best_cost};
 }
 
 /**
  * @brief Funkcja tabu_search_change wyszukuje trasę minimalizującą liczbę przesiadek.
  *
  * Przyjmuje:
- * - adj: listę sąsiedztwa grafu,
- * - edges: listę wszystkich krawędzi,
+ * - tt: rozkład jazdy,
+ * - ws: przestrzeń roboczą zapytania,
  * - start: przystanek początkowy,
  * - end: przystanek końcowy,
  * - required_stops: lista przystanków do odwiedzenia (pośrednich),
@@ -205,8 +247,8 @@ pair<vector<edge>, double> tabu_search(std::unordered_map<std::string, std::vect
  * to koszt (liczba przesiadek).
  */
 std::pair<std::vector<edge>, double> tabu_search_change(
-    std::unordered_map<std::string, std::vector<edge>> &adj,
-    const std::vector<edge> &edges,
+    const timetable &tt,
+    query_workspace &ws,
     const std::string &start,
     const std::string &end,
     const std::vector<std::string> &required_stops,
@@ -215,48 +257,58 @@ std::pair<std::vector<edge>, double> tabu_search_change(
 {
     // Jeśli nie podano przystanków pośrednich, szukamy bezpośredniej trasy za pomocą astar_change
     if (required_stops.empty()) {
-        auto route = astar_change(adj, edges, start, end, startTime).first;
+        auto route = astar_change(tt, ws, start, end, startTime).first;
         double cost = route.empty() ? INT_MAX : count_transfers(route);
-        return {route, cost};
+        return {std::move(route), cost};
     }
 
+    // Porządki, ruchy, fragmenty tras i lista tabu korzystają z areny zapytania
+    std::pmr::memory_resource *memory = ws.memory();
+
     // Inicjalizacja bieżącego porządku przystanków pośrednich oraz globalnie najlepszego rozwiązania
-    std::vector<std::string> current_order = required_stops;
-    std::vector<std::string> best_order = current_order;
-    std::vector<edge> best_route = construct_route(best_order, adj, edges, start, end, startTime);
+    stop_order current_order = initial_order(required_stops.size(), memory);
+    stop_order best_order(current_order, memory);
+    std::pmr::vector<route_leg> best_route(memory), route(memory);
+    construct_route(best_order, required_stops, tt, ws, start, end, startTime, best_route);
     double best_cost = best_route.empty() ? INT_MAX : count_transfers(best_route);
 
-    // Funkcja hashująca porządki, używana do implementacji listy tabu
-    VectorHash hash_fn;
-    // Lista tabu realizowana jako kolejka FIFO oraz zbiór ułatwiający szybkie sprawdzanie
-    std::deque<size_t> tabu_queue;
-    std::unordered_set<size_t> tabu_set;
-    // Rozmiar listy tabu ustawiony na 2 * liczba przystanków pośrednich (można modyfikować dla poprawy wyników)
-    size_t tabu_max_size = 2 * required_stops.size();
+    // Skróty Zobrista porządków, używane do implementacji listy tabu
+    const zobrist_table zobrist(required_stops, memory);
+    uint64_t current_hash = zobrist.hash(current_order);
+    // Lista tabu – bufor cykliczny o rozmiarze 2 * liczba przystanków pośrednich (można modyfikować dla poprawy wyników)
+    tabu_list tabu(2 * required_stops.size(), memory);
 
+    std::pmr::vector<stop_swap> moves(memory);
+    generate_moves(required_stops.size(), moves);
     for (int iter = 0; iter < max_iterations; ++iter) {
-        auto neighbors = generate_neighbors(current_order);
+        TRACE_SCOPE("tabu_iteration", "iteration", iter);
         double current_best_cost = INT_MAX;
-        std::vector<std::string> current_best_order;
+        stop_swap current_best_move;
+        uint64_t current_best_hash = 0;
 
-        // Przegląd sąsiadów (permutacji kolejności przystanków pośrednich)
-        for (const auto &neighbor : neighbors) {
-            size_t neighbor_hash = hash_fn(neighbor);
-            int cost = count_transfers( construct_route(neighbor, adj, edges, start, end, startTime) );
+        // Przegląd sąsiadów (permutacji kolejności przystanków pośrednich) – zamiana w miejscu i jej cofnięcie
+        for (const stop_swap &move : moves) {
+            const uint64_t neighbor_hash = zobrist.swapped(current_hash, current_order, move);
+            std::swap(current_order[move.first], current_order[move.second]);
+            construct_route(current_order, required_stops, tt, ws, start, end, startTime, route);
+            std::swap(current_order[move.first], current_order[move.second]);
+            int cost = count_transfers(route);
 
             // Warunek aspiracji: jeśli sąsiad poprawia globalny wynik, wybieramy go natychmiast
             if (cost < best_cost) {
                 current_best_cost = cost;
-                current_best_order = neighbor;
+                current_best_move = move;
+                current_best_hash = neighbor_hash;
                 break;
             }
 
             // Pomijamy rozwiązania znajdujące się na liście tabu
-            if (tabu_set.find(neighbor_hash) != tabu_set.end()) continue;
+            if (tabu.contains(neighbor_hash)) continue;
 
             if (cost < current_best_cost) {
                 current_best_cost = cost;
-                current_best_order = neighbor;
+                current_best_move = move;
+                current_best_hash = neighbor_hash;
             }
         }
 
@@ -264,26 +316,20 @@ std::pair<std::vector<edge>, double> tabu_search_change(
         if (current_best_cost == INT_MAX)
             break;
 
+        // Aktualizacja listy tabu – bieżący porządek zastępuje najstarszy wpis
+        tabu.push(current_hash);
+
+        // Uaktualniamy bieżący porządek do najlepszego znalezionego rozwiązania w tej iteracji
+        std::swap(current_order[current_best_move.first], current_order[current_best_move.second]);
+        current_hash = current_best_hash;
+
         // Aktualizacja globalnie najlepszego rozwiązania
         if (current_best_cost < best_cost) {
             best_cost = current_best_cost;
-            best_order = current_best_order;
-            best_route = construct_route(best_order, adj, edges, start, end, startTime);
+            best_order = current_order;
+            construct_route(best_order, required_stops, tt, ws, start, end, startTime, best_route);
         }
-
-        // Aktualizacja listy tabu – dodajemy bieżący porządek, usuwamy najstarszy, gdy przekroczymy limit
-        size_t current_hash = hash_fn(current_order);
-        tabu_queue.push_back(current_hash);
-        tabu_set.insert(current_hash);
-        if (tabu_queue.size() > tabu_max_size) {
-            size_t old_hash = tabu_queue.front();
-            tabu_queue.pop_front();
-            tabu_set.erase(old_hash);
-        }
-
-        // Uaktualniamy bieżący porządek do najlepszego znalezionego rozwiązania w tej iteracji
-        current_order = current_best_order;
     }
 
-    return {best_route, best_cost};
+    return {route_edges(tt, best_route), best_cost};
 }
@@ -5,39 +5,109 @@
 #ifndef TABU_SEARCH_H
 #define TABU_SEARCH_H
 
+#include <algorithm>
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include <string>
 #include <chrono>
 #include <climits>
-#include <unordered_set>
+#include <memory_resource>
 #include "../graph/edge.h"
 #include "astar.h"
+#include "../graph/timetable.h"
+#include "../algorithms_utils/query_workspace.h"
 
 /**
- * @brief Funktor obliczający wartość skrótu (hash) dla wektora stringów.
+ * @brief Porządek przystanków pośrednich – permutacja indeksów listy przystanków zapytania.
  *
- * Funkcja wykorzystuje std::hash<string> oraz technikę mieszania bitów, aby
- * uzyskać unikalną wartość haszującą dla danego wektora. Umożliwia to
- * wykorzystanie std::vector<std::string> jako klucza w strukturach takich jak unordered_set.
+ * Ruch (zamiana dwóch pozycji) nie kopiuje napisów ani wektora; wektory przydzielane są z areny
+ * zapytania (query_workspace::memory()).
+ */
+typedef std::pmr::vector<uint32_t> stop_order;
+
+/// Ruch w sąsiedztwie porządku – zamiana miejscami elementów na pozycjach first < second.
+typedef std::pair<uint32_t, uint32_t> stop_swap;
+
+/**
+ * @class zobrist_table
+ * @brief Skróty Zobrista porządków przystanków do listy tabu.
+ *
+ * Skrót porządku to XOR losowych kluczy par (pozycja, przystanek), więc zamiana dwóch pozycji zmienia
+ * go czterema operacjami XOR – bez przeglądania całego porządku. Przystanki o tej samej nazwie mają
+ * wspólne klucze, więc porządki różniące się tylko ich kolejnością mają ten sam skrót.
+ * Klucze pochodzą z generatora o stałym ziarnie – wynik wyszukiwania nie zależy od przebiegu.
+ */
+class zobrist_table {
+public:
+    zobrist_table(const std::vector<std::string> &stops, std::pmr::memory_resource *memory);
+
+    /// Skrót całego porządku – O(n), tylko dla porządku początkowego.
+    uint64_t hash(const stop_order &order) const;
+
+    /// Skrót porządku `order` (o skrócie `h`) po zamianie pozycji `move` – O(1).
+    uint64_t swapped(uint64_t h, const stop_order &order, const stop_swap &move) const {
+        const uint64_t *first = &keys[move.first * size];
+        const uint64_t *second = &keys[move.second * size];
+        const uint32_t a = value[order[move.first]];
+        const uint32_t b = value[order[move.second]];
+        return h ^ first[a] ^ second[b] ^ first[b] ^ second[a];
+    }
+
+private:
+    size_t size;
+    std::pmr::vector<uint32_t> value; ///< Przystanek -> indeks pierwszego przystanku o tej samej nazwie
+    std::pmr::vector<uint64_t> keys;  ///< Klucz pary (pozycja, wartość) pod indeksem pozycja * size + wartość
+};
+
+/**
+ * @class tabu_list
+ * @brief Lista tabu o stałym rozmiarze – bufor cykliczny skrótów porządków.
  *
- * @param v Wektor stringów do zahaszowania.
- * @return size_t Obliczona wartość haszująca.
+ * Nowy wpis zastępuje najstarszy. Lista ma 2 · n wpisów dla n przystanków pośrednich, więc sprawdzenie
+ * przeglądem kilkunastu liczb jest tańsze niż zbiór haszowany i nie przydziela pamięci w trakcie wyszukiwania.
  */
-struct VectorHash {
-    size_t operator()(const std::vector<std::string>& v) const;
+class tabu_list {
+public:
+    tabu_list(size_t capacity, std::pmr::memory_resource *memory) : entries(capacity, 0, memory) {}
+
+    bool contains(uint64_t h) const {
+        return std::find(entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(used), h) !=
+               entries.begin() + static_cast<std::ptrdiff_t>(used);
+    }
+
+    void push(uint64_t h) {
+        if (entries.empty()) return;
+        entries[next] = h;
+        next = next + 1 == entries.size() ? 0 : next + 1;
+        used = std::min(used + 1, entries.size());
+    }
+
+private:
+    std::pmr::vector<uint64_t> entries;
+    size_t next = 0;
+    size_t used = 0;
 };
 
 /**
- * @brief Generuje sąsiadów danego porządku przystanków.
+ * @brief Tworzy porządek początkowy – przystanki w kolejności z zapytania.
  *
- * Funkcja tworzy wszystkie możliwe permutacje uzyskiwane przez zamianę miejscami
- * par elementów wektora. Każda taka permutacja jest potencjalnym kandydatem na
- * lepsze rozwiązanie w ramach algorytmu Tabu Search.
+ * @param count Liczba przystanków pośrednich.
+ * @param memory Arena zapytania.
+ */
+stop_order initial_order(size_t count, std::pmr::memory_resource *memory);
+
+/**
+ * @brief Generuje ruchy sąsiedztwa porządku o `count` elementach.
  *
- * @param current Wektor reprezentujący aktualny porządek przystanków.
- * @return std::vector<std::vector<std::string>> Lista wygenerowanych sąsiadów.
+ * Sąsiedzi to wszystkie permutacje uzyskiwane przez zamianę miejscami pary elementów; lista ruchów
+ * zależy tylko od liczby przystanków, więc tworzona jest raz na wyszukiwanie. Sąsiada ocenia się,
+ * zamieniając elementy porządku w miejscu i cofając zamianę po obliczeniu kosztu.
+ *
+ * @param count Liczba przystanków pośrednich.
+ * @param moves Wypełniana lista ruchów (kolejność: (0,1), (0,2), ..., (1,2), ...).
  */
-std::vector<std::vector<std::string>> generate_neighbors(const std::vector<std::string>& current);
+void generate_moves(size_t count, std::pmr::vector<stop_swap> &moves);
 
 /**
  * @brief Oblicza liczbę przesiadek na trasie.
@@ -51,26 +121,34 @@ std::vector<std::vector<std::string>> generate_neighbors(const std::vector<std::
  */
 int count_transfers(const std::vector<edge>& route);
 
+/// Jak count_transfers dla krawędzi – linie porównywane są po identyfikatorach rozkładu.
+int count_transfers(const std::pmr::vector<route_leg>& route);
+
 /**
- * @brief Buduje pełną trasę łącząc segmenty wyznaczone funkcją astar_change.
+ * @brief Buduje pełną trasę łącząc segmenty wyznaczone funkcją astar_change_legs.
  *
  * Funkcja przetwarza kolejno podany porządek przystanków, wyznaczając segmenty trasy
  * między przystankiem początkowym a kolejnymi wymaganymi przystankami, aż do przystanku docelowego.
- * Jeśli dla któregoś segmentu nie uda się znaleźć połączenia, zwracany jest pusty wektor.
+ * Jeśli dla któregoś segmentu nie uda się znaleźć połączenia, trasa pozostaje pusta.
  *
  * @param order Kolejność odwiedzanych przystanków.
- * @param edges Wektor krawędzi wykorzystywany przez funkcję astar_change.
+ * @param stops Przystanki pośrednie zapytania (wskazywane przez `order`).
+ * @param tt Rozkład jazdy wykorzystywany przez funkcję astar_change.
+ * @param ws Przestrzeń robocza – wszystkie segmenty korzystają z tej samej.
  * @param start Przystanek początkowy.
  * @param end Przystanek docelowy.
  * @param startTime Czas rozpoczęcia podróży.
- * @return std::vector<edge> Zbudowana trasa.
+ * @param route Wypełniane odcinki trasy (poprzednia zawartość jest usuwana).
+ * @return bool true, jeśli trasa istnieje.
  */
-std::vector<edge> construct_route(const std::vector<std::string> &order,
-                             std::unordered_map<std::string, std::vector<edge>> &adj,
-                             const std::vector<edge> &edges,
-                             const std::string &start,
-                             const std::string &end,
-                             const std::chrono::system_clock::time_point &startTime);
+bool construct_route(const stop_order &order,
+                     const std::vector<std::string> &stops,
+                     const timetable &tt,
+                     query_workspace &ws,
+                     const std::string &start,
+                     const std::string &end,
+                     const std::chrono::system_clock::time_point &startTime,
+                     std::pmr::vector<route_leg> &route);
 
 /**
  * @brief Oblicza koszt trasy na podstawie liczby przesiadek.
@@ -80,18 +158,23 @@ std::vector<edge> construct_route(const std::vector<std::string> &order,
  * nie uda się wyznaczyć, zwraca INT_MAX.
  *
  * @param order Kolejność przystanków do odwiedzenia.
- * @param edges Wektor krawędzi.
+ * @param stops Przystanki pośrednie zapytania.
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania.
  * @param start Przystanek początkowy.
  * @param end Przystanek docelowy.
  * @param startTime Czas rozpoczęcia podróży.
+ * @param route Bufor na odcinki trasy.
  * @return double Koszt trasy (liczba przesiadek) lub INT_MAX, jeśli trasa nie istnieje.
  */
-double calculate_cost(const std::vector<std::string> &order,
-                      std::unordered_map<std::string, std::vector<edge>> &adj,
-                      const std::vector<edge> &edges,
+double calculate_cost(const stop_order &order,
+                      const std::vector<std::string> &stops,
+                      const timetable &tt,
+                      query_workspace &ws,
                       const std::string &start,
                       const std::string &end,
-                      const std::chrono::system_clock::time_point &startTime);
+                      const std::chrono::system_clock::time_point &startTime,
+                      std::pmr::vector<route_leg> &route);
 
 /**
  * @brief Główna funkcja algorytmu Tabu Search.
@@ -102,8 +185,8 @@ double calculate_cost(const std::vector<std::string> &order,
  * a następnie wybierany jest najlepszy kandydat, z uwzględnieniem listy tabu (zapobiegającej cyklom)
  * oraz warunku aspiracji (akceptującego lepsze globalnie rozwiązania).
  *
- * @param adj Wygenerowany graf
- * @param edges Wektor krawędzi.
+ * @param tt Rozkład jazdy.
+ * @param ws Przestrzeń robocza zapytania należąca do bieżącego wątku.
  * @param start Przystanek początkowy.
  * @param end Przystanek docelowy.
  * @param required_stops Lista przystanków pośrednich do odwiedzenia.
@@ -111,8 +194,8 @@ double calculate_cost(const std::vector<std::string> &order,
  * @param max_iterations Maksymalna liczba iteracji algorytmu.
  * @return std::pair<std::vector<edge>, double> Parę zawierającą najlepszą znalezioną trasę oraz jej koszt.
  */
-std::pair<std::vector<edge>, double> tabu_search(std::unordered_map<std::string, std::vector<edge>> &adj,
-                                                 const std::vector<edge>& edges,
+std::pair<std::vector<edge>, double> tabu_search(const timetable &tt,
+                                                 query_workspace &ws,
                                                  const std::string& start,
                                                  const std::string& end,
                                                  const std::vector<std::string>& required_stops,
@@ -120,8 +203,8 @@ std::pair<std::vector<edge>, double> tabu_search(std::unordered_map<std::string,
                                                  int max_iterations = 100);
 
 std::pair<std::vector<edge>, double> tabu_search_change(
-    std::unordered_map<std::string, std::vector<edge>> &adj,
-    const std::vector<edge> &edges,
+    const timetable &tt,
+    query_workspace &ws,
     const std::string &start,
     const std::string &end,
     const std::vector<std::string> &required_stops,
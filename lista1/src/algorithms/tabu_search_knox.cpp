@@ -2,67 +2,78 @@
 #include <algorithm>
 #include <random>
 #include <climits>
+#include <memory_resource>
+#include "../algorithms_utils/trace.h"
 
 // Funkcja realizująca algorytm Knoxa (Tabu Search) dla problemu komiwojażera
 std::pair<std::vector<edge>, double> tabu_search_knox(
-    std::unordered_map<std::string, std::vector<edge>> &adj,
-    const std::vector<edge> &edges,
+    const timetable &tt,
+    query_workspace &ws,
     const std::string &start,
     const std::string &end,
-    std::vector<std::string> required_stops,
+    const std::vector<std::string> &required_stops,
     const std::chrono::system_clock::time_point &startTime,
     int step_limit,
     int op_limit)
 {
+    // Porządki, ruchy, fragmenty tras i lista tabu korzystają z areny zapytania
+    std::pmr::memory_resource *memory = ws.memory();
+
     // Losowe przetasowanie początkowego porządku przystanków
+    stop_order current_order = initial_order(required_stops.size(), memory);
     unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::shuffle(required_stops.begin(), required_stops.end(), std::default_random_engine(seed));
+    std::shuffle(current_order.begin(), current_order.end(), std::default_random_engine(seed));
 
     // Inicjalizacja początkowego rozwiązania s oraz najlepszego rozwiązania s*
-    std::vector<std::string> current_order = required_stops;
-    std::vector<std::string> best_order = current_order;
-    // Przekazujemy adj jako drugi parametr do funkcji construct_route
-    std::vector<edge> best_route = construct_route(best_order, adj, edges, start, end, startTime);
+    stop_order best_order(current_order, memory);
+    std::pmr::vector<route_leg> best_route(memory), route(memory);
+    construct_route(best_order, required_stops, tt, ws, start, end, startTime, best_route);
     double best_cost = best_route.empty() ? INT_MAX : count_transfers(best_route);
 
-    // Inicjalizacja listy tabu (FIFO) i zbioru do szybkiego sprawdzania
-    VectorHash hash_fn;
-    std::deque<size_t> tabu_queue;
-    std::unordered_set<size_t> tabu_set;
-    size_t tabu_max_size = 2 * required_stops.size();
+    // Inicjalizacja listy tabu (bufor cykliczny) i skrótu bieżącego porządku
+    const zobrist_table zobrist(required_stops, memory);
+    uint64_t current_hash = zobrist.hash(current_order);
+    tabu_list tabu(2 * required_stops.size(), memory);
 
+    std::pmr::vector<stop_swap> moves(memory);
+    generate_moves(required_stops.size(), moves);
     int k = 0;
     // Pętla zewnętrzna – kroki algorytmu (STEP_LIMIT)
     while (k < step_limit) {
         int i = 0;
         // Pętla wewnętrzna – operacje na sąsiedztwie (OP_LIMIT)
         while (i < op_limit) {
-            auto neighbors = generate_neighbors(current_order);
+            TRACE_SCOPE("tabu_iteration", "iteration", static_cast<int64_t>(k) * op_limit + i);
             double current_best_cost = INT_MAX;
-            std::vector<std::string> current_best_order;
+            stop_swap current_best_move;
+            uint64_t current_best_hash = 0;
             bool found_aspiration = false;
 
-            // Przegląd wszystkich sąsiadów
-            for (const auto &neighbor : neighbors) {
-                size_t neighbor_hash = hash_fn(neighbor);
-                // Obliczamy koszt trasy dla sąsiada – przekazujemy adj jako drugi parametr
-                int cost = calculate_cost(neighbor, adj, edges, start, end, startTime);
+            // Przegląd wszystkich sąsiadów – zamiana w miejscu, ocena i cofnięcie zamiany
+            for (const stop_swap &move : moves) {
+                const uint64_t neighbor_hash = zobrist.swapped(current_hash, current_order, move);
+                // Obliczamy koszt trasy dla sąsiada
+                std::swap(current_order[move.first], current_order[move.second]);
+                int cost = calculate_cost(current_order, required_stops, tt, ws, start, end, startTime, route);
+                std::swap(current_order[move.first], current_order[move.second]);
 
                 // Warunek aspiracji: jeśli sąsiad poprawia globalny wynik, wybieramy go natychmiast
                 if (cost < best_cost) {
                     current_best_cost = cost;
-                    current_best_order = neighbor;
+                    current_best_move = move;
+                    current_best_hash = neighbor_hash;
                     found_aspiration = true;
                     break;
                 }
 
                 // Pomijamy rozwiązania znajdujące się na liście tabu
-                if (tabu_set.find(neighbor_hash) != tabu_set.end())
+                if (tabu.contains(neighbor_hash))
                     continue;
 
                 if (cost < current_best_cost) {
                     current_best_cost = cost;
-                    current_best_order = neighbor;
+                    current_best_move = move;
+                    current_best_hash = neighbor_hash;
                 }
             }
 
@@ -71,9 +82,10 @@ std::pair<std::vector<edge>, double> tabu_search_knox(
                 break;
 
             // Aktualizacja bieżącego rozwiązania: jeśli s' poprawia s, przyjmujemy s'
-            int current_cost = calculate_cost(current_order, adj, edges, start, end, startTime);
+            int current_cost = calculate_cost(current_order, required_stops, tt, ws, start, end, startTime, route);
             if (current_best_cost < current_cost) {
-                current_order = current_best_order;
+                std::swap(current_order[current_best_move.first], current_order[current_best_move.second]);
+                current_hash = current_best_hash;
                 i++;  // Zwiększamy licznik operacji wewnętrznych
             }
             else {
@@ -81,26 +93,19 @@ std::pair<std::vector<edge>, double> tabu_search_knox(
                 break;
             }
 
-            // Aktualizacja listy tabu – dodajemy bieżący porządek, usuwamy najstarszy, gdy lista przekroczy ustalony rozmiar
-            size_t current_hash = hash_fn(current_order);
-            tabu_queue.push_back(current_hash);
-            tabu_set.insert(current_hash);
-            if (tabu_queue.size() > tabu_max_size) {
-                size_t old_hash = tabu_queue.front();
-                tabu_queue.pop_front();
-                tabu_set.erase(old_hash);
-            }
+            // Aktualizacja listy tabu – dodajemy bieżący porządek, zastępując najstarszy wpis
+            tabu.push(current_hash);
         } // koniec pętli wewnętrznej
 
         // Aktualizacja globalnego najlepszego rozwiązania, jeśli bieżące jest lepsze
-        int current_cost = calculate_cost(current_order, adj, edges, start, end, startTime);
+        int current_cost = calculate_cost(current_order, required_stops, tt, ws, start, end, startTime, route);
         if (current_cost < best_cost) {
             best_cost = current_cost;
             best_order = current_order;
-            best_route = construct_route(best_order, adj, edges, start, end, startTime);
+            construct_route(best_order, required_stops, tt, ws, start, end, startTime, best_route);
         }
         k++; // kolejny krok zewnętrzny
     }
 
-    return {best_route, best_cost};
+    return {route_edges(tt, best_route), best_cost};
 }
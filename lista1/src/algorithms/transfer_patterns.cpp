@@ -0,0 +1,277 @@
+#include "transfer_patterns.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <ctime>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+/// Liczba przesiadek, powyżej której podróże są traktowane jak z maksymalną liczbą przesiadek
+constexpr uint32_t MAX_TRANSFERS = 32;
+
+constexpr uint32_t INDEX_MAGIC = 0x3150544c; // "LTP1"
+constexpr uint32_t INDEX_VERSION = 2; // 2: numery przystanków rozkładu (timetable)
+
+template <typename T>
+void write_vector(std::ofstream &out, const std::vector<T> &v) {
+    uint64_t size = v.size();
+    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.write(reinterpret_cast<const char *>(v.data()), static_cast<std::streamsize>(size * sizeof(T)));
+}
+
+template <typename T>
+bool read_vector(std::ifstream &in, std::vector<T> &v) {
+    uint64_t size = 0;
+    if (!in.read(reinterpret_cast<char *>(&size), sizeof(size))) return false;
+    v.resize(size);
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(v.data()), static_cast<std::streamsize>(size * sizeof(T))));
+}
+
+// DAG wzorców jednego przystanku początkowego
+struct origin_dag {
+    std::vector<tp_node> nodes;
+    std::vector<tp_target> targets;
+};
+
+} // namespace
+
+transfer_patterns transfer_patterns::build(const trip_based_index &tb,
+                                           int64_t window_start,
+                                           int64_t window_end,
+                                           unsigned threads) {
+    const auto build_start = std::chrono::steady_clock::now();
+    const uint32_t stops = static_cast<uint32_t>(tb.stop_total());
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Odjazdy każdego przystanku; okno liczymy od północy dnia najwcześniejszego odjazdu
+    std::vector<std::vector<int64_t>> departures(stops);
+    int64_t first_departure = LLONG_MAX;
+    for (uint32_t s = 0; s < stops; ++s) {
+        departures[s] = tb.departures_from(s);
+        if (!departures[s].empty()) {
+            first_departure = std::min(first_departure, departures[s].back());
+        }
+    }
+    int64_t midnight = 0;
+    if (first_departure != LLONG_MAX) {
+        std::time_t tt = static_cast<std::time_t>(first_departure);
+        std::tm tm = *std::localtime(&tt);
+        tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+        midnight = static_cast<int64_t>(std::mktime(&tm));
+    }
+
+    std::vector<origin_dag> dags(stops);
+    std::atomic<uint32_t> next{0};
+    std::atomic<size_t> searched{0};
+
+    auto worker = [&]() {
+        // Najlepszy przyjazd z późniejszych odjazdów: [przystanek * (MAX_TRANSFERS + 1) + przesiadki]
+        std::vector<int64_t> profile(static_cast<size_t>(stops) * (MAX_TRANSFERS + 1));
+        std::unordered_map<uint64_t, uint32_t> children;
+        std::unordered_set<uint64_t> seen_targets;
+        trip_based_index::profile_scratch scratch;
+
+        for (uint32_t origin = next++; origin < stops; origin = next++) {
+            origin_dag &dag = dags[origin];
+            dag.nodes.push_back({origin, TP_ROOT});
+            std::fill(profile.begin(), profile.end(), LLONG_MAX);
+            children.clear();
+            seen_targets.clear();
+
+            auto on_arrival = [&](uint32_t stop, uint32_t transfers, int64_t arrival,
+                                  const std::vector<uint32_t> &pattern) {
+                transfers = std::min(transfers, MAX_TRANSFERS);
+                int64_t *best = &profile[static_cast<size_t>(stop) * (MAX_TRANSFERS + 1)];
+                // Podróż zdominowana przez odjazd późniejszy z nie gorszym przyjazdem i liczbą przesiadek
+                for (uint32_t n = 0; n <= transfers; ++n) {
+                    if (best[n] <= arrival) return;
+                }
+                best[transfers] = arrival;
+
+                uint32_t node = 0;
+                for (size_t i = 1; i < pattern.size(); ++i) {
+                    const uint64_t key = (static_cast<uint64_t>(node) << 32) | pattern[i];
+                    auto [it, inserted] = children.emplace(key, static_cast<uint32_t>(dag.nodes.size()));
+                    if (inserted) {
+                        dag.nodes.push_back({pattern[i], node});
+                    }
+                    node = it->second;
+                }
+                if (seen_targets.insert((static_cast<uint64_t>(stop) << 32) | node).second) {
+                    dag.targets.push_back({stop, node});
+                }
+            };
+
+            // Przeszukiwanie profilowe: od najpóźniejszego odjazdu, aby móc odrzucać podróże zdominowane
+            for (int64_t departure : departures[origin]) {
+                const int64_t since_midnight = departure - midnight;
+                if (since_midnight < window_start || since_midnight > window_end) continue;
+                tb.one_to_all(origin, departure, scratch, on_arrival);
+                ++searched;
+            }
+            std::sort(dag.targets.begin(), dag.targets.end(), [](const tp_target &a, const tp_target &b) {
+                return a.stop != b.stop ? a.stop < b.stop : a.node < b.node;
+            });
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &th : pool) {
+        th.join();
+    }
+
+    transfer_patterns index;
+    index.fingerprint = tb.get_fingerprint();
+    index.origin_node_offset.push_back(0);
+    index.origin_target_offset.push_back(0);
+    for (auto &dag : dags) {
+        index.nodes.insert(index.nodes.end(), dag.nodes.begin(), dag.nodes.end());
+        index.targets.insert(index.targets.end(), dag.targets.begin(), dag.targets.end());
+        index.origin_node_offset.push_back(static_cast<uint32_t>(index.nodes.size()));
+        index.origin_target_offset.push_back(static_cast<uint32_t>(index.targets.size()));
+        dag = {};
+    }
+    index.statistics.origins = stops;
+    index.statistics.departures = searched;
+    index.statistics.build_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - build_start).count();
+    return index;
+}
+
+std::pair<std::vector<edge>, double> transfer_patterns::query(
+    const trip_based_index &tb,
+    const timetable &tt,
+    const std::string &start,
+    const std::string &end,
+    const std::chrono::system_clock::time_point &startTime,
+    std::pmr::memory_resource *memory,
+    search_stats *stats) const
+{
+    const uint32_t source = tt.stop_id(start);
+    const uint32_t target = tt.stop_id(end);
+    if (source == timetable::NONE || target == timetable::NONE || source + 1 >= origin_node_offset.size()) {
+        return {{}, -1.0};
+    }
+    if (source == target) {
+        return {{}, 0.0};
+    }
+    const int64_t departure = std::chrono::duration_cast<std::chrono::seconds>(startTime.time_since_epoch()).count();
+
+    auto first = targets.begin() + origin_target_offset[source];
+    auto last = targets.begin() + origin_target_offset[source + 1];
+    auto range = std::equal_range(first, last, tp_target{target, 0},
+                                  [](const tp_target &a, const tp_target &b) { return a.stop < b.stop; });
+
+    const tp_node *dag = nodes.data() + origin_node_offset[source];
+    std::pmr::vector<uint32_t> pattern(memory);
+    std::pmr::vector<tb_leg> legs(memory), best_legs(memory);
+    int64_t best_arrival = LLONG_MAX;
+
+    // Etykietą jest wzorzec przesiadek do celu, krawędzią – przejazd bez przesiadki między jego przystankami
+    SEARCH_COUNT(stats, labels_pushed, range.second - range.first);
+    SEARCH_PEAK(stats, peak_queue, range.second - range.first);
+    for (auto it = range.first; it != range.second; ++it) {
+        SEARCH_COUNT(stats, labels_popped, 1);
+        pattern.clear();
+        for (uint32_t node = it->node; node != TP_ROOT; node = dag[node].parent) {
+            pattern.push_back(dag[node].stop);
+        }
+        std::reverse(pattern.begin(), pattern.end());
+
+        // Każdy odcinek wzorca to jeden przejazd bez przesiadki
+        legs.clear();
+        int64_t time = departure;
+        bool feasible = true;
+        for (size_t i = 0; i + 1 < pattern.size() && feasible; ++i) {
+            tb_leg leg{};
+            SEARCH_COUNT(stats, edges_scanned, 1);
+            feasible = tb.direct_leg(pattern[i], pattern[i + 1], time, leg) && leg.arrival < best_arrival;
+            if (feasible) {
+                SEARCH_COUNT(stats, edges_relaxed, 1);
+                legs.push_back(leg);
+                time = leg.arrival;
+            }
+        }
+        if (feasible && time < best_arrival) {
+            best_arrival = time;
+            best_legs = legs;
+        } else {
+            SEARCH_COUNT(stats, dominated_labels, 1);
+        }
+    }
+
+    if (best_arrival == LLONG_MAX) {
+        return {{}, -1.0};
+    }
+    size_t length = 0;
+    for (const auto &leg : best_legs) {
+        length += leg.to - leg.from;
+    }
+    std::vector<edge> route;
+    route.reserve(length);
+    for (const auto &leg : best_legs) {
+        tb.append_leg(tt, leg, route);
+    }
+    return {std::move(route), static_cast<double>(best_arrival - departure)};
+}
+
+size_t transfer_patterns::size_in_bytes() const {
+    return nodes.size() * sizeof(tp_node) + targets.size() * sizeof(tp_target) +
+           (origin_node_offset.size() + origin_target_offset.size()) * sizeof(uint32_t);
+}
+
+bool transfer_patterns::save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(&INDEX_MAGIC), sizeof(INDEX_MAGIC));
+    out.write(reinterpret_cast<const char *>(&INDEX_VERSION), sizeof(INDEX_VERSION));
+    out.write(reinterpret_cast<const char *>(&fingerprint), sizeof(fingerprint));
+    out.write(reinterpret_cast<const char *>(&statistics), sizeof(statistics));
+    write_vector(out, origin_node_offset);
+    write_vector(out, nodes);
+    write_vector(out, origin_target_offset);
+    write_vector(out, targets);
+    return static_cast<bool>(out);
+}
+
+bool transfer_patterns::load(const trip_based_index &tb, const std::string &path, transfer_patterns &out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    uint32_t magic = 0, version = 0;
+    transfer_patterns index;
+    in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&index.fingerprint), sizeof(index.fingerprint));
+    in.read(reinterpret_cast<char *>(&index.statistics), sizeof(index.statistics));
+    if (!in || magic != INDEX_MAGIC || version != INDEX_VERSION || index.fingerprint != tb.get_fingerprint()) {
+        return false;
+    }
+    if (!read_vector(in, index.origin_node_offset) || !read_vector(in, index.nodes) ||
+        !read_vector(in, index.origin_target_offset) || !read_vector(in, index.targets)) {
+        return false;
+    }
+    if (index.origin_node_offset.size() != tb.stop_total() + 1 ||
+        index.origin_target_offset.size() != tb.stop_total() + 1 ||
+        index.origin_node_offset.back() != index.nodes.size() ||
+        index.origin_target_offset.back() != index.targets.size()) {
+        return false;
+    }
+    out = std::move(index);
+    return true;
+}
+
@@ -0,0 +1,114 @@
+#ifndef TRANSFER_PATTERNS_H
+#define TRANSFER_PATTERNS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory_resource>
+#include "../graph/edge.h"
+#include "trip_based.h"
+
+/**
+ * @struct tp_node
+ * @brief Węzeł DAG-u wzorców przesiadek jednego przystanku początkowego.
+ *
+ * Wzorce przechowywane są jako drzewo prefiksowe zaczynające się w przystanku początkowym
+ * (korzeń ma parent == TP_ROOT), więc wzorce o wspólnym początku współdzielą węzły.
+ */
+struct tp_node {
+    uint32_t stop;   ///< Przystanek (wsiadania lub docelowy)
+    uint32_t parent; ///< Indeks węzła poprzedzającego w obrębie przystanku początkowego
+};
+
+/**
+ * @struct tp_target
+ * @brief Zakończenie wzorca: przystanek docelowy i węzeł, w którym kończy się wzorzec.
+ */
+struct tp_target {
+    uint32_t stop;
+    uint32_t node;
+};
+
+constexpr uint32_t TP_ROOT = UINT32_MAX;
+
+/**
+ * @class transfer_patterns
+ * @brief Prekomputowany indeks wzorców przesiadek (Transfer Patterns) dla ustalonego rozkładu.
+ *
+ * Dla każdego przystanku początkowego wykonywane jest przeszukiwanie profilowe: kolejne odjazdy
+ * z przystanku (od najpóźniejszego) są przeszukiwane indeksem Trip-Based, a ciągi przystanków
+ * przesiadkowych podróży optymalnych w sensie Pareto (odjazd, przyjazd, liczba przesiadek)
+ * trafiają do DAG-u. Przystanki początkowe przetwarzane są równolegle.
+ *
+ * Zapytanie sprawdza tylko wzorce prowadzące do przystanku docelowego, wyznaczając dla każdego
+ * odcinka najwcześniejszy przejazd bezpośredni.
+ */
+class transfer_patterns {
+public:
+    /**
+     * @brief Statystyki budowy indeksu.
+     */
+    struct build_stats {
+        double build_ms = 0.0;   ///< Czas budowy w milisekundach
+        size_t origins = 0;      ///< Liczba przystanków początkowych
+        size_t departures = 0;   ///< Liczba przeszukanych czasów odjazdu
+    };
+
+    /**
+     * @brief Buduje indeks na podstawie indeksu Trip-Based.
+     *
+     * @param tb Indeks Trip-Based.
+     * @param window_start Początek okna odjazdów (sekundy od północy); odjazdy spoza okna są pomijane.
+     * @param window_end Koniec okna odjazdów (sekundy od północy).
+     * @param threads Liczba wątków (0 – wszystkie dostępne).
+     * @return transfer_patterns Gotowy indeks.
+     */
+    static transfer_patterns build(const trip_based_index &tb,
+                                   int64_t window_start = 0,
+                                   int64_t window_end = 48 * 3600,
+                                   unsigned threads = 0);
+
+    /// Zapisuje indeks do pliku binarnego.
+    bool save(const std::string &path) const;
+
+    /// Wczytuje indeks z pliku; odrzuca plik zbudowany dla innego rozkładu.
+    static bool load(const trip_based_index &tb, const std::string &path, transfer_patterns &out);
+
+    /**
+     * @brief Wyszukuje trasę o najwcześniejszym przyjeździe, sprawdzając tylko wzorce z indeksu.
+     *
+     * @param tb Indeks Trip-Based, dla którego zbudowano wzorce.
+     * @param tt Rozkład, na podstawie którego zbudowano indeks Trip-Based.
+     * @param start Nazwa przystanku początkowego.
+     * @param end Nazwa przystanku docelowego.
+     * @param startTime Czas rozpoczęcia podróży.
+     * @param memory Pamięć tablic roboczych zapytania (np. arena query_workspace::memory()).
+     * @param stats Liczniki przeszukiwania (nullptr – bez liczników; patrz search_stats.h).
+     * @return std::pair<std::vector<edge>, double> Trasa oraz koszt (czas w sekundach);
+     *         {pusta trasa, -1.0}, jeśli żaden wzorzec nie daje połączenia.
+     */
+    std::pair<std::vector<edge>, double> query(const trip_based_index &tb,
+                                               const timetable &tt,
+                                               const std::string &start,
+                                               const std::string &end,
+                                               const std::chrono::system_clock::time_point &startTime,
+                                               std::pmr::memory_resource *memory = std::pmr::get_default_resource(),
+                                               search_stats *stats = nullptr) const;
+
+    /// Rozmiar indeksu w bajtach (tablice węzłów, zakończeń i przesunięć).
+    size_t size_in_bytes() const;
+    size_t node_count() const { return nodes.size(); }
+    size_t pattern_count() const { return targets.size(); }
+    const build_stats &stats() const { return statistics; }
+
+private:
+    uint64_t fingerprint = 0;
+    std::vector<uint32_t> origin_node_offset;    ///< Węzły przystanku s: nodes[offset[s], offset[s+1])
+    std::vector<tp_node> nodes;
+    std::vector<uint32_t> origin_target_offset;  ///< Zakończenia wzorców przystanku s, posortowane po przystanku
+    std::vector<tp_target> targets;
+    build_stats statistics;
+};
+
+#endif // TRANSFER_PATTERNS_H
@@ -0,0 +1,524 @@
+#include "trip_based.h"
+#include "../graph/trips.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x3142544c; // "LTB1"
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+int64_t to_seconds(const std::chrono::system_clock::time_point &tp) {
+    return std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch()).count();
+}
+
+// FNV-1a – odcisk rozkładu niezależny od dnia, dla którego wczytano plik CSV
+void fnv_mix(uint64_t &h, const void *data, size_t size) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ULL;
+    }
+}
+
+void fnv_mix(uint64_t &h, const std::string &name) {
+    fnv_mix(h, name.data(), name.size() + 1);
+}
+
+uint64_t timetable_fingerprint(const timetable &tt) {
+    const uint32_t connections = static_cast<uint32_t>(tt.connection_count());
+    int64_t base = LLONG_MAX;
+    for (uint32_t e = 0; e < connections; ++e) {
+        base = std::min(base, to_seconds(tt.departure_of(e)));
+    }
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (uint32_t e = 0; e < connections; ++e) {
+        int64_t times[2] = {to_seconds(tt.departure_of(e)) - base, to_seconds(tt.arrival_of(e)) - base};
+        fnv_mix(h, tt.line_name(tt.edge_line(e)));
+        fnv_mix(h, tt.stop_name(tt.edge_from(e)));
+        fnv_mix(h, tt.stop_name(tt.edge_to(e)));
+        fnv_mix(h, times, sizeof(times));
+    }
+    return h;
+}
+
+template <typename T>
+void write_vector(std::ofstream &out, const std::vector<T> &v) {
+    uint64_t size = v.size();
+    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.write(reinterpret_cast<const char *>(v.data()), static_cast<std::streamsize>(size * sizeof(T)));
+}
+
+template <typename T>
+bool read_vector(std::ifstream &in, std::vector<T> &v) {
+    uint64_t size = 0;
+    if (!in.read(reinterpret_cast<char *>(&size), sizeof(size))) return false;
+    v.resize(size);
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(v.data()), static_cast<std::streamsize>(size * sizeof(T))));
+}
+
+} // namespace
+
+void trip_based_index::derive(const timetable &tt) {
+    stops = static_cast<uint32_t>(tt.stop_count());
+
+    const uint32_t trips = static_cast<uint32_t>(trip_edge_offset.size() - 1);
+    trip_route.assign(trips, 0);
+    trip_rank.assign(trips, 0);
+    for (uint32_t r = 0; r + 1 < route_trip_offset.size(); ++r) {
+        for (uint32_t i = route_trip_offset[r]; i < route_trip_offset[r + 1]; ++i) {
+            trip_route[route_trips[i]] = r;
+            trip_rank[route_trips[i]] = i - route_trip_offset[r];
+        }
+    }
+
+    // Pozycje (kurs, indeks przystanku) – przyjazd na pierwszy przystanek utożsamiamy z odjazdem
+    const size_t positions = trip_edges.size() + trips;
+    position_stop.assign(positions, 0);
+    position_departure.assign(positions, 0);
+    position_arrival.assign(positions, 0);
+    for (uint32_t t = 0; t < trips; ++t) {
+        const uint32_t base = first_position(t);
+        const uint32_t n = stop_count(t);
+        for (uint32_t i = 0; i + 1 < n; ++i) {
+            const uint32_t e = trip_edges[trip_edge_offset[t] + i];
+            position_stop[base + i] = tt.edge_from(e);
+            position_departure[base + i] = to_seconds(tt.departure_of(e));
+            position_stop[base + i + 1] = tt.edge_to(e);
+            position_arrival[base + i + 1] = to_seconds(tt.arrival_of(e));
+        }
+        position_arrival[base] = position_departure[base];
+        position_departure[base + n - 1] = position_arrival[base + n - 1];
+    }
+
+    // Trasy obsługujące każdy przystanek (ciąg przystanków bierzemy z pierwszego kursu trasy)
+    stop_route_offset.assign(stops + 1, 0);
+    const uint32_t routes = static_cast<uint32_t>(route_count());
+    for (uint32_t r = 0; r < routes; ++r) {
+        const uint32_t t = route_trips[route_trip_offset[r]];
+        for (uint32_t i = 0; i < stop_count(t); ++i) {
+            ++stop_route_offset[position_stop[first_position(t) + i] + 1];
+        }
+    }
+    for (size_t s = 1; s < stop_route_offset.size(); ++s) {
+        stop_route_offset[s] += stop_route_offset[s - 1];
+    }
+    stop_routes.assign(stop_route_offset.back(), {});
+    std::vector<uint32_t> fill(stop_route_offset.begin(), stop_route_offset.end() - 1);
+    for (uint32_t r = 0; r < routes; ++r) {
+        const uint32_t t = route_trips[route_trip_offset[r]];
+        for (uint32_t i = 0; i < stop_count(t); ++i) {
+            stop_routes[fill[position_stop[first_position(t) + i]]++] = {r, i};
+        }
+    }
+}
+
+int64_t trip_based_index::earliest_trip(uint32_t route, uint32_t index, int64_t time) const {
+    auto first = route_trips.begin() + route_trip_offset[route];
+    auto last = route_trips.begin() + route_trip_offset[route + 1];
+    auto it = std::partition_point(first, last, [&](uint32_t t) {
+        return position_departure[first_position(t) + index] < time;
+    });
+    return it == last ? -1 : static_cast<int64_t>(*it);
+}
+
+trip_based_index trip_based_index::build(const timetable &tt, unsigned threads) {
+    trip_based_index index;
+    index.fingerprint = timetable_fingerprint(tt);
+
+    std::vector<trip> trips = group_into_trips(tt);
+    std::sort(trips.begin(), trips.end(), [&tt](const trip &a, const trip &b) {
+        return tt.departure_of(a.edges.front()) < tt.departure_of(b.edges.front());
+    });
+
+    index.trip_edge_offset.reserve(trips.size() + 1);
+    index.trip_edge_offset.push_back(0);
+    for (const auto &t : trips) {
+        index.trip_edges.insert(index.trip_edges.end(), t.edges.begin(), t.edges.end());
+        index.trip_edge_offset.push_back(static_cast<uint32_t>(index.trip_edges.size()));
+    }
+
+    // Trasy: kursy tej samej linii o identycznym ciągu przystanków, które się nie wyprzedzają
+    std::unordered_map<std::string, std::vector<uint32_t>> routes_by_key;
+    std::vector<std::vector<uint32_t>> routes;
+    for (uint32_t t = 0; t < trips.size(); ++t) {
+        const auto &te = trips[t].edges;
+        std::string key = trips[t].line;
+        for (uint32_t e : te) {
+            key += '\x1f';
+            key += tt.stop_name(tt.edge_from(e));
+        }
+        key += '\x1f';
+        key += tt.stop_name(tt.edge_to(te.back()));
+
+        auto &candidates = routes_by_key[key];
+        bool placed = false;
+        for (uint32_t r : candidates) {
+            const auto &prev = trips[routes[r].back()].edges;
+            bool overtakes = false;
+            for (size_t i = 0; i < te.size() && !overtakes; ++i) {
+                overtakes = tt.departure_of(te[i]) < tt.departure_of(prev[i]) ||
+                            tt.arrival_of(te[i]) < tt.arrival_of(prev[i]);
+            }
+            if (!overtakes) {
+                routes[r].push_back(t);
+                placed = true;
+                break;
+            }
+        }
+        if (!placed) {
+            candidates.push_back(static_cast<uint32_t>(routes.size()));
+            routes.push_back({t});
+        }
+    }
+
+    index.route_trip_offset.reserve(routes.size() + 1);
+    index.route_trip_offset.push_back(0);
+    for (const auto &r : routes) {
+        index.route_trips.insert(index.route_trips.end(), r.begin(), r.end());
+        index.route_trip_offset.push_back(static_cast<uint32_t>(index.route_trips.size()));
+    }
+
+    index.derive(tt);
+    index.compute_transfers(threads);
+    return index;
+}
+
+void trip_based_index::compute_transfers(unsigned threads) {
+    const uint32_t trips = static_cast<uint32_t>(trip_count());
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Przesiadki każdego kursu: (indeks przystanku przyjazdu, przesiadka)
+    std::vector<std::vector<std::pair<uint32_t, tb_transfer>>> per_trip(trips);
+    std::atomic<uint32_t> next{0};
+
+    auto worker = [&]() {
+        // Najwcześniejsze znane przyjazdy na przystanki dla bieżącego kursu (znaczniki zamiast czyszczenia)
+        std::vector<int64_t> tau(stops, 0);
+        std::vector<uint32_t> stamp(stops, 0);
+        uint32_t generation = 0;
+        auto improve = [&](uint32_t stop, int64_t arrival) {
+            if (stamp[stop] != generation || arrival < tau[stop]) {
+                stamp[stop] = generation;
+                tau[stop] = arrival;
+                return true;
+            }
+            return false;
+        };
+        std::vector<std::vector<tb_transfer>> candidates;
+
+        for (uint32_t t = next++; t < trips; t = next++) {
+            ++generation;
+            const uint32_t base = first_position(t);
+            const uint32_t n = stop_count(t);
+            candidates.assign(n, {});
+
+            for (uint32_t i = 1; i < n; ++i) {
+                const uint32_t stop = position_stop[base + i];
+                const int64_t arrival = position_arrival[base + i];
+                for (uint32_t s = stop_route_offset[stop]; s < stop_route_offset[stop + 1]; ++s) {
+                    const tb_route_stop rs = stop_routes[s];
+                    const uint32_t route_len = stop_count(route_trips[route_trip_offset[rs.route]]);
+                    if (rs.index + 1 >= route_len) continue;               // z ostatniego przystanku nie odjedziemy
+                    if (rs.route == trip_route[t] && rs.index >= i) continue; // lepiej zostać w tym samym kursie
+                    int64_t u = earliest_trip(rs.route, rs.index, arrival);
+                    if (u < 0) continue;
+                    const uint32_t ubase = first_position(static_cast<uint32_t>(u));
+                    // Zawracanie: tę samą przesiadkę można było wykonać przystanek wcześniej
+                    if (position_stop[base + i - 1] == position_stop[ubase + rs.index + 1] &&
+                        position_arrival[base + i - 1] <= position_departure[ubase + rs.index + 1]) {
+                        continue;
+                    }
+                    candidates[i].push_back({static_cast<uint32_t>(u), rs.index});
+                }
+            }
+
+            // Redukcja: zostawiamy tylko przesiadki poprawiające przyjazd na jakikolwiek przystanek
+            auto &kept = per_trip[t];
+            for (uint32_t i = n - 1; i >= 1; --i) {
+                improve(position_stop[base + i], position_arrival[base + i]);
+                for (const auto &tr : candidates[i]) {
+                    const uint32_t ubase = first_position(tr.trip);
+                    const uint32_t un = stop_count(tr.trip);
+                    bool keep = false;
+                    for (uint32_t k = tr.index + 1; k < un; ++k) {
+                        keep |= improve(position_stop[ubase + k], position_arrival[ubase + k]);
+                    }
+                    if (keep) kept.push_back({i, tr});
+                }
+            }
+            std::stable_sort(kept.begin(), kept.end(), [](const auto &a, const auto &b) {
+                return a.first < b.first;
+            });
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &th : pool) {
+        th.join();
+    }
+
+    transfer_offset.assign(position_stop.size() + 1, 0);
+    transfers.clear();
+    for (uint32_t t = 0; t < trips; ++t) {
+        for (const auto &[i, tr] : per_trip[t]) {
+            ++transfer_offset[first_position(t) + i + 1];
+            transfers.push_back(tr);
+        }
+    }
+    for (size_t p = 1; p < transfer_offset.size(); ++p) {
+        transfer_offset[p] += transfer_offset[p - 1];
+    }
+}
+
+std::pair<std::vector<edge>, double> trip_based_index::query(
+    const timetable &tt,
+    query_workspace &ws,
+    const std::string &start,
+    const std::string &end,
+    const std::chrono::system_clock::time_point &startTime) const
+{
+    const uint32_t source = tt.stop_id(start);
+    const uint32_t target = tt.stop_id(end);
+    if (source == timetable::NONE || target == timetable::NONE) {
+        return {{}, -1.0};
+    }
+    if (start == end) {
+        return {{}, 0.0};
+    }
+    const int64_t departure = to_seconds(startTime);
+    search_stats *stats = ws.stats();
+
+    // Fragment kursu: wsiadamy na przystanku `from`, wysiąść można na przystankach (from, to]
+    struct segment {
+        uint32_t trip;
+        uint32_t from;
+        uint32_t to;
+        int32_t parent;
+        uint32_t parent_alight;
+        uint32_t round;
+    };
+    std::pmr::vector<segment> segments(ws.memory());
+
+    // Kurs nieosiągnięty (TRIP_NOT_REACHED) przeglądamy do ostatniego przystanku. Wsiadamy zawsze
+    // przed ostatnim przystankiem, więc sprawdzenie dominacji to jeden odczyt
+    ws.begin(tt);
+    ws.begin_trips(trip_count());
+
+    auto enqueue = [&](uint32_t t, uint32_t board, int32_t parent, uint32_t alight, uint32_t round) {
+        if (board >= ws.trip_reach(t)) {
+            SEARCH_COUNT(stats, dominated_labels, 1);
+            return;
+        }
+        segments.push_back({t, board, std::min(ws.trip_reach(t), stop_count(t) - 1), parent, alight, round});
+        SEARCH_COUNT(stats, labels_pushed, 1);
+        SEARCH_PEAK(stats, peak_queue, segments.size());
+        // Późniejsze kursy tej samej trasy są zdominowane od przystanku `board`
+        const uint32_t r = trip_route[t];
+        for (uint32_t i = route_trip_offset[r] + trip_rank[t]; i < route_trip_offset[r + 1]; ++i) {
+            const uint32_t later = route_trips[i];
+            if (ws.trip_reach(later) <= board) break;
+            ws.set_trip_reach(later, board);
+        }
+    };
+
+    for (uint32_t s = stop_route_offset[source]; s < stop_route_offset[source + 1]; ++s) {
+        const tb_route_stop rs = stop_routes[s];
+        if (rs.index + 1 >= stop_count(route_trips[route_trip_offset[rs.route]])) continue; // ostatni przystanek trasy
+        int64_t t = earliest_trip(rs.route, rs.index, departure);
+        if (t >= 0) {
+            enqueue(static_cast<uint32_t>(t), rs.index, -1, 0, 0);
+        }
+    }
+
+    int64_t best_arrival = LLONG_MAX;
+    int32_t best_segment = -1;
+    uint32_t best_alight = 0;
+    for (size_t q = 0; q < segments.size(); ++q) {
+        const segment seg = segments[q];
+        if (seg.round > MAX_ROUNDS) break;
+        SEARCH_COUNT(stats, labels_popped, 1);
+        const uint32_t base = first_position(seg.trip);
+        for (uint32_t k = seg.from + 1; k <= seg.to; ++k) {
+            const uint32_t p = base + k;
+            SEARCH_COUNT(stats, edges_scanned, 1);
+            if (position_arrival[p] >= best_arrival) break;
+            if (position_stop[p] == target) {
+                best_arrival = position_arrival[p];
+                best_segment = static_cast<int32_t>(q);
+                best_alight = k;
+                break;
+            }
+            SEARCH_COUNT(stats, edges_relaxed, transfer_offset[p + 1] - transfer_offset[p]);
+            for (uint32_t x = transfer_offset[p]; x < transfer_offset[p + 1]; ++x) {
+                enqueue(transfers[x].trip, transfers[x].index, static_cast<int32_t>(q), k, seg.round + 1);
+            }
+        }
+    }
+
+    if (best_segment < 0) {
+        return {{}, -1.0};
+    }
+
+    // Jeden przydział na zwracaną trasę – najpierw liczymy jej krawędzie
+    size_t length = 0;
+    uint32_t alight = best_alight;
+    for (int32_t q = best_segment; q >= 0; q = segments[q].parent) {
+        length += alight - segments[q].from;
+        alight = segments[q].parent_alight;
+    }
+    std::vector<edge> route;
+    route.reserve(length);
+    alight = best_alight;
+    for (int32_t q = best_segment; q >= 0; q = segments[q].parent) {
+        const segment &seg = segments[q];
+        for (uint32_t i = alight; i-- > seg.from;) {
+            route.push_back(tt.edge_at(trip_edges[trip_edge_offset[seg.trip] + i], timetable::duration::zero()));
+        }
+        alight = seg.parent_alight;
+    }
+    std::reverse(route.begin(), route.end());
+    return {std::move(route), static_cast<double>(best_arrival - departure)};
+}
+
+void trip_based_index::profile_scratch::begin(size_t stops, size_t trips, uint32_t source, int64_t departure) {
+    constexpr size_t rounds = MAX_ROUNDS + 1;
+    // Kursy osiągnięte przy późniejszych odjazdach z tego samego przystanku zostają (zob. one_to_all)
+    if (source != origin || departure >= last_departure || trip_reach.size() < trips * rounds) {
+        for (uint32_t trip : reached_trips) {
+            std::fill_n(trip_reach.begin() + trip * rounds, rounds, UINT32_MAX);
+        }
+        reached_trips.clear();
+        if (trip_reach.size() < trips * rounds) {
+            trip_reach.resize(trips * rounds, UINT32_MAX);
+        }
+        origin = source;
+    }
+    last_departure = departure;
+
+    for (uint32_t stop : reached_stops) {
+        best[stop] = LLONG_MAX;
+        marked_round[stop] = UINT32_MAX;
+    }
+    reached_stops.clear();
+    if (best.size() < stops) {
+        best.resize(stops, LLONG_MAX);
+        best_segment.resize(stops, -1);
+        marked_round.resize(stops, UINT32_MAX);
+    }
+    segments.clear();
+    improved.clear();
+}
+
+bool trip_based_index::direct_leg(uint32_t from_stop, uint32_t to_stop, int64_t time, tb_leg &leg) const {
+    bool found = false;
+    for (uint32_t s = stop_route_offset[from_stop]; s < stop_route_offset[from_stop + 1]; ++s) {
+        const tb_route_stop rs = stop_routes[s];
+        const uint32_t first_trip = route_trips[route_trip_offset[rs.route]];
+        const uint32_t n = stop_count(first_trip);
+        uint32_t to = rs.index + 1;
+        while (to < n && position_stop[first_position(first_trip) + to] != to_stop) {
+            ++to;
+        }
+        if (to >= n) continue;
+        int64_t t = earliest_trip(rs.route, rs.index, time);
+        if (t < 0) continue;
+        const int64_t arrival = position_arrival[first_position(static_cast<uint32_t>(t)) + to];
+        if (!found || arrival < leg.arrival) {
+            leg = {static_cast<uint32_t>(t), rs.index, to, arrival};
+            found = true;
+        }
+    }
+    return found;
+}
+
+void trip_based_index::append_leg(const timetable &tt, const tb_leg &leg, std::vector<edge> &route) const {
+    for (uint32_t i = leg.from; i < leg.to; ++i) {
+        route.push_back(tt.edge_at(trip_edges[trip_edge_offset[leg.trip] + i], timetable::duration::zero()));
+    }
+}
+
+std::vector<int64_t> trip_based_index::departures_from(uint32_t stop) const {
+    std::vector<int64_t> result;
+    for (uint32_t s = stop_route_offset[stop]; s < stop_route_offset[stop + 1]; ++s) {
+        const tb_route_stop rs = stop_routes[s];
+        for (uint32_t i = route_trip_offset[rs.route]; i < route_trip_offset[rs.route + 1]; ++i) {
+            const uint32_t t = route_trips[i];
+            if (rs.index + 1 < stop_count(t)) {
+                result.push_back(position_departure[first_position(t) + rs.index]);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), std::greater<>());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+bool trip_based_index::save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(&SNAPSHOT_MAGIC), sizeof(SNAPSHOT_MAGIC));
+    out.write(reinterpret_cast<const char *>(&SNAPSHOT_VERSION), sizeof(SNAPSHOT_VERSION));
+    out.write(reinterpret_cast<const char *>(&fingerprint), sizeof(fingerprint));
+    write_vector(out, trip_edge_offset);
+    write_vector(out, trip_edges);
+    write_vector(out, route_trip_offset);
+    write_vector(out, route_trips);
+    write_vector(out, transfer_offset);
+    write_vector(out, transfers);
+    return static_cast<bool>(out);
+}
+
+bool trip_based_index::load(const timetable &tt, const std::string &path, trip_based_index &out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    uint32_t magic = 0, version = 0;
+    trip_based_index index;
+    in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    in.read(reinterpret_cast<char *>(&index.fingerprint), sizeof(index.fingerprint));
+    if (!in || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION ||
+        index.fingerprint != timetable_fingerprint(tt)) {
+        return false;
+    }
+    if (!read_vector(in, index.trip_edge_offset) || !read_vector(in, index.trip_edges) ||
+        !read_vector(in, index.route_trip_offset) || !read_vector(in, index.route_trips) ||
+        !read_vector(in, index.transfer_offset) || !read_vector(in, index.transfers)) {
+        return false;
+    }
+    if (index.trip_edge_offset.empty() || index.route_trip_offset.empty() ||
+        index.trip_edge_offset.back() != index.trip_edges.size() ||
+        index.route_trips.size() + 1 != index.trip_edge_offset.size() ||
+        index.transfer_offset.size() != index.trip_edges.size() + index.route_trips.size() + 1 ||
+        index.transfer_offset.back() != index.transfers.size()) {
+        return false;
+    }
+    for (uint32_t e : index.trip_edges) {
+        if (e >= tt.connection_count()) return false;
+    }
+    index.derive(tt);
+    out = std::move(index);
+    return true;
+}
+
+size_t trip_based_index::size_in_bytes() const {
+    return vector_bytes(trip_edge_offset) + vector_bytes(trip_edges) + vector_bytes(route_trip_offset) +
+           vector_bytes(route_trips) + vector_bytes(transfer_offset) + vector_bytes(transfers) +
+           vector_bytes(trip_route) + vector_bytes(trip_rank) +
+           vector_bytes(position_stop) + vector_bytes(position_departure) + vector_bytes(position_arrival) +
+           vector_bytes(stop_route_offset) + vector_bytes(stop_routes);
+}
@@ -0,0 +1,317 @@
+#ifndef TRIP_BASED_H
+#define TRIP_BASED_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <chrono>
+#include "../graph/edge.h"
+#include "../graph/memory_usage.h"
+#include "../graph/timetable.h"
+#include "../algorithms_utils/query_workspace.h"
+
+/**
+ * @struct tb_transfer
+ * @brief Przesiadka z kursu na kurs w indeksie Trip-Based.
+ */
+struct tb_transfer {
+    uint32_t trip;  ///< Kurs, do którego się przesiadamy
+    uint32_t index; ///< Indeks przystanku w tym kursie, na którym wsiadamy
+};
+
+/**
+ * @struct tb_route_stop
+ * @brief Wystąpienie przystanku na trasie (ciągu przystanków wspólnym dla grupy kursów).
+ */
+struct tb_route_stop {
+    uint32_t route; ///< Indeks trasy
+    uint32_t index; ///< Indeks przystanku w trasie
+};
+
+/**
+ * @struct tb_leg
+ * @brief Przejazd jednym kursem bez przesiadki: od przystanku o indeksie `from` do `to`.
+ */
+struct tb_leg {
+    uint32_t trip;    ///< Kurs
+    uint32_t from;    ///< Indeks przystanku wsiadania w kursie
+    uint32_t to;      ///< Indeks przystanku wysiadania w kursie
+    int64_t arrival;  ///< Czas przyjazdu (sekundy)
+};
+
+/**
+ * @class trip_based_index
+ * @brief Indeks do wyszukiwania tras metodą Trip-Based Public Transit Routing.
+ *
+ * Połączenia rozkładu (timetable) grupowane są w kursy (group_into_trips), a kursy o identycznym
+ * ciągu przystanków i niewyprzedzające się nawzajem – w trasy. Przystanki mają numery rozkładu, a trasy
+ * wyników odtwarzane są z jego połączeń (timetable::edge_at), więc indeks nie trzyma kopii krawędzi. W fazie prekomputacji dla każdego przyjazdu kursu
+ * na przystanek wyznaczane są przesiadki na najwcześniejsze kursy każdej trasy obsługującej ten
+ * przystanek, a następnie usuwane są przesiadki zbędne (zawracanie oraz takie, które nie
+ * poprawiają czasu dojazdu do żadnego przystanku). Prekomputacja jest rozdzielana na wątki
+ * względem kursów.
+ *
+ * Zapytanie to przeszukiwanie wszerz po fragmentach kursów – kolejne poziomy odpowiadają
+ * kolejnym przesiadkom. Stan kursów trzyma query_workspace ze znacznikami zapytania, więc zapytanie
+ * kosztuje tyle, ile kursów faktycznie odwiedza, a nie O(liczba kursów). Wynik (zbiór przesiadek wraz z kursami) można zapisać do binarnego
+ * pliku migawki i wczytać przy następnym uruchomieniu.
+ */
+class trip_based_index {
+public:
+    /**
+     * @brief Buduje indeks na podstawie rozkładu.
+     *
+     * @param tt Rozkład jazdy (statyczny; indeks odwołuje się do numerów jego połączeń i przystanków).
+     * @param threads Liczba wątków prekomputacji (0 – std::thread::hardware_concurrency()).
+     * @return trip_based_index Gotowy indeks.
+     */
+    static trip_based_index build(const timetable &tt, unsigned threads = 0);
+
+    /**
+     * @brief Zapisuje indeks do binarnego pliku migawki.
+     * @return true, jeśli zapis się powiódł.
+     */
+    bool save(const std::string &path) const;
+
+    /**
+     * @brief Wczytuje indeks z binarnego pliku migawki.
+     *
+     * Migawka zawiera odcisk rozkładu (linie, przystanki i względne czasy krawędzi), dlatego
+     * migawka zbudowana dla innego rozkładu jest odrzucana.
+     *
+     * @param tt Rozkład, dla którego migawka została zbudowana.
+     * @param path Ścieżka do pliku migawki.
+     * @param out Indeks wypełniany przy powodzeniu.
+     * @return true, jeśli migawka została wczytana.
+     */
+    static bool load(const timetable &tt, const std::string &path, trip_based_index &out);
+
+    /**
+     * @brief Wyszukuje trasę o najwcześniejszym czasie przyjazdu.
+     *
+     * @param tt Rozkład, na podstawie którego zbudowano indeks.
+     * @param ws Przestrzeń robocza zapytania należąca do bieżącego wątku (znaczniki kursów, arena, liczniki).
+     * @param start Nazwa przystanku początkowego.
+     * @param end Nazwa przystanku docelowego.
+     * @param startTime Czas rozpoczęcia podróży.
+     * @return std::pair<std::vector<edge>, double> Trasa oraz koszt (czas w sekundach);
+     *         {pusta trasa, -1.0}, jeśli trasy nie znaleziono.
+     */
+    std::pair<std::vector<edge>, double> query(const timetable &tt,
+                                               query_workspace &ws,
+                                               const std::string &start,
+                                               const std::string &end,
+                                               const std::chrono::system_clock::time_point &startTime) const;
+
+    /**
+     * @class profile_scratch
+     * @brief Stan przeszukiwania profilowego one_to_all, wielokrotnie używany przez jeden wątek z jednym indeksem.
+     *
+     * Przechowuje, od którego przystanku każdy kurs był już przeglądany przy co najwyżej n przesiadkach –
+     * także przy późniejszych odjazdach z tego samego przystanku (zob. one_to_all). Kolejne wywołanie
+     * przywraca tylko wpisy zmienione przez poprzednie (jak query_workspace::begin_trips), więc nie czyści
+     * całych tablic i po pierwszym nie alokuje pamięci.
+     */
+    class profile_scratch {
+        friend class trip_based_index;
+
+        struct segment {
+            uint32_t trip;
+            uint32_t from;
+            uint32_t to;
+            int32_t parent;
+            uint32_t round;
+        };
+
+        /// Przygotowuje bufory do przeszukiwania z `source` o czasie `departure` indeksu o `stops` przystankach
+        /// i `trips` kursach; stan kursów zostaje, jeśli to kolejny, wcześniejszy odjazd z tego samego przystanku.
+        void begin(size_t stops, size_t trips, uint32_t source, int64_t departure);
+
+        uint32_t origin = UINT32_MAX;
+        int64_t last_departure = LLONG_MIN;
+        std::vector<segment> segments;
+        /// [kurs * (MAX_ROUNDS + 1) + n]: pierwszy przystanek kursu, od którego kurs jest już przeglądany
+        /// przy co najwyżej n przesiadkach (UINT32_MAX – jeszcze nie)
+        std::vector<uint32_t> trip_reach;
+        std::vector<uint32_t> reached_trips; ///< Kursy z wpisami trip_reach różnymi od UINT32_MAX
+        std::vector<int64_t> best;           ///< Najwcześniejszy przyjazd na przystanek
+        std::vector<int32_t> best_segment;   ///< Fragment, z którego uzyskano przyjazd
+        std::vector<uint32_t> marked_round;  ///< Poziom, na którym przystanek trafił do `improved`
+        std::vector<uint32_t> reached_stops; ///< Przystanki z best różnym od LLONG_MAX
+        std::vector<uint32_t> improved;
+        std::vector<uint32_t> pattern;
+    };
+
+    /**
+     * @brief Przeszukiwanie jeden-do-wszystkich dla ustalonego czasu odjazdu.
+     *
+     * Po każdym poziomie przeszukiwania (liczbie przesiadek) wywołuje `on_arrival` dla każdego
+     * przystanku, na który poprawiono najwcześniejszy przyjazd. Wzorzec to ciąg przystanków
+     * wsiadania (od przystanku początkowego) zakończony przystankiem przyjazdu.
+     *
+     * Wywołania z tym samym `scratch` dla jednego przystanku i malejących czasów odjazdu tworzą
+     * przeszukiwanie profilowe: fragment kursu osiągnięty już przy późniejszym odjeździe z nie większą
+     * liczbą przesiadek jest pomijany, bo każda podróż przez niego jest zdominowana. Takie podróże nie
+     * trafiają wtedy do `on_arrival` (a najwcześniejsze przyjazdy pojedynczego odjazdu mogą być pominięte).
+     * Inny przystanek albo nie wcześniejszy odjazd rozpoczyna profil od nowa.
+     *
+     * @param source Identyfikator przystanku początkowego.
+     * @param departure Czas odjazdu (sekundy).
+     * @param scratch Stan przeszukiwania wątku wywołującego.
+     * @param on_arrival Wywoływana z (przystanek, liczba przesiadek, przyjazd, const std::vector<uint32_t> &wzorzec).
+     */
+    template <typename OnArrival>
+    void one_to_all(uint32_t source, int64_t departure, profile_scratch &scratch, OnArrival &&on_arrival) const;
+
+    /**
+     * @brief Wyszukuje najwcześniejszy bezpośredni przejazd (jednym kursem) między przystankami.
+     *
+     * @param from_stop Identyfikator przystanku wsiadania.
+     * @param to_stop Identyfikator przystanku wysiadania.
+     * @param time Najwcześniejszy możliwy odjazd (sekundy).
+     * @param leg Wypełniany przejazd o najwcześniejszym przyjeździe.
+     * @return true, jeśli przejazd istnieje.
+     */
+    bool direct_leg(uint32_t from_stop, uint32_t to_stop, int64_t time, tb_leg &leg) const;
+
+    /// Dopisuje krawędzie przejazdu `leg` na koniec trasy `route`.
+    void append_leg(const timetable &tt, const tb_leg &leg, std::vector<edge> &route) const;
+
+    /// Czasy odjazdów kursów z przystanku (sekundy), posortowane malejąco i bez powtórzeń.
+    std::vector<int64_t> departures_from(uint32_t stop) const;
+
+    /// Odcisk rozkładu, dla którego zbudowano indeks.
+    uint64_t get_fingerprint() const { return fingerprint; }
+
+    size_t stop_total() const { return stops; }
+    size_t trip_count() const { return trip_route.size(); }
+    size_t route_count() const { return route_trip_offset.empty() ? 0 : route_trip_offset.size() - 1; }
+    size_t transfer_count() const { return transfers.size(); }
+    /// Przybliżony rozmiar indeksu w pamięci (bajty).
+    size_t size_in_bytes() const;
+
+private:
+    /// Ustala przystanki, czasy i pozycje kursów na podstawie połączeń rozkładu i tablic kursów.
+    void derive(const timetable &tt);
+    /// Wyznacza i redukuje przesiadki dla wszystkich kursów.
+    void compute_transfers(unsigned threads);
+    /// Najwcześniejszy kurs trasy odjeżdżający z przystanku o indeksie `index` nie wcześniej niż `time`.
+    int64_t earliest_trip(uint32_t route, uint32_t index, int64_t time) const;
+
+    uint32_t first_position(uint32_t t) const { return trip_edge_offset[t] + t; }
+    uint32_t stop_count(uint32_t t) const { return trip_edge_offset[t + 1] - trip_edge_offset[t] + 1; }
+
+    // --- dane zapisywane w migawce ---
+    uint64_t fingerprint = 0;
+    std::vector<uint32_t> trip_edge_offset;   ///< Kurs t to krawędzie trip_edges[offset[t], offset[t+1])
+    std::vector<uint32_t> trip_edges;
+    std::vector<uint32_t> route_trip_offset;  ///< Kursy trasy r posortowane po odjeździe
+    std::vector<uint32_t> route_trips;
+    std::vector<uint32_t> transfer_offset;    ///< Przesiadki z pozycji p: transfers[offset[p], offset[p+1])
+    std::vector<tb_transfer> transfers;
+
+    // --- dane wyprowadzane z rozkładu ---
+    uint32_t stops = 0;                       ///< Liczba przystanków rozkładu
+    std::vector<uint32_t> trip_route;         ///< Trasa kursu
+    std::vector<uint32_t> trip_rank;          ///< Pozycja kursu na liście kursów trasy
+    std::vector<uint32_t> position_stop;      ///< Przystanek na pozycji (kurs, indeks)
+    std::vector<int64_t> position_departure;  ///< Odjazd z pozycji (sekundy)
+    std::vector<int64_t> position_arrival;    ///< Przyjazd na pozycję (sekundy)
+    std::vector<uint32_t> stop_route_offset;  ///< Trasy obsługujące przystanek s
+    std::vector<tb_route_stop> stop_routes;
+
+    /// Maksymalna liczba przesiadek rozważana w przeszukiwaniu
+    static constexpr uint32_t MAX_ROUNDS = 32;
+};
+
+template <typename OnArrival>
+void trip_based_index::one_to_all(uint32_t source, int64_t departure, profile_scratch &scratch,
+                                  OnArrival &&on_arrival) const {
+    constexpr size_t ROUNDS = MAX_ROUNDS + 1;
+    profile_scratch &s = scratch;
+    s.begin(stops, trip_count(), source, departure);
+    // Tablice buforów nie zmieniają już rozmiaru. Wskaźniki i granice pętli trzymamy w zmiennych lokalnych,
+    // bo kompilator nie wie, że zapisy do buforów nie zmieniają tablic indeksu, i czytałby je po każdym zapisie
+    uint32_t *const reached = s.trip_reach.data();
+    int64_t *const best = s.best.data();
+    int32_t *const best_segment = s.best_segment.data();
+    uint32_t *const marked_round = s.marked_round.data();
+
+    // Kurs nieosiągnięty ma wpisy UINT32_MAX, a wsiadamy zawsze przed ostatnim przystankiem. Kursy późniejsze
+    // na tej samej trasie są zdominowane od przystanku `board` na tym i każdym dalszym poziomie.
+    // Całość jest wstawiana w miejsce wywołania, więc gorącą pętlę trzeba wymusić (jak w label_setting_engine)
+    auto enqueue = [&](uint32_t t, uint32_t board, int32_t parent, uint32_t round) SCAN_ALWAYS_INLINE {
+        const uint32_t to = reached[t * ROUNDS + round];
+        if (board >= to) return;
+        s.segments.push_back({t, board, to, parent, round});
+        const uint32_t r = trip_route[t];
+        const uint32_t last = route_trip_offset[r + 1];
+        for (uint32_t i = route_trip_offset[r] + trip_rank[t]; i < last; ++i) {
+            uint32_t *const reach = reached + route_trips[i] * ROUNDS;
+            if (reach[round] <= board) break;
+            if (reach[MAX_ROUNDS] == UINT32_MAX) s.reached_trips.push_back(route_trips[i]);
+            for (uint32_t n = round; n <= MAX_ROUNDS && reach[n] > board; ++n) {
+                reach[n] = board;
+            }
+        }
+    };
+
+    for (uint32_t i = stop_route_offset[source]; i < stop_route_offset[source + 1]; ++i) {
+        if (stop_routes[i].index + 1 >= stop_count(route_trips[route_trip_offset[stop_routes[i].route]])) continue;
+        int64_t t = earliest_trip(stop_routes[i].route, stop_routes[i].index, departure);
+        if (t >= 0) {
+            enqueue(static_cast<uint32_t>(t), stop_routes[i].index, -1, 0);
+        }
+    }
+
+    auto flush = [&](uint32_t round) SCAN_NOINLINE {
+        for (uint32_t stop : s.improved) {
+            s.pattern.clear();
+            s.pattern.push_back(stop);
+            for (int32_t q = best_segment[stop]; q >= 0; q = s.segments[q].parent) {
+                s.pattern.push_back(position_stop[first_position(s.segments[q].trip) + s.segments[q].from]);
+            }
+            std::reverse(s.pattern.begin(), s.pattern.end());
+            on_arrival(stop, round, best[stop], std::as_const(s.pattern));
+        }
+        s.improved.clear();
+    };
+
+    uint32_t round = 0;
+    for (size_t q = 0; q < s.segments.size(); ++q) {
+        const auto seg = s.segments[q];
+        if (seg.round != round) {
+            flush(round);
+            round = seg.round;
+        }
+        const uint32_t base = first_position(seg.trip);
+        const uint32_t to = std::min(seg.to, stop_count(seg.trip) - 1);
+        for (uint32_t k = seg.from + 1; k <= to; ++k) {
+            const uint32_t p = base + k;
+            const uint32_t stop = position_stop[p];
+            const int64_t arrival = position_arrival[p];
+            if (stop != source && arrival < best[stop]) {
+                if (best[stop] == LLONG_MAX) s.reached_stops.push_back(stop);
+                if (marked_round[stop] != seg.round) {
+                    marked_round[stop] = seg.round;
+                    s.improved.push_back(stop);
+                }
+                best[stop] = arrival;
+                best_segment[stop] = static_cast<int32_t>(q);
+            }
+            if (seg.round == MAX_ROUNDS) continue;
+            const uint32_t first_transfer = transfer_offset[p];
+            const uint32_t last_transfer = transfer_offset[p + 1];
+            for (uint32_t x = first_transfer; x < last_transfer; ++x) {
+                const tb_transfer tr = transfers[x];
+                enqueue(tr.trip, tr.index, static_cast<int32_t>(q), seg.round + 1);
+            }
+        }
+    }
+    flush(round);
+}
+
+#endif // TRIP_BASED_H
@@ -0,0 +1,46 @@
+#include "query_arena.h"
+
+#include <algorithm>
+
+void *counting_resource::do_allocate(size_t size, size_t alignment) {
+    ++allocations;
+    bytes += size;
+    return upstream->allocate(size, alignment);
+}
+
+void counting_resource::do_deallocate(void *p, size_t size, size_t alignment) {
+    upstream->deallocate(p, size, alignment);
+}
+
+bool counting_resource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+query_arena::query_arena(size_t initial_bytes)
+    : back(std::pmr::new_delete_resource()),
+      buffer(new std::byte[initial_bytes]),
+      buffer_size(initial_bytes),
+      front(nullptr) {
+    arena.emplace(buffer.get(), buffer_size, &back);
+    front = counting_resource(&*arena);
+}
+
+void query_arena::reset() {
+    // Zapytanie nie zmieściło się w buforze – następne dostanie bufor na całe zużycie (z zapasem na wyrównania)
+    const size_t used = front.bytes + front.bytes / 8;
+    if (back.allocations > 0 && buffer_size < MAX_RETAINED) {
+        arena.reset();
+        buffer_size = std::min(MAX_RETAINED, std::max(buffer_size * 2, used));
+        buffer.reset(new std::byte[buffer_size]);
+        arena.emplace(buffer.get(), buffer_size, &back);
+        front = counting_resource(&*arena);
+    } else {
+        arena->release();
+    }
+    front.allocations = front.bytes = 0;
+    back.allocations = back.bytes = 0;
+}
+
+arena_stats query_arena::stats() const {
+    return {front.allocations, front.bytes, back.allocations, back.bytes};
+}
@@ -0,0 +1,82 @@
+#ifndef QUERY_ARENA_H
+#define QUERY_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/**
+ * @struct arena_stats
+ * @brief Liczniki przydziałów pamięci jednego zapytania.
+ */
+struct arena_stats {
+    uint64_t allocations = 0;          ///< Przydziały obsłużone przez arenę
+    uint64_t bytes = 0;                ///< Bajty przydzielone z areny
+    uint64_t upstream_allocations = 0; ///< Wywołania globalnego alokatora (bufor areny się wyczerpał)
+    uint64_t upstream_bytes = 0;       ///< Bajty przydzielone przez globalny alokator
+};
+
+/**
+ * @class counting_resource
+ * @brief Zasób pamięci przekazujący przydziały do `upstream` i zliczający je.
+ */
+class counting_resource : public std::pmr::memory_resource {
+public:
+    explicit counting_resource(std::pmr::memory_resource *upstream) : upstream(upstream) {}
+
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+private:
+    void *do_allocate(size_t size, size_t alignment) override;
+    void do_deallocate(void *p, size_t size, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    std::pmr::memory_resource *upstream;
+};
+
+/**
+ * @class query_arena
+ * @brief Monotoniczna arena pamięci na czas jednego zapytania.
+ *
+ * Kontenery zapytania (fragmenty tras, kolejki, listy tabu, tablice Trip-Based) przydzielają pamięć,
+ * przesuwając wskaźnik we własnym buforze areny; zwolnienia są ignorowane, a całą pamięć odzyskuje
+ * reset() przed następnym zapytaniem. Bufor jest zachowywany między zapytaniami, a jeśli zapytanie go
+ * przepełniło (nadmiar pochodzi z globalnego alokatora), reset() powiększa go do zużytego rozmiaru.
+ * Po rozgrzaniu zapytania nie wywołują więc globalnego alokatora.
+ *
+ * Obiekt nie jest bezpieczny wielowątkowo – należy do query_workspace jednego wątku.
+ */
+class query_arena {
+public:
+    explicit query_arena(size_t initial_bytes = 64 * 1024);
+
+    query_arena(const query_arena &) = delete;
+    query_arena &operator=(const query_arena &) = delete;
+
+    /// Zasób pamięci dla kontenerów std::pmr bieżącego zapytania.
+    std::pmr::memory_resource *resource() { return &front; }
+
+    /// Zwalnia pamięć poprzedniego zapytania i zeruje liczniki (unieważnia wszystkie przydziały).
+    void reset();
+
+    /// Liczniki od ostatniego reset().
+    arena_stats stats() const;
+
+    /// Rozmiar bufora areny w bajtach.
+    size_t capacity() const { return buffer_size; }
+
+private:
+    /// Największy bufor zachowywany między zapytaniami – większe zapytania korzystają z globalnego alokatora.
+    static constexpr size_t MAX_RETAINED = size_t(64) << 20;
+
+    counting_resource back;   ///< Przydziały poza buforem (globalny alokator)
+    std::unique_ptr<std::byte[]> buffer;
+    size_t buffer_size;
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+    counting_resource front;  ///< Wszystkie przydziały zapytania
+};
+
+#endif // QUERY_ARENA_H
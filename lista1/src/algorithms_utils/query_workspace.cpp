@@ -0,0 +1,82 @@
+#include "query_workspace.h"
+
+void query_workspace::begin(const timetable &tt) {
+    // Etykiety indeksowane są przystankami albo parami (przystanek, linia) ze slotem początkowym
+    // i slotami dojścia pieszego na każdy przystanek
+    const size_t entries = tt.slot_count() + 1 + tt.stop_count();
+    if (stamp.size() < entries) {
+        stamp.resize(entries, 0);
+        settled_stamp.resize(entries, 0);
+        times.resize(entries);
+        counts.resize(entries);
+        edges.resize(entries);
+    }
+    if (estimate_stamp.size() < tt.stop_count()) {
+        estimate_stamp.resize(tt.stop_count(), 0);
+        estimates.resize(tt.stop_count());
+    }
+    if (line_stamp.size() < tt.line_count()) {
+        line_stamp.resize(tt.line_count(), 0);
+    }
+
+    if (++generation == 0) {
+        // Przepełnienie licznika – jedyny moment, w którym znaczniki trzeba wyzerować
+        std::fill(stamp.begin(), stamp.end(), 0);
+        std::fill(settled_stamp.begin(), settled_stamp.end(), 0);
+        std::fill(estimate_stamp.begin(), estimate_stamp.end(), 0);
+        std::fill(line_stamp.begin(), line_stamp.end(), 0);
+        generation = 1;
+    }
+    labels.clear();
+    heap.clear();
+}
+
+void query_workspace::begin_trips(size_t trips) {
+    for (uint32_t trip : reached_trips) {
+        trip_reaches[trip] = TRIP_NOT_REACHED;
+    }
+    reached_trips.clear();
+    if (trip_reaches.size() < trips) {
+        trip_reaches.resize(trips, TRIP_NOT_REACHED);
+    }
+}
+
+edge leg_edge(const timetable &tt, const route_leg &leg) {
+    if (tt.is_walk(leg.edge)) {
+        const auto walk = tt.walk_time(tt.walk_index(leg.edge));
+        return tt.walk_leg(leg.from, leg.to, leg.arrival - walk, walk);
+    }
+    // Przyjazd odcinka jest w dniu kursowania – różnica względem rozkładu daje przesunięcie dnia
+    return tt.edge_at(leg.edge, leg.arrival - tt.arrival_of(leg.edge));
+}
+
+std::vector<edge> route_edges(const timetable &tt, const std::pmr::vector<route_leg> &legs) {
+    std::vector<edge> route;
+    route.reserve(legs.size());
+    for (const auto &leg : legs) {
+        route.push_back(leg_edge(tt, leg));
+    }
+    return route;
+}
+
+void query_workspace::append_legs(const timetable &tt, uint32_t i, std::pmr::vector<route_leg> &legs) const {
+    // Łańcuch poprzedników prowadzi od celu – odcinki wpisujemy od końca
+    size_t count = 0;
+    for (uint32_t j = i; j != timetable::NONE; j = labels[j].parent) {
+        count += labels[j].edge != timetable::NONE;
+    }
+    size_t pos = legs.size() + count;
+    legs.resize(pos);
+    for (; i != timetable::NONE; i = labels[i].parent) {
+        const uint32_t e = labels[i].edge;
+        if (e == timetable::NONE) continue;
+        const uint32_t line = tt.is_walk(e) ? timetable::WALK_LINE : tt.record(e).line;
+        legs[--pos] = {e, labels[labels[i].parent].stop, labels[i].stop, line, labels[i].time};
+    }
+}
+
+std::vector<edge> query_workspace::route_to(const timetable &tt, uint32_t i) {
+    std::pmr::vector<route_leg> legs(memory());
+    append_legs(tt, i, legs);
+    return route_edges(tt, legs);
+}
@@ -0,0 +1,184 @@
+#ifndef QUERY_WORKSPACE_H
+#define QUERY_WORKSPACE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include <chrono>
+#include "../graph/edge.h"
+#include "../graph/timetable.h"
+#include "query_arena.h"
+#include "search_stats.h"
+
+/**
+ * @struct search_label
+ * @brief Etykieta przeszukiwania – stan dojścia do przystanku wraz z wskaźnikiem na poprzednika.
+ *
+ * Trasa nie jest kopiowana do każdego stanu; odtwarza się ją z łańcucha poprzedników (route_to).
+ */
+struct search_label {
+    uint32_t stop;     ///< Przystanek
+    uint32_t edge;     ///< Krawędź, którą dojechano (timetable::NONE dla stanu początkowego i oczekiwania,
+                       ///< timetable::walk_id() dla przejścia pieszego)
+    uint32_t parent;   ///< Poprzednia etykieta (timetable::NONE dla stanu początkowego)
+    uint32_t line;     ///< Ostatnia użyta linia (timetable::NONE przed pierwszym przejazdem,
+                       ///< timetable::WALK_LINE po przejściu pieszym)
+    int32_t transfers; ///< Liczba przesiadek
+    std::chrono::system_clock::time_point time; ///< Czas obecności na przystanku
+};
+
+/**
+ * @struct heap_entry
+ * @brief Element kolejki priorytetowej – klucz, klucz rozstrzygający remisy i indeks etykiety.
+ */
+struct heap_entry {
+    int64_t key;
+    int64_t tie;
+    uint32_t label;
+};
+
+/**
+ * @struct route_leg
+ * @brief Odcinek trasy bez napisów – połączenie rozkładu albo przejście piesze.
+ *
+ * Fragmenty tras składane w trakcie zapytania (np. odcinki między przystankami pośrednimi w Tabu Search)
+ * przechowywane są w tej postaci; pełne krawędzie edge odtwarza leg_edge() tylko dla zwracanej trasy.
+ */
+struct route_leg {
+    uint32_t edge;  ///< Połączenie rozkładu albo timetable::walk_id() dla przejścia pieszego
+    uint32_t from;  ///< Przystanek początkowy
+    uint32_t to;    ///< Przystanek końcowy
+    uint32_t line;  ///< Linia (timetable::WALK_LINE dla przejścia pieszego)
+    std::chrono::system_clock::time_point arrival; ///< Przyjazd w dniu kursowania
+};
+
+/// Odtwarza krawędź edge odcinka trasy.
+edge leg_edge(const timetable &tt, const route_leg &leg);
+
+/// Odtwarza trasę (listę krawędzi edge) z odcinków.
+std::vector<edge> route_edges(const timetable &tt, const std::pmr::vector<route_leg> &legs);
+
+/**
+ * @class query_workspace
+ * @brief Stan pojedynczego zapytania, wielokrotnie używany przez jeden wątek.
+ *
+ * Tablice etykiet mają rozmiar rozkładu i nie są czyszczone między zapytaniami: wpis jest ważny tylko
+ * wtedy, gdy jego znacznik równa się numerowi bieżącego zapytania (generation), więc begin() kosztuje O(1).
+ * Pula etykiet i kopiec zachowują zaalokowaną pamięć, dlatego zapytania w stanie ustalonym nie alokują.
+ * Pozostałe kontenery zapytania korzystają z areny (memory()), którą wywołujący zeruje przed każdym
+ * zapytaniem (reset_memory() – robi to query_executor).
+ *
+ * Obiekt nie jest bezpieczny wielowątkowo – każdy wątek powinien mieć własny.
+ */
+class query_workspace {
+public:
+    typedef std::chrono::system_clock::time_point time_point;
+
+    /// Przygotowuje przestrzeń do nowego zapytania na rozkładzie `tt`.
+    void begin(const timetable &tt);
+
+    // --- etykiety przystanków lub par (przystanek, linia) ---
+    bool has(uint32_t i) const { return stamp[i] == generation; }
+    void mark(uint32_t i) { stamp[i] = generation; }
+    time_point &best_time(uint32_t i) { return times[i]; }
+    int32_t &best_transfers(uint32_t i) { return counts[i]; }
+    uint32_t &best_edge(uint32_t i) { return edges[i]; }
+
+    bool settled(uint32_t i) const { return settled_stamp[i] == generation; }
+    void settle(uint32_t i) { settled_stamp[i] = generation; }
+
+    // --- pamięć podręczna heurystyki A* ---
+    bool has_estimate(uint32_t stop) const { return estimate_stamp[stop] == generation; }
+    int64_t estimate(uint32_t stop) const { return estimates[stop]; }
+    void set_estimate(uint32_t stop, int64_t value) {
+        estimate_stamp[stop] = generation;
+        estimates[stop] = value;
+    }
+
+    bool line_marked(uint32_t line) const { return line_stamp[line] == generation; }
+    void mark_line(uint32_t line) { line_stamp[line] = generation; }
+
+    // --- kursy indeksu Trip-Based: pierwszy przystanek kursu, od którego kurs jest już przeglądany ---
+    static constexpr uint32_t TRIP_NOT_REACHED = UINT32_MAX;
+    /// Przygotowuje `trips` kursów do zapytania, przywracając tylko kursy osiągnięte w poprzednim.
+    void begin_trips(size_t trips);
+    /// Indeks przystanku albo TRIP_NOT_REACHED – odczyt bez znacznika, bo to najczęstsza operacja zapytania.
+    uint32_t trip_reach(uint32_t trip) const { return trip_reaches[trip]; }
+    void set_trip_reach(uint32_t trip, uint32_t index) {
+        if (trip_reaches[trip] == TRIP_NOT_REACHED) {
+            reached_trips.push_back(trip);
+        }
+        trip_reaches[trip] = index;
+    }
+
+    // --- pula etykiet ---
+    uint32_t add_label(const search_label &label) {
+        labels.push_back(label);
+        return static_cast<uint32_t>(labels.size() - 1);
+    }
+    const search_label &label(uint32_t i) const { return labels[i]; }
+
+    /// Odtwarza trasę prowadzącą do etykiety `i`.
+    std::vector<edge> route_to(const timetable &tt, uint32_t i);
+    /// Dopisuje na koniec `legs` odcinki trasy prowadzącej do etykiety `i`.
+    void append_legs(const timetable &tt, uint32_t i, std::pmr::vector<route_leg> &legs) const;
+
+    // --- arena pamięci zapytania ---
+    std::pmr::memory_resource *memory() { return arena.resource(); }
+    /// Zwalnia pamięć areny po poprzednim zapytaniu.
+    void reset_memory() { arena.reset(); }
+    /// Przydziały pamięci od ostatniego reset_memory().
+    arena_stats memory_stats() const { return arena.stats(); }
+
+    // --- liczniki przeszukiwania (tylko z LISTA1_SEARCH_STATS, patrz search_stats.h) ---
+    search_stats *stats() { return &counters; }
+    /// Zeruje liczniki przed nowym zapytaniem (robi to query_executor).
+    void reset_stats() { counters = search_stats(); }
+
+    // --- kopiec (porządek jak w std::priority_queue z tym samym komparatorem) ---
+    bool heap_empty() const { return heap.empty(); }
+
+    template<typename Compare>
+    void push(const heap_entry &entry, Compare compare) {
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), compare);
+        SEARCH_COUNT(&counters, labels_pushed, 1);
+        SEARCH_PEAK(&counters, peak_queue, heap.size());
+    }
+
+    template<typename Compare>
+    heap_entry pop(Compare compare) {
+        SEARCH_COUNT(&counters, labels_popped, 1);
+        std::pop_heap(heap.begin(), heap.end(), compare);
+        heap_entry top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+
+private:
+    uint32_t generation = 0;
+    std::vector<uint32_t> stamp;
+    std::vector<uint32_t> settled_stamp;
+    std::vector<uint32_t> estimate_stamp;
+    std::vector<uint32_t> line_stamp;
+    std::vector<uint32_t> trip_reaches;
+    std::vector<uint32_t> reached_trips;  ///< Kursy z trip_reaches różnym od TRIP_NOT_REACHED
+    std::vector<time_point> times;
+    std::vector<int32_t> counts;
+    std::vector<uint32_t> edges;
+    std::vector<int64_t> estimates;
+
+    std::vector<search_label> labels;
+    std::vector<heap_entry> heap;
+
+    query_arena arena;
+    search_stats counters;
+};
+
+/// Klucz kolejki odpowiadający punktowi w czasie.
+inline int64_t time_key(const std::chrono::system_clock::time_point &time) {
+    return time.time_since_epoch().count();
+}
+
+#endif // QUERY_WORKSPACE_H
@@ -0,0 +1,54 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @struct search_stats
+ * @brief Liczniki przeszukiwania jednego zapytania.
+ *
+ * Liczniki zbierane są tylko w kompilacji z LISTA1_SEARCH_STATS (opcja CMake o tej samej nazwie);
+ * bez niej makra SEARCH_COUNT i SEARCH_PEAK nie generują żadnego kodu, a liczniki pozostają zerowe
+ * (bytes_allocated pochodzi z areny zapytania i jest wypełniany zawsze).
+ */
+struct search_stats {
+    uint64_t labels_pushed = 0;         ///< Etykiety (stany) dodane do kolejki
+    uint64_t labels_popped = 0;         ///< Etykiety zdjęte z kolejki
+    uint64_t edges_scanned = 0;         ///< Przejrzane połączenia i przejścia piesze
+    uint64_t edges_relaxed = 0;         ///< Połączenia, które poprawiły etykietę
+    uint64_t heuristic_evaluations = 0; ///< Obliczenia heurystyki A* (bez trafień w pamięć podręczną)
+    uint64_t dominated_labels = 0;      ///< Etykiety odrzucone jako zdominowane (nieaktualne wpisy kolejki,
+                                        ///< fragmenty kursów Trip-Based, niekorzystne wzorce przesiadek)
+    uint64_t peak_queue = 0;            ///< Największy rozmiar kolejki
+    uint64_t bytes_allocated = 0;       ///< Bajty przydzielone przez zapytanie (arena i globalny alokator)
+
+    search_stats &operator+=(const search_stats &other) {
+        labels_pushed += other.labels_pushed;
+        labels_popped += other.labels_popped;
+        edges_scanned += other.edges_scanned;
+        edges_relaxed += other.edges_relaxed;
+        heuristic_evaluations += other.heuristic_evaluations;
+        dominated_labels += other.dominated_labels;
+        peak_queue = std::max(peak_queue, other.peak_queue);
+        bytes_allocated += other.bytes_allocated;
+        return *this;
+    }
+};
+
+#ifdef LISTA1_SEARCH_STATS
+constexpr bool search_stats_enabled = true;
+/// Zwiększa licznik `field` o `n` (`stats` – wskaźnik, może być nullptr).
+#define SEARCH_COUNT(stats, field, n) \
+    do { if (search_stats *search_stats_ = (stats)) search_stats_->field += (n); } while (0)
+/// Podnosi licznik `field` do `value`, jeśli jest mniejszy.
+#define SEARCH_PEAK(stats, field, value) \
+    do { if (search_stats *search_stats_ = (stats)) search_stats_->field = std::max<uint64_t>(search_stats_->field, (value)); } while (0)
+#else
+constexpr bool search_stats_enabled = false;
+// Wskaźnik jest "używany" także bez liczników – parametry search_stats * nie dają ostrzeżeń -Wunused-parameter
+#define SEARCH_COUNT(stats, field, n) do { (void)(stats); } while (0)
+#define SEARCH_PEAK(stats, field, value) do { (void)(stats); } while (0)
+#endif
+
+#endif // SEARCH_STATS_H
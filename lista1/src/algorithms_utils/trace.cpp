@@ -0,0 +1,118 @@
+#include "trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../io_handling/json_lite.h"
+
+namespace {
+
+// Zdarzenia jednego wątku; bufor żyje w rejestrze także po zakończeniu wątku
+struct thread_trace {
+    uint32_t tid;
+    std::string name;
+    std::vector<trace_event> events;
+};
+
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<thread_trace>> registry;
+std::chrono::steady_clock::time_point epoch;
+
+thread_trace &local_trace() {
+    thread_local std::shared_ptr<thread_trace> buffer = [] {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto created = std::make_shared<thread_trace>();
+        created->tid = static_cast<uint32_t>(registry.size() + 1);
+        created->events.reserve(1024);
+        registry.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+// Czas w mikrosekundach z dokładnością do nanosekund
+void write_us(std::ostream &out, int64_t ns) {
+    out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+}
+
+} // namespace
+
+void tracer::start() {
+    epoch = std::chrono::steady_clock::now();
+    active.store(true, std::memory_order_release);
+}
+
+void tracer::stop() {
+    active.store(false, std::memory_order_release);
+}
+
+void tracer::name_thread(std::string name) {
+    local_trace().name = std::move(name);
+}
+
+void tracer::record(const trace_event &event) {
+    local_trace().events.push_back(event);
+}
+
+int64_t tracer::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+size_t tracer::write_json(std::ostream &out) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    size_t written = 0;
+    bool first = true;
+    auto separator = [&]() {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (const auto &thread : registry) {
+        if (!thread->name.empty()) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->tid
+                << ",\"args\":{\"name\":" << json_quote(thread->name) << "}}";
+        }
+        for (const trace_event &event : thread->events) {
+            separator();
+            out << "{\"name\":" << json_quote(event.name) << ",\"cat\":\"lista1\",\"ph\":\"X\",\"ts\":";
+            write_us(out, event.start_ns);
+            out << ",\"dur\":";
+            write_us(out, event.duration_ns);
+            out << ",\"pid\":1,\"tid\":" << thread->tid;
+            if (event.arg_name) {
+                out << ",\"args\":{" << json_quote(event.arg_name) << ":" << event.arg << "}";
+            }
+            out << "}";
+            ++written;
+        }
+    }
+    out << "\n]}\n";
+    return written;
+}
+
+trace_session::trace_session(std::string path) : path(std::move(path)) {
+    if (!this->path.empty()) {
+        tracer::name_thread("main");
+        tracer::start();
+    }
+}
+
+trace_session::~trace_session() {
+    if (path.empty()) {
+        return;
+    }
+    tracer::stop();
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Nie można zapisać śladu: " << path << std::endl;
+        return;
+    }
+    const size_t events = tracer::write_json(out);
+    std::cerr << "Ślad wykonania: " << events << " zdarzeń w " << path << std::endl;
+}
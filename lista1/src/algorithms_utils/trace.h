@@ -0,0 +1,125 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @file trace.h
+ * @brief Śledzenie faz wykonania (wczytywanie, budowa rozkładu, zapytania, iteracje tabu) zapisywane
+ *        w formacie Chrome trace event – do obejrzenia w chrome://tracing albo ui.perfetto.dev.
+ *
+ * Fazę opisuje obiekt trace_span (makro TRACE_SCOPE): mierzy czas od konstrukcji do destrukcji,
+ * więc zagnieżdżone zakresy tworzą zagnieżdżone fazy. Gdy śledzenie jest wyłączone, zakres kosztuje
+ * jedno odczytanie flagi. Zdarzenia trafiają do bufora bieżącego wątku bez blokad – muteks chroni
+ * wyłącznie rejestrację bufora przy pierwszym zdarzeniu wątku.
+ */
+
+/**
+ * @struct trace_event
+ * @brief Zakończona faza jednego wątku.
+ */
+struct trace_event {
+    const char *name;      ///< Nazwa fazy (literał – musi istnieć do zapisu śladu)
+    const char *arg_name;  ///< Nazwa argumentu liczbowego albo nullptr
+    int64_t arg;
+    int64_t start_ns;      ///< Początek od włączenia śledzenia
+    int64_t duration_ns;
+};
+
+/**
+ * @class tracer
+ * @brief Globalny stan śledzenia: flaga włączenia, bufory wątków i zapis śladu.
+ */
+class tracer {
+public:
+    /// Czy zakresy są rejestrowane.
+    static bool enabled() { return active.load(std::memory_order_acquire); }
+
+    /// Włącza śledzenie; czasy zdarzeń liczone są od tej chwili.
+    static void start();
+
+    /// Wyłącza śledzenie (zebrane zdarzenia pozostają do zapisu).
+    static void stop();
+
+    /// Nazwa bieżącego wątku w śladzie (np. "main", "worker 2").
+    static void name_thread(std::string name);
+
+    /// Dopisuje zdarzenie do bufora bieżącego wątku.
+    static void record(const trace_event &event);
+
+    /// Nanosekundy od włączenia śledzenia.
+    static int64_t now_ns();
+
+    /**
+     * @brief Zapisuje wszystkie zebrane zdarzenia jako JSON {"traceEvents": [...]} (zdarzenia "X" z czasem
+     *        w mikrosekundach oraz nazwy wątków jako metadane "M").
+     *
+     * Wątki nie mogą w tym czasie rejestrować zdarzeń – ślad zapisuje się po zakończeniu pracy
+     * (np. po zatrzymaniu puli serwera).
+     *
+     * @return size_t Liczba zapisanych zdarzeń faz.
+     */
+    static size_t write_json(std::ostream &out);
+
+private:
+    static inline std::atomic<bool> active{false};
+};
+
+/**
+ * @class trace_span
+ * @brief Zakres czasu fazy – zdarzenie zapisywane jest w destruktorze.
+ */
+class trace_span {
+public:
+    /**
+     * @param name Nazwa fazy (literał).
+     * @param arg_name Opcjonalna nazwa argumentu (np. "iteration").
+     * @param arg Wartość argumentu.
+     */
+    explicit trace_span(const char *name, const char *arg_name = nullptr, int64_t arg = 0)
+        : name(tracer::enabled() ? name : nullptr), arg_name(arg_name), arg(arg),
+          start(this->name ? tracer::now_ns() : 0) {}
+
+    ~trace_span() {
+        if (name) {
+            tracer::record({name, arg_name, arg, start, tracer::now_ns() - start});
+        }
+    }
+
+    trace_span(const trace_span &) = delete;
+    trace_span &operator=(const trace_span &) = delete;
+
+private:
+    const char *name;
+    const char *arg_name;
+    int64_t arg;
+    int64_t start;
+};
+
+/**
+ * @class trace_session
+ * @brief Włącza śledzenie na czas życia obiektu i zapisuje ślad do pliku w destruktorze.
+ *
+ * Pusta ścieżka pozostawia śledzenie wyłączone.
+ */
+class trace_session {
+public:
+    explicit trace_session(std::string path);
+    ~trace_session();
+
+    trace_session(const trace_session &) = delete;
+    trace_session &operator=(const trace_session &) = delete;
+
+private:
+    std::string path;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+/// Zakres fazy do końca bieżącego bloku: TRACE_SCOPE("nazwa") albo TRACE_SCOPE("nazwa", "argument", wartość).
+#define TRACE_SCOPE(...) trace_span TRACE_CONCAT(trace_span_, __LINE__)(__VA_ARGS__)
+
+#endif // TRACE_H
@@ -0,0 +1,29 @@
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @struct connection
+ * @brief Zwarty zapis połączenia przechowywany przez rozkład (timetable).
+ *
+ * W odróżnieniu od edge nie zawiera napisów ani współrzędnych: przystanki, linia i przewoźnik to
+ * identyfikatory z tablic rozkładu, współrzędne zapisane są raz na przystanek, a czasy to sekundy
+ * od północy dnia odniesienia rozkładu. Rekord jest typem POD o stałym rozmiarze 24 bajtów.
+ */
+struct connection {
+    int32_t departure; ///< Odjazd (sekundy od północy dnia odniesienia)
+    int32_t arrival;   ///< Przyjazd (sekundy od północy dnia odniesienia)
+    uint32_t from;     ///< Przystanek początkowy
+    uint32_t to;       ///< Przystanek końcowy
+    uint32_t line;     ///< Linia
+    uint16_t company;  ///< Przewoźnik
+    uint16_t service;  ///< Wzorzec kursowania (service_calendar)
+};
+
+static_assert(sizeof(connection) == 24, "connection powinien zajmować 24 bajty");
+static_assert(std::is_trivially_copyable_v<connection> && std::is_standard_layout_v<connection>,
+              "connection musi być typem POD");
+
+#endif // CONNECTION_H
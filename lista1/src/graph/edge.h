@@ -15,13 +15,14 @@
 class edge {
     typedef std::chrono::system_clock::time_point time_point;
 public:
+    // Napisy przyjmowane przez wartość – wywołujący może je przenieść zamiast kopiować
     edge(uint32_t id,
-        const std::string &company,
-        const std::string &line,
+        std::string company,
+        std::string line,
         const time_point &departure_time,
         const time_point &arrival_time,
-        const std::string &start_stop,
-        const std::string &end_stop,
+        std::string start_stop,
+        std::string end_stop,
         double start_stop_lat,
         double start_stop_lon,
         double end_stop_lat,
@@ -41,6 +42,8 @@ public:
     double getStartStopLon() const { return start_stop_lon; }
     double getEndStopLat() const { return end_stop_lat; }
     double getEndStopLon() const { return end_stop_lon; }
+    /// Numer wzorca kursowania w kalendarzu (service_calendar), domyślnie 0 – codziennie.
+    uint16_t getService() const { return service; }
 
     // Settery
     void setId(uint32_t newId) { id = newId; }
@@ -54,10 +57,12 @@ public:
     void setStartStopLon(double newLon) { start_stop_lon = newLon; }
     void setEndStopLat(double newLat) { end_stop_lat = newLat; }
     void setEndStopLon(double newLon) { end_stop_lon = newLon; }
+    void setService(uint16_t newService) { service = newService; }
 
 private:
 
     std::uint32_t id;
+    std::uint16_t service = 0;
     std::string company;
     std::string line;
     time_point departure_time;
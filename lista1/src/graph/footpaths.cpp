@@ -0,0 +1,79 @@
+#include "footpaths.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "../algorithms/astar.h"
+#include "../algorithms_utils/trace.h"
+
+namespace {
+
+constexpr double EARTH_RADIUS_M = 6371000.0;
+
+} // namespace
+
+stop_grid::stop_grid(const std::vector<std::pair<double, double>> &coords, double cell_m) {
+    const size_t n = coords.size();
+    double mean_lat = 0.0;
+    for (const auto &c : coords) {
+        mean_lat += c.first;
+    }
+    mean_lat = n == 0 ? 0.0 : mean_lat / static_cast<double>(n);
+    const double x_scale = EARTH_RADIUS_M * std::cos(mean_lat * PI / 180.0) * PI / 180.0;
+    const double y_scale = EARTH_RADIUS_M * PI / 180.0;
+
+    cells.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        cells[i] = {static_cast<int32_t>(std::floor(coords[i].second * x_scale / cell_m)),
+                    static_cast<int32_t>(std::floor(coords[i].first * y_scale / cell_m))};
+    }
+
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return cells[a] < cells[b];
+    });
+    for (uint32_t i = 0; i < n;) {
+        uint32_t j = i;
+        while (j < n && cells[order[j]] == cells[order[i]]) ++j;
+        ranges.emplace(cell_key(cells[order[i]].first, cells[order[i]].second), std::make_pair(i, j));
+        i = j;
+    }
+}
+
+footpath_set build_footpaths(const std::vector<std::pair<double, double>> &coords, const footpath_options &options) {
+    footpath_set result;
+    result.offsets.assign(coords.size() + 1, 0);
+    if (options.radius_m <= 0.0 || coords.empty()) {
+        return result;
+    }
+    TRACE_SCOPE("footpaths", "stops", static_cast<int64_t>(coords.size()));
+
+    // Rzut równoodległościowy jest na skalę miasta dokładny do ułamka procenta – margines komórki to pokrywa
+    const stop_grid grid(coords, options.radius_m * 1.01);
+    std::vector<std::pair<uint32_t, int32_t>> paths;
+    for (uint32_t s = 0; s < coords.size(); ++s) {
+        const size_t first = result.targets.size();
+        grid.for_each_candidate(s, [&](uint32_t t) {
+            if (t == s) return;
+            const double meters = haversine(coords[s].first, coords[s].second, coords[t].first, coords[t].second) * 1000.0;
+            if (meters > options.radius_m) return;
+            const auto walking = static_cast<int32_t>(std::ceil(meters / options.walking_speed));
+            result.targets.push_back(t);
+            result.seconds.push_back(std::max(walking, static_cast<int32_t>(options.min_change.count())));
+        });
+        // Stała kolejność przejść niezależnie od układu komórek
+        paths.clear();
+        for (size_t i = first; i < result.targets.size(); ++i) {
+            paths.emplace_back(result.targets[i], result.seconds[i]);
+        }
+        std::sort(paths.begin(), paths.end());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            result.targets[first + i] = paths[i].first;
+            result.seconds[first + i] = paths[i].second;
+        }
+        result.offsets[s + 1] = static_cast<uint32_t>(result.targets.size());
+    }
+    return result;
+}
@@ -0,0 +1,81 @@
+#ifndef FOOTPATHS_H
+#define FOOTPATHS_H
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct footpath_options
+ * @brief Parametry przejść pieszych między pobliskimi przystankami.
+ */
+struct footpath_options {
+    double radius_m = 0.0;                  ///< Maksymalna odległość przejścia w metrach (0 – bez przejść)
+    double walking_speed = 1.4;             ///< Prędkość marszu w m/s
+    std::chrono::seconds min_change{60};    ///< Minimalny czas przesiadki z przejściem pieszym
+};
+
+/**
+ * @struct footpath_set
+ * @brief Przejścia piesze w układzie CSR – przejścia z przystanku s zajmują zakres [offsets[s], offsets[s + 1]).
+ *
+ * Przejścia są symetryczne: jeśli istnieje przejście s -> t, istnieje też t -> s o tym samym czasie.
+ */
+struct footpath_set {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<int32_t> seconds;
+};
+
+/**
+ * @class stop_grid
+ * @brief Siatka przestrzenna nad współrzędnymi przystanków.
+ *
+ * Współrzędne rzutowane są na płaszczyznę (rzut równoodległościowy wokół średniej szerokości),
+ * a przystanki grupowane w kwadratowe komórki o boku `cell_m` metrów. Sąsiadów w promieniu
+ * nie większym niż bok komórki wystarczy szukać w 3 x 3 komórkach wokół punktu.
+ */
+class stop_grid {
+public:
+    stop_grid(const std::vector<std::pair<double, double>> &coords, double cell_m);
+
+    /// Wywołuje `visit(stop)` dla przystanków z komórek sąsiadujących z przystankiem `stop` (łącznie z nim samym).
+    template<typename Visit>
+    void for_each_candidate(uint32_t stop, Visit &&visit) const {
+        const auto [cx, cy] = cells[stop];
+        for (int32_t dy = -1; dy <= 1; ++dy) {
+            for (int32_t dx = -1; dx <= 1; ++dx) {
+                auto it = ranges.find(cell_key(cx + dx, cy + dy));
+                if (it == ranges.end()) continue;
+                for (uint32_t i = it->second.first; i < it->second.second; ++i) {
+                    visit(order[i]);
+                }
+            }
+        }
+    }
+
+private:
+    static uint64_t cell_key(int32_t x, int32_t y) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(y);
+    }
+
+    std::vector<std::pair<int32_t, int32_t>> cells;   ///< Komórka każdego przystanku
+    std::vector<uint32_t> order;                      ///< Przystanki posortowane po komórce
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> ranges; ///< Komórka -> zakres w `order`
+};
+
+/**
+ * @brief Wyznacza przejścia piesze między przystankami odległymi o co najwyżej `options.radius_m`.
+ *
+ * Czas przejścia to odległość (haversine) podzielona przez prędkość marszu, nie mniej jednak niż
+ * minimalny czas przesiadki. Koszt budowy jest liniowy względem liczby przystanków i par w promieniu.
+ *
+ * @param coords Współrzędne (szerokość, długość) przystanków indeksowanych identyfikatorem.
+ * @param options Parametry przejść.
+ * @return footpath_set Przejścia w układzie CSR (puste zakresy, jeśli promień wynosi 0).
+ */
+footpath_set build_footpaths(const std::vector<std::pair<double, double>> &coords, const footpath_options &options);
+
+#endif // FOOTPATHS_H
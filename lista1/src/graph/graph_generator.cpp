@@ -7,15 +7,30 @@
 #include "edge.h"
 
 
+#include <cstdint>
+#include <cstdio>
 #include <ctime>
 #include <iomanip>
+#include <stdexcept>
 
 std::chrono::system_clock::time_point parse_time(const std::string &time_str) {
     std::tm tm = {};
     std::istringstream ss(time_str);
 
     const auto now = std::chrono::system_clock::now();
-    const std::chrono::year_month_day ymd{std::chrono::floor<std::chrono::days>(now)};
+    std::chrono::year_month_day ymd{std::chrono::floor<std::chrono::days>(now)};
+
+    // Opcjonalna data przed godziną: "RRRR-MM-DD HH:MM:SS"
+    int year;
+    unsigned month, day;
+    char sep;
+    if (std::sscanf(time_str.c_str(), "%d-%u-%u%c", &year, &month, &day, &sep) == 4 && sep == ' ') {
+        ymd = std::chrono::year_month_day{std::chrono::year(year), std::chrono::month(month), std::chrono::day(day)};
+        if (!ymd.ok()) {
+            throw std::runtime_error("Niepoprawna data");
+        }
+        ss.str(time_str.substr(time_str.find(' ') + 1));
+    }
     tm.tm_year = static_cast<int>(ymd.year()) - 1900;  // rok od 1900
     tm.tm_mon  = static_cast<unsigned>(ymd.month()) - 1; // miesiące 0-11
     tm.tm_mday = static_cast<unsigned>(ymd.day());       // dzień miesiąca
@@ -29,9 +44,10 @@ std::chrono::system_clock::time_point parse_time(const std::string &time_str) {
         throw std::runtime_error("Niepoprawny format czasu");
     }
 
-    if (hours == 24) {
-        hours = 0;
-        tm.tm_mday += 1;
+    // Godziny od 24 wzwyż oznaczają kolejne dni (kurs kończący się po północy) – normalizuje je mktime
+    if (hours >= 24) {
+        tm.tm_mday += hours / 24;
+        hours %= 24;
     }
 
     tm.tm_hour = hours;
@@ -43,7 +59,7 @@ std::chrono::system_clock::time_point parse_time(const std::string &time_str) {
 }
 
 
-edge graph_generator::generate_graph(std::string row) {
+edge graph_generator::generate_graph(const std::string &row) {
     std::stringstream ss(row);
     char delimiter = ',';
 
@@ -54,25 +70,38 @@ edge graph_generator::generate_graph(std::string row) {
     }
 
     uint32_t id = static_cast<uint32_t>(std::stoul(splitted[0]));
-    std::string company = splitted[1];
-    std::string line = splitted[2];
+    std::string &company = splitted[1];
+    std::string &line = splitted[2];
     auto departure_time = parse_time(splitted[3]);
     auto arrival_time = parse_time(splitted[4]);
-    std::string start_stop = splitted[5];
-    std::string end_stop = splitted[6];
+    std::string &start_stop = splitted[5];
+    std::string &end_stop = splitted[6];
     double start_stop_lat = std::stod(splitted[7]);
     double start_stop_lon = std::stod(splitted[8]);
     double end_stop_lat = std::stod(splitted[9]);
     double end_stop_lon = std::stod(splitted[10]);
 
-    return edge(id, company, line, departure_time, arrival_time,
-                 start_stop, end_stop, start_stop_lat, start_stop_lon,
-                 end_stop_lat, end_stop_lon);
+    edge result(id, std::move(company), std::move(line), departure_time, arrival_time,
+                std::move(start_stop), std::move(end_stop), start_stop_lat, start_stop_lon,
+                end_stop_lat, end_stop_lon);
+    // Opcjonalna kolumna z numerem wzorca kursowania (kalendarz)
+    if (splitted.size() > 11 && splitted[11].find_first_of("0123456789") != std::string::npos) {
+        const unsigned long service = std::stoul(splitted[11]);
+        if (service > UINT16_MAX) {
+            // Pole edge::service ma 16 bitów – obcięty numer wskazywałby inny wzorzec (65536 -> 0, czyli codziennie)
+            throw std::runtime_error("Numer wzorca kursowania poza zakresem (0-" + std::to_string(UINT16_MAX) +
+                                     "): " + splitted[11]);
+        }
+        result.setService(static_cast<uint16_t>(service));
+    }
+    return result;
 }
 
-graph_generator::graph_generator(const std::vector<std::string> &data_rows) {
-    for (auto row : data_rows) {
+graph_generator::graph_generator(std::vector<std::string> data_rows) {
+    graphs.reserve(data_rows.size());
+    for (auto &row : data_rows) {
         graphs.push_back(generate_graph(row));
+        std::string().swap(row);
     }
 }
 
@@ -8,20 +8,36 @@
 
 #include "edge.h"
 
+/**
+ * @brief Zamienia czas w formacie HH:MM:SS na punkt w czasie dzisiejszego dnia.
+ *
+ * Godziny od 24 wzwyż oznaczają dzień następny (25:10:00 to 01:10 jutro). Czas można poprzedzić
+ * datą: "RRRR-MM-DD HH:MM:SS".
+ * @throws std::runtime_error przy niepoprawnym formacie.
+ */
+std::chrono::system_clock::time_point parse_time(const std::string &time_str);
 
 class graph_generator {
 private:
     std::vector<edge> graphs;
 
-    static edge generate_graph(std::string row);
+    static edge generate_graph(const std::string &row);
     public:
-    graph_generator(const std::vector<std::string> &data_rows);
-    std::vector<edge>get_graphs();
+    // Wiersze przejmowane są na własność i zwalniane zaraz po przetworzeniu.
+    // Rzuca std::runtime_error przy niepoprawnym czasie albo numerze wzorca kursowania spoza 0-65535.
+    explicit graph_generator(std::vector<std::string> data_rows);
+    const std::vector<edge> &get_graphs() const;
+    // Przekazuje krawędzie wywołującemu bez kopiowania (generator zostaje pusty)
+    std::vector<edge> release_graphs();
 };
 
-inline std::vector<edge> graph_generator::get_graphs() {
+inline const std::vector<edge> &graph_generator::get_graphs() const {
     return graphs;
 }
 
+inline std::vector<edge> graph_generator::release_graphs() {
+    return std::move(graphs);
+}
+
 
 #endif //GRAPH_GENERATOR_H
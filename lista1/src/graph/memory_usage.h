@@ -0,0 +1,61 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "edge.h"
+
+/**
+ * @struct memory_entry
+ * @brief Pozycja raportu pamięci – nazwa struktury i zajmowane przez nią bajty.
+ */
+struct memory_entry {
+    std::string name;
+    size_t bytes;
+};
+
+/// Bajty zaalokowane przez wektor (pojemność, nie rozmiar).
+template<typename T>
+size_t vector_bytes(const std::vector<T> &v) {
+    return v.capacity() * sizeof(T);
+}
+
+/// Bajty napisu poza obiektem std::string (0, jeśli mieści się w buforze krótkich napisów).
+inline size_t string_heap_bytes(const std::string &s) {
+    static const size_t inline_capacity = std::string().capacity();
+    return s.capacity() > inline_capacity ? s.capacity() + 1 : 0;
+}
+
+/// Bajty wektora napisów łącznie z ich zawartością.
+inline size_t strings_bytes(const std::vector<std::string> &v) {
+    size_t bytes = vector_bytes(v);
+    for (const auto &s : v) {
+        bytes += string_heap_bytes(s);
+    }
+    return bytes;
+}
+
+/// Przybliżony rozmiar mapy z kluczami napisowymi: kubełki, węzły (z zapamiętanym skrótem) i treść kluczy.
+template<typename V>
+size_t string_map_bytes(const std::unordered_map<std::string, V> &m) {
+    size_t bytes = m.bucket_count() * sizeof(void *) +
+                   m.size() * (sizeof(void *) + sizeof(std::pair<const std::string, V>) + sizeof(size_t));
+    for (const auto &[key, value] : m) {
+        bytes += string_heap_bytes(key);
+    }
+    return bytes;
+}
+
+/// Bajty listy krawędzi edge łącznie z napisami.
+inline size_t edges_bytes(const std::vector<edge> &edges) {
+    size_t bytes = vector_bytes(edges);
+    for (const auto &e : edges) {
+        bytes += string_heap_bytes(e.getCompany()) + string_heap_bytes(e.getLine()) +
+                 string_heap_bytes(e.getStartStop()) + string_heap_bytes(e.getEndStop());
+    }
+    return bytes;
+}
+
+#endif // MEMORY_USAGE_H
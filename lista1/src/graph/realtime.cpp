@@ -0,0 +1,107 @@
+#include "realtime.h"
+
+#include <sstream>
+
+#include "graph_generator.h"
+#include "trips.h"
+
+namespace {
+
+std::string trim(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+std::string trip_key(const std::string &line, const std::string &first_stop,
+                     const std::chrono::system_clock::time_point &departure) {
+    return line + '\x1f' + first_stop + '\x1f' + std::to_string(departure.time_since_epoch().count());
+}
+
+} // namespace
+
+bool parse_trip_updates(std::istream &in, std::vector<trip_update> &updates, std::string &error) {
+    std::string line;
+    size_t number = 0;
+    while (std::getline(in, line)) {
+        ++number;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string token;
+        while (std::getline(ss, token, ',')) {
+            fields.push_back(trim(token));
+        }
+        if (fields.size() < 4) {
+            error = "linia " + std::to_string(number) + ": wymagane pola linia,przystanek,HH:MM:SS,opóźnienie";
+            return false;
+        }
+
+        trip_update update;
+        update.line = fields[0];
+        update.first_stop = fields[1];
+        try {
+            update.first_departure = parse_time(fields[2]);
+            if (fields[3] == "X" || fields[3] == "x") {
+                update.cancelled = true;
+            } else {
+                update.delay_seconds = std::stoll(fields[3]);
+            }
+        } catch (const std::exception &) {
+            error = "linia " + std::to_string(number) + ": niepoprawny czas lub opóźnienie";
+            return false;
+        }
+        if (fields.size() > 4) {
+            update.from_stop = fields[4];
+        }
+        updates.push_back(std::move(update));
+    }
+    return true;
+}
+
+realtime_updater::realtime_updater(std::shared_ptr<const timetable> base) : base(std::move(base)) {
+    // Pełne krawędzie potrzebne są tylko do podziału na kursy
+    const std::vector<edge> edges = this->base->materialize();
+    for (auto &t : group_into_trips(edges)) {
+        const edge &first = edges[t.edges.front()];
+        trips_by_key[trip_key(t.line, first.getStartStop(), first.getDepartureTime())]
+            .push_back(static_cast<uint32_t>(trips.size()));
+        trips.push_back(std::move(t.edges));
+    }
+}
+
+std::shared_ptr<const timetable> realtime_updater::apply(const std::vector<trip_update> &updates,
+                                                         uint64_t version,
+                                                         update_stats &stats) const {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<edge_change> changes;
+
+    for (const auto &update : updates) {
+        auto it = trips_by_key.find(trip_key(update.line, update.first_stop, update.first_departure));
+        if (it == trips_by_key.end()) {
+            ++stats.unmatched;
+            continue;
+        }
+        for (uint32_t t : it->second) {
+            ++stats.trips;
+            bool delayed = update.from_stop.empty();
+            const uint32_t from = delayed ? timetable::NONE : base->stop_id(update.from_stop);
+            for (uint32_t e : trips[t]) {
+                if (!delayed && base->edge_from(e) == from) {
+                    delayed = true;
+                }
+                if (!delayed && !update.cancelled) continue;
+                const auto shift = std::chrono::seconds(update.delay_seconds);
+                changes.push_back({e, base->departure_of(e) + shift, base->arrival_of(e) + shift, update.cancelled});
+            }
+        }
+    }
+    stats.edges = changes.size();
+
+    auto next = base->patched(changes, version);
+    stats.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return next;
+}
@@ -0,0 +1,84 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <unordered_map>
+#include "timetable.h"
+
+/**
+ * @struct trip_update
+ * @brief Opóźnienie lub odwołanie jednego kursu.
+ *
+ * Plik CSV nie zawiera identyfikatorów kursów, dlatego kurs wskazuje się linią, pierwszym
+ * przystankiem i rozkładowym odjazdem z tego przystanku.
+ */
+struct trip_update {
+    std::string line;
+    std::string first_stop;
+    std::chrono::system_clock::time_point first_departure; ///< Rozkładowy odjazd z pierwszego przystanku
+    int64_t delay_seconds = 0;  ///< Opóźnienie (ujemne – przyspieszenie)
+    bool cancelled = false;     ///< Kurs odwołany
+    std::string from_stop;      ///< Opóźnienie obowiązuje od odjazdu z tego przystanku (pusty – cały kurs)
+};
+
+/**
+ * @brief Wczytuje aktualizacje z pliku w formacie CSV.
+ *
+ * Każda linia: `linia,pierwszy_przystanek,HH:MM:SS,opóźnienie_s[,od_przystanku]`, gdzie zamiast
+ * opóźnienia można podać `X`, aby odwołać kurs. Linie puste i zaczynające się od '#' są pomijane.
+ * Plik opisuje pełny bieżący stan – aktualizacje nie kumulują się między kolejnymi odczytami.
+ *
+ * @param in Strumień wejściowy.
+ * @param updates Wypełniana lista aktualizacji.
+ * @param error Opis pierwszego błędu.
+ * @return true, jeśli wszystkie linie są poprawne.
+ */
+bool parse_trip_updates(std::istream &in, std::vector<trip_update> &updates, std::string &error);
+
+/**
+ * @struct update_stats
+ * @brief Podsumowanie zastosowania aktualizacji.
+ */
+struct update_stats {
+    size_t trips = 0;     ///< Dopasowane kursy
+    size_t unmatched = 0; ///< Aktualizacje, dla których nie znaleziono kursu
+    size_t edges = 0;     ///< Zmienione połączenia
+    double elapsed_ms = 0.0;
+};
+
+/**
+ * @class realtime_updater
+ * @brief Nakłada opóźnienia i odwołania kursów na rozkład statyczny.
+ *
+ * Kursy odtwarzane są raz (group_into_trips) z rozkładu statycznego. Każde wywołanie apply()
+ * tworzy nową wersję rozkładu na podstawie rozkładu statycznego, więc kolejne odczyty pliku
+ * z opóźnieniami zastępują się, a nie sumują.
+ */
+class realtime_updater {
+public:
+    explicit realtime_updater(std::shared_ptr<const timetable> base);
+
+    /**
+     * @brief Tworzy wersję rozkładu z nałożonymi aktualizacjami.
+     *
+     * @param updates Aktualizacje kursów.
+     * @param version Numer nowej wersji.
+     * @param stats Wypełniane podsumowanie.
+     * @return std::shared_ptr<const timetable> Nowa wersja rozkładu.
+     */
+    std::shared_ptr<const timetable> apply(const std::vector<trip_update> &updates,
+                                           uint64_t version,
+                                           update_stats &stats) const;
+
+private:
+    std::shared_ptr<const timetable> base;
+    std::vector<std::vector<uint32_t>> trips; ///< Krawędzie kursów w kolejności przejazdu
+    std::unordered_map<std::string, std::vector<uint32_t>> trips_by_key;
+};
+
+#endif // REALTIME_H
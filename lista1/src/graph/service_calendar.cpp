@@ -0,0 +1,88 @@
+#include "service_calendar.h"
+
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+bool every_day(const service_calendar::service &s) {
+    return s.weekdays == service_calendar::ALL_DAYS && s.first == std::chrono::sys_days::min() &&
+           s.last == std::chrono::sys_days::max();
+}
+
+bool parse_date(const std::string &text, std::chrono::sys_days &day) {
+    int y;
+    unsigned m, d;
+    char tail;
+    if (std::sscanf(text.c_str(), "%d-%u-%u%c", &y, &m, &d, &tail) != 3) return false;
+    const std::chrono::year_month_day ymd{std::chrono::year(y), std::chrono::month(m), std::chrono::day(d)};
+    if (!ymd.ok()) return false;
+    day = ymd;
+    return true;
+}
+
+std::string trim(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+} // namespace
+
+void service_calendar::define(uint16_t id, const service &s) {
+    if (id >= services.size()) {
+        services.resize(id + 1);
+    }
+    restricted -= !every_day(services[id]);
+    services[id] = s;
+    restricted += !every_day(s);
+}
+
+bool service_calendar::parse(std::istream &in, service_calendar &calendar, std::string &error) {
+    std::string line;
+    size_t number = 0;
+    while (std::getline(in, line)) {
+        ++number;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string token;
+        while (std::getline(ss, token, ',')) {
+            fields.push_back(trim(token));
+        }
+        fields.resize(4);
+        const std::string where = "linia " + std::to_string(number) + ": ";
+
+        unsigned long id;
+        try {
+            id = std::stoul(fields[0]);
+        } catch (const std::exception &) {
+            error = where + "niepoprawny numer wzorca";
+            return false;
+        }
+        if (id > UINT16_MAX) {
+            error = where + "numer wzorca poza zakresem";
+            return false;
+        }
+
+        service s;
+        if (fields[1].size() != 7 || fields[1].find_first_not_of("01") != std::string::npos) {
+            error = where + "maska dni musi mieć 7 znaków 0/1";
+            return false;
+        }
+        s.weekdays = 0;
+        for (size_t i = 0; i < 7; ++i) {
+            s.weekdays |= static_cast<uint8_t>((fields[1][i] == '1') << i);
+        }
+        if ((!fields[2].empty() && !parse_date(fields[2], s.first)) ||
+            (!fields[3].empty() && !parse_date(fields[3], s.last))) {
+            error = where + "niepoprawna data (RRRR-MM-DD)";
+            return false;
+        }
+        calendar.define(static_cast<uint16_t>(id), s);
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef SERVICE_CALENDAR_H
+#define SERVICE_CALENDAR_H
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @class service_calendar
+ * @brief Kalendarz kursowania – dla każdego wzorca (service) maska dni tygodnia i okres obowiązywania.
+ *
+ * Połączenie wskazuje wzorzec numerem (edge::getService()), a godziny w rozkładzie opisują jeden
+ * dzień kursowania – mogą przekraczać 24:00, jeśli kurs kończy się po północy. Rozkład nie jest więc
+ * powielany dla kolejnych dni: to, czy połączenie kursuje danego dnia, sprawdza runs().
+ *
+ * Wzorzec, którego nie zdefiniowano w kalendarzu (w szczególności domyślny wzorzec 0), kursuje codziennie.
+ */
+class service_calendar {
+public:
+    /// Dni tygodnia w masce: bit 0 – poniedziałek, ..., bit 6 – niedziela.
+    static constexpr uint8_t ALL_DAYS = 0x7f;
+
+    struct service {
+        uint8_t weekdays = ALL_DAYS;
+        std::chrono::sys_days first = std::chrono::sys_days::min(); ///< Pierwszy dzień obowiązywania
+        std::chrono::sys_days last = std::chrono::sys_days::max();  ///< Ostatni dzień obowiązywania
+    };
+
+    /// Definiuje (lub zastępuje) wzorzec o numerze `id`.
+    void define(uint16_t id, const service &s);
+
+    /// Czy wzorzec kursuje w dniu `day` (data lokalna dnia kursowania).
+    bool runs(uint16_t id, std::chrono::sys_days day) const {
+        if (id >= services.size()) return true;
+        const service &s = services[id];
+        const unsigned weekday = std::chrono::weekday(day).iso_encoding() - 1;
+        return (s.weekdays >> weekday & 1) && s.first <= day && day <= s.last;
+    }
+
+    /// Czy wszystkie wzorce kursują codziennie (wtedy sprawdzanie kalendarza można pominąć).
+    bool daily() const { return restricted == 0; }
+
+    /**
+     * @brief Wczytuje kalendarz z pliku CSV.
+     *
+     * Każda linia: `numer,maska,od,do`, gdzie maska to siedem znaków 0/1 (od poniedziałku do niedzieli),
+     * a daty mają postać RRRR-MM-DD (puste pole – bez ograniczenia). Linie puste i zaczynające się
+     * od '#' są pomijane.
+     *
+     * @param in Strumień wejściowy.
+     * @param calendar Wypełniany kalendarz.
+     * @param error Opis pierwszego błędu.
+     * @return true, jeśli wszystkie linie są poprawne.
+     */
+    static bool parse(std::istream &in, service_calendar &calendar, std::string &error);
+
+private:
+    std::vector<service> services;
+    size_t restricted = 0; ///< Liczba wzorców, które nie kursują codziennie
+};
+
+#endif // SERVICE_CALENDAR_H
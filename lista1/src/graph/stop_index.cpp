@@ -0,0 +1,200 @@
+#include "stop_index.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+// Litery bez znaków diakrytycznych dla U+00C0-U+00FF i U+0100-U+017F (w UTF-8 – dwa bajty)
+constexpr char LATIN1[] = "AAAAAAACEEEEIIIIDNOOOOO OUUUUYTsaaaaaaaceeeeiiiidnooooo ouuuuyty";
+constexpr char LATIN_EXTENDED_A[] = "AaAaAaCcCcCcCcDdDdEeEeEeEeEeGgGgGgGgHhHhIiIiIiIiIiJjJjKkkLlLlLlLlLl"
+                                    "NnNnNnnNnOoOoOoOoRrRrRrSsSsSsSsTtTtTtUuUuUuUuUuUuWwYyYZzZzZzs";
+static_assert(sizeof(LATIN1) == 64 + 1 && sizeof(LATIN_EXTENDED_A) == 128 + 1);
+
+bool starts_with(const std::string &text, const std::string &prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+stop_index::stop_index(const std::vector<std::string> &names) : names(names) {
+    exact.reserve(names.size());
+    folded.reserve(names.size());
+    for (uint32_t s = 0; s < names.size(); ++s) {
+        exact.emplace(names[s], s);
+        folded.push_back(fold(names[s]));
+        auto [it, inserted] = by_folded.emplace(folded[s], s);
+        if (!inserted) {
+            it->second = NONE;
+        }
+        // Nazwa od początku każdego słowa – prefiks pasuje także do dalszych słów nazwy
+        const std::string &f = folded[s];
+        size_t pos = 0;
+        while (pos < f.size()) {
+            words.emplace_back(f.substr(pos), s);
+            const size_t space = f.find(' ', pos);
+            pos = space == std::string::npos ? f.size() : space + 1;
+        }
+    }
+    std::sort(words.begin(), words.end());
+
+    by_name.resize(names.size());
+    std::iota(by_name.begin(), by_name.end(), 0);
+    std::sort(by_name.begin(), by_name.end(), [this](uint32_t a, uint32_t b) {
+        return folded[a] != folded[b] ? folded[a] < folded[b] : a < b;
+    });
+    for (const std::string &f : folded) {
+        longest = std::max(longest, static_cast<uint32_t>(f.size()));
+    }
+    if (!by_name.empty()) {
+        build_trie(0, static_cast<uint32_t>(by_name.size()), 0, '\0');
+    }
+}
+
+// Nazwy by_name[begin, end) mają wspólny prefiks długości depth; krótsze nazwy są w posortowanej tablicy pierwsze
+void stop_index::build_trie(uint32_t begin, uint32_t end, uint32_t depth, char letter) {
+    const uint32_t node = static_cast<uint32_t>(trie.size());
+    uint32_t names_end = begin;
+    while (names_end < end && folded[by_name[names_end]].size() == depth) ++names_end;
+    trie.push_back({letter, depth, 0, begin, names_end, end});
+    for (uint32_t child = names_end; child < end;) {
+        const char c = folded[by_name[child]][depth];
+        uint32_t next = child + 1;
+        while (next < end && folded[by_name[next]][depth] == c) ++next;
+        build_trie(child, next, depth + 1, c);
+        child = next;
+    }
+    trie[node].end = static_cast<uint32_t>(trie.size());
+}
+
+std::string stop_index::fold(std::string_view text) {
+    std::string result;
+    result.reserve(text.size());
+    bool separator = false;
+    auto append = [&](char c) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            if (separator && !result.empty()) result.push_back(' ');
+            separator = false;
+            result.push_back(c);
+        } else {
+            separator = true;
+        }
+    };
+    for (size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            append(static_cast<char>(c));
+            continue;
+        }
+        // Dwubajtowa sekwencja UTF-8 -> punkt kodowy U+0080..U+07FF
+        if ((c & 0xE0) == 0xC0 && i + 1 < text.size()) {
+            const unsigned code = ((c & 0x1Fu) << 6) | (static_cast<unsigned char>(text[i + 1]) & 0x3Fu);
+            ++i;
+            if (code >= 0xC0 && code < 0x100) {
+                append(LATIN1[code - 0xC0]);
+            } else if (code >= 0x100 && code < 0x180) {
+                append(LATIN_EXTENDED_A[code - 0x100]);
+            } else {
+                separator = true;
+            }
+            continue;
+        }
+        // Pozostałe znaki (inne alfabety, symbole) rozdzielają słowa
+        while (i + 1 < text.size() && (static_cast<unsigned char>(text[i + 1]) & 0xC0) == 0x80) ++i;
+        separator = true;
+    }
+    return result;
+}
+
+uint32_t stop_index::find(const std::string &name) const {
+    auto it = exact.find(name);
+    return it == exact.end() ? NONE : it->second;
+}
+
+uint32_t stop_index::resolve(std::string_view text) const {
+    auto it = by_folded.find(fold(text));
+    return it == by_folded.end() ? NONE : it->second;
+}
+
+std::vector<stop_match> stop_index::suggest(std::string_view text, size_t limit) const {
+    const std::string query = fold(text);
+    std::vector<stop_match> matches;
+    if (query.empty() || limit == 0) {
+        return matches;
+    }
+
+    // Prefiksy – zakres posortowanej tablicy słów; przystanek pasujący od początku kilku słów
+    // zostaje z najlepszą rangą
+    for (auto it = std::lower_bound(words.begin(), words.end(), std::make_pair(query, uint32_t(0)));
+         it != words.end() && starts_with(it->first, query); ++it) {
+        const uint32_t stop = it->second;
+        matches.push_back({stop, folded[stop] == query ? 0 : it->first == folded[stop] ? 1 : 2});
+    }
+    std::sort(matches.begin(), matches.end(), [](const stop_match &a, const stop_match &b) {
+        return a.stop != b.stop ? a.stop < b.stop : a.rank < b.rank;
+    });
+    matches.erase(std::unique(matches.begin(), matches.end(),
+                              [](const stop_match &a, const stop_match &b) { return a.stop == b.stop; }),
+                  matches.end());
+
+    // Nazwy podobne – cała nazwa albo jej początek tej samej długości z błędem pisowni
+    // (jedno-, dwuznakowy tekst pasowałby z błędem do prawie każdej nazwy)
+    if (matches.size() < limit && query.size() > 2 && !trie.empty()) {
+        const int max_distance = query.size() <= 4 ? 1 : query.size() <= 8 ? 2 : 3;
+        const size_t prefix_hits = matches.size();
+        auto add = [&](uint32_t first, uint32_t last, int distance) {
+            for (uint32_t i = first; i < last; ++i) {
+                const uint32_t stop = by_name[i];
+                const bool prefix_hit = std::binary_search(
+                    matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(prefix_hits), stop_match{stop, 0},
+                    [](const stop_match &a, const stop_match &b) { return a.stop < b.stop; });
+                if (!prefix_hit) matches.push_back({stop, 3 + distance});
+            }
+        };
+
+        // Wiersze macierzy Levenshteina dla kolejnych głębokości ścieżki w drzewie oraz odległość
+        // początku nazwy o długości tekstu (znana od głębokości query.size() w dół)
+        const size_t width = query.size() + 1;
+        std::vector<int> rows((longest + 1) * width);
+        std::vector<int> prefix_distance(longest + 1, max_distance + 1);
+        std::iota(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(width), 0);
+        for (uint32_t i = 1; i < trie.size();) {
+            const trie_node &node = trie[i];
+            const int *previous = &rows[(node.depth - 1) * width];
+            int *current = &rows[node.depth * width];
+            current[0] = static_cast<int>(node.depth);
+            int row_min = current[0];
+            for (size_t j = 1; j < width; ++j) {
+                const int substitution = previous[j - 1] + (query[j - 1] != node.letter);
+                current[j] = std::min({previous[j] + 1, current[j - 1] + 1, substitution});
+                row_min = std::min(row_min, current[j]);
+            }
+            const int prefix = node.depth == query.size() ? current[width - 1] : prefix_distance[node.depth - 1];
+            prefix_distance[node.depth] = prefix;
+            if (row_min > max_distance) {
+                // Dłuższe nazwy tej gałęzi są jeszcze dalej – pasują co najwyżej początkiem
+                if (prefix <= max_distance) add(node.stops_begin, node.stops_end, prefix);
+                i = node.end;
+                continue;
+            }
+            const int distance = std::min(current[width - 1], prefix);
+            if (distance <= max_distance) add(node.stops_begin, node.names_end, distance);
+            ++i;
+        }
+    }
+
+    auto better = [this](const stop_match &a, const stop_match &b) {
+        return a.rank != b.rank ? a.rank < b.rank : folded[a.stop] != folded[b.stop] ? folded[a.stop] < folded[b.stop]
+                                                                                       : a.stop < b.stop;
+    };
+    if (matches.size() > limit) {
+        std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(limit), matches.end(), better);
+        matches.resize(limit);
+    } else {
+        std::sort(matches.begin(), matches.end(), better);
+    }
+    return matches;
+}
@@ -0,0 +1,89 @@
+#ifndef STOP_INDEX_H
+#define STOP_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct stop_match
+ * @brief Podpowiedź nazwy przystanku.
+ */
+struct stop_match {
+    uint32_t stop;   ///< Identyfikator przystanku (jak w timetable)
+    int rank;        ///< 0 – ta sama nazwa po uproszczeniu, 1 – początek nazwy, 2 – początek słowa nazwy,
+                     ///< 3 + d – nazwa w odległości edycyjnej d
+};
+
+/**
+ * @class stop_index
+ * @brief Indeks nazw przystanków budowany raz przy wczytaniu rozkładu: wyszukiwanie dokładne,
+ *        bez rozróżniania wielkości liter i znaków diakrytycznych, po prefiksie i przybliżone.
+ *
+ * Nazwy porównywane są w postaci uproszczonej (fold): litery łacińskie bez znaków diakrytycznych
+ * (Ó -> o, Ł -> l, także pozostałe litery Latin-1 i Latin Extended-A), małe litery, a ciągi innych
+ * znaków (spacje, kropki, myślniki) zastąpione jedną spacją. Posortowana tablica zawiera uproszczoną
+ * nazwę każdego przystanku od początku każdego jej słowa, więc prefiks wyszukiwany jest binarnie
+ * (O(log n + długość)), także od środka nazwy ("grunw" -> "PL. GRUNWALDZKI"). Podpowiedzi przybliżone
+ * (odległość Levenshteina z progiem zależnym od długości) liczone są tylko wtedy, gdy prefiksów jest
+ * za mało – przejściem po drzewie trie uproszczonych nazw, w którym gałąź odcinana jest, gdy każde
+ * dopasowanie jej prefiksu przekracza próg, więc odwiedzane są tylko nazwy bliskie wpisanemu tekstowi.
+ */
+class stop_index {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    stop_index() = default;
+
+    /// @param names Nazwy przystanków; identyfikatorem przystanku jest pozycja nazwy.
+    explicit stop_index(const std::vector<std::string> &names);
+
+    /// Postać uproszczona nazwy (UTF-8).
+    static std::string fold(std::string_view text);
+
+    /// Przystanek o dokładnie tej nazwie albo NONE – O(długość nazwy).
+    uint32_t find(const std::string &name) const;
+
+    /**
+     * @brief Przystanek, którego uproszczona nazwa jest równa uproszczonemu `text` ("kozanow" -> "KOZANÓW").
+     * @return uint32_t Identyfikator albo NONE, jeśli takiego przystanku nie ma lub jest ich kilka.
+     */
+    uint32_t resolve(std::string_view text) const;
+
+    /**
+     * @brief Podpowiedzi dla wpisanego tekstu, od najlepszej: ta sama nazwa, początek nazwy, początek
+     *        słowa, a na końcu nazwy podobne (błędy pisowni); w obrębie rangi – alfabetycznie.
+     * @param limit Największa liczba podpowiedzi.
+     */
+    std::vector<stop_match> suggest(std::string_view text, size_t limit) const;
+
+    const std::string &name(uint32_t stop) const { return names[stop]; }
+    size_t size() const { return names.size(); }
+
+private:
+    /// Węzeł drzewa trie w porządku preorder: poddrzewo to węzły [indeks, end), pierwsze dziecko – indeks + 1.
+    struct trie_node {
+        char letter;           ///< Ostatni znak prefiksu węzła
+        uint32_t depth;        ///< Długość prefiksu
+        uint32_t end;          ///< Koniec poddrzewa (następne rodzeństwo)
+        uint32_t stops_begin;  ///< Przystanki poddrzewa: by_name[stops_begin, stops_end),
+        uint32_t names_end;    ///< z czego nazwy kończące się w tym węźle: [stops_begin, names_end)
+        uint32_t stops_end;
+    };
+
+    void build_trie(uint32_t begin, uint32_t end, uint32_t depth, char letter);
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t> exact;
+    std::unordered_map<std::string, uint32_t> by_folded;  ///< Uproszczona nazwa -> przystanek (NONE – kilka przystanków)
+    std::vector<std::string> folded;                      ///< Uproszczona nazwa każdego przystanku
+    std::vector<std::pair<std::string, uint32_t>> words;  ///< (uproszczona nazwa od początku słowa, przystanek), posortowane
+    std::vector<uint32_t> by_name;                        ///< Przystanki posortowane po uproszczonej nazwie
+    std::vector<trie_node> trie;                          ///< Uproszczone nazwy; korzeń to prefiks pusty
+    uint32_t longest = 0;                                 ///< Długość najdłuższej uproszczonej nazwy
+};
+
+#endif // STOP_INDEX_H
@@ -0,0 +1,234 @@
+#include "time_scan.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TIME_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(TIME_SCAN_X86) && defined(__GNUC__)
+// GCC/Clang: jądro AVX2 kompilowane niezależnie od flag, używane po sprawdzeniu procesora
+#define TIME_SCAN_AVX2 1
+#define TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#elif defined(TIME_SCAN_X86) && defined(__AVX2__)
+// MSVC: AVX2 tylko przy kompilacji z /arch:AVX2
+#define TIME_SCAN_AVX2 1
+#define TARGET_AVX2
+#endif
+
+namespace {
+
+// Poniżej tej długości zakres przeszukiwany jest w całości porównaniami wektorowymi
+constexpr uint32_t SCAN_WINDOW = 32;
+
+uint32_t count_less_scalar(const int32_t *values, uint32_t count, int32_t key) {
+    uint32_t result = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        result += values[i] < key;
+    }
+    return result;
+}
+
+uint32_t count_greater_scalar(const int32_t *values, uint32_t count, int32_t key) {
+    uint32_t result = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        result += values[i] > key;
+    }
+    return result;
+}
+
+uint32_t select_less_scalar(const int32_t *values, uint32_t count, int32_t key, uint32_t *out) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        out[n] = i;
+        n += values[i] < key;
+    }
+    return n;
+}
+
+#ifdef TIME_SCAN_X86
+
+uint32_t popcount(unsigned mask) {
+#ifdef __GNUC__
+    return static_cast<uint32_t>(__builtin_popcount(mask));
+#else
+    uint32_t n = 0;
+    for (; mask; mask &= mask - 1) ++n;
+    return n;
+#endif
+}
+
+uint32_t lowest_bit(unsigned mask) {
+#ifdef __GNUC__
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#else
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<uint32_t>(index);
+#endif
+}
+
+// Maska bitowa porównania czterech wartości (bit i – wynik dla values[i])
+unsigned mask_sse2(__m128i compared) {
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(compared)));
+}
+
+uint32_t count_less_sse2(const int32_t *values, uint32_t count, int32_t key) {
+    const __m128i k = _mm_set1_epi32(key);
+    uint32_t result = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        result += popcount(mask_sse2(_mm_cmplt_epi32(v, k)));
+    }
+    return result + count_less_scalar(values + i, count - i, key);
+}
+
+uint32_t count_greater_sse2(const int32_t *values, uint32_t count, int32_t key) {
+    const __m128i k = _mm_set1_epi32(key);
+    uint32_t result = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        result += popcount(mask_sse2(_mm_cmpgt_epi32(v, k)));
+    }
+    return result + count_greater_scalar(values + i, count - i, key);
+}
+
+uint32_t select_less_sse2(const int32_t *values, uint32_t count, int32_t key, uint32_t *out) {
+    const __m128i k = _mm_set1_epi32(key);
+    uint32_t n = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        for (unsigned mask = mask_sse2(_mm_cmplt_epi32(v, k)); mask; mask &= mask - 1) {
+            out[n++] = i + lowest_bit(mask);
+        }
+    }
+    const uint32_t tail = select_less_scalar(values + i, count - i, key, out + n);
+    for (uint32_t j = n; j < n + tail; ++j) {
+        out[j] += i;
+    }
+    return n + tail;
+}
+
+#endif // TIME_SCAN_X86
+
+#ifdef TIME_SCAN_AVX2
+
+TARGET_AVX2 unsigned mask_avx2(__m256i compared) {
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(compared)));
+}
+
+TARGET_AVX2 uint32_t count_less_avx2(const int32_t *values, uint32_t count, int32_t key) {
+    const __m256i k = _mm256_set1_epi32(key);
+    uint32_t result = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+        result += popcount(mask_avx2(_mm256_cmpgt_epi32(k, v)));
+    }
+    return result + count_less_sse2(values + i, count - i, key);
+}
+
+TARGET_AVX2 uint32_t count_greater_avx2(const int32_t *values, uint32_t count, int32_t key) {
+    const __m256i k = _mm256_set1_epi32(key);
+    uint32_t result = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+        result += popcount(mask_avx2(_mm256_cmpgt_epi32(v, k)));
+    }
+    return result + count_greater_sse2(values + i, count - i, key);
+}
+
+TARGET_AVX2 uint32_t select_less_avx2(const int32_t *values, uint32_t count, int32_t key, uint32_t *out) {
+    const __m256i k = _mm256_set1_epi32(key);
+    uint32_t n = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+        for (unsigned mask = mask_avx2(_mm256_cmpgt_epi32(k, v)); mask; mask &= mask - 1) {
+            out[n++] = i + lowest_bit(mask);
+        }
+    }
+    const uint32_t tail = select_less_sse2(values + i, count - i, key, out + n);
+    for (uint32_t j = n; j < n + tail; ++j) {
+        out[j] += i;
+    }
+    return n + tail;
+}
+
+#endif // TIME_SCAN_AVX2
+
+struct kernels {
+    uint32_t (*count_less)(const int32_t *, uint32_t, int32_t);
+    uint32_t (*count_greater)(const int32_t *, uint32_t, int32_t);
+    uint32_t (*select_less)(const int32_t *, uint32_t, int32_t, uint32_t *);
+    const char *isa;
+};
+
+kernels pick_kernels() {
+#ifdef TIME_SCAN_AVX2
+#ifdef __GNUC__
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+#endif
+    {
+        return {count_less_avx2, count_greater_avx2, select_less_avx2, "avx2"};
+    }
+#endif
+#ifdef TIME_SCAN_X86
+    return {count_less_sse2, count_greater_sse2, select_less_sse2, "sse2"};
+#else
+    return {count_less_scalar, count_greater_scalar, select_less_scalar, "scalar"};
+#endif
+}
+
+const kernels active = pick_kernels();
+
+} // namespace
+
+uint32_t count_less(const int32_t *values, uint32_t count, int32_t key) {
+    return active.count_less(values, count, key);
+}
+
+uint32_t count_greater(const int32_t *values, uint32_t count, int32_t key) {
+    return active.count_greater(values, count, key);
+}
+
+uint32_t lower_bound_ascending(const int32_t *values, uint32_t count, int32_t key) {
+    // Wyszukiwanie binarne zawęża zakres do kilku wektorów; w posortowanym zakresie liczba wartości
+    // mniejszych od klucza jest jednocześnie pozycją pierwszej nie mniejszej
+    uint32_t first = 0;
+    while (count > SCAN_WINDOW) {
+        const uint32_t half = count / 2;
+        if (values[first + half] < key) {
+            first += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    return first + active.count_less(values + first, count, key);
+}
+
+uint32_t lower_bound_descending(const int32_t *values, uint32_t count, int32_t key) {
+    uint32_t first = 0;
+    while (count > SCAN_WINDOW) {
+        const uint32_t half = count / 2;
+        if (values[first + half] > key) {
+            first += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    return first + active.count_greater(values + first, count, key);
+}
+
+uint32_t select_less(const int32_t *values, uint32_t count, int32_t key, uint32_t *out) {
+    return active.select_less(values, count, key, out);
+}
+
+const char *time_scan_isa() {
+    return active.isa;
+}
@@ -0,0 +1,40 @@
+#ifndef TIME_SCAN_H
+#define TIME_SCAN_H
+
+#include <cstdint>
+
+/**
+ * @file time_scan.h
+ * @brief Wektorowe przeszukiwanie kolumn czasów rozkładu (sekundy jako int32_t).
+ *
+ * Na x86-64 jądra wybierane są raz, przy starcie programu: AVX2 (jeśli procesor je obsługuje),
+ * SSE2 albo wersja skalarna na pozostałych architekturach. Wyniki nie zależą od wybranego jądra.
+ */
+
+/// Liczba wartości mniejszych niż `key` (kolejność wartości dowolna).
+uint32_t count_less(const int32_t *values, uint32_t count, int32_t key);
+
+/// Liczba wartości większych niż `key` (kolejność wartości dowolna).
+uint32_t count_greater(const int32_t *values, uint32_t count, int32_t key);
+
+/// Pierwsza pozycja w tablicy posortowanej rosnąco, na której wartość jest nie mniejsza niż `key`.
+uint32_t lower_bound_ascending(const int32_t *values, uint32_t count, int32_t key);
+
+/// Pierwsza pozycja w tablicy posortowanej malejąco, na której wartość jest nie większa niż `key`.
+uint32_t lower_bound_descending(const int32_t *values, uint32_t count, int32_t key);
+
+/**
+ * @brief Wybiera pozycje wartości mniejszych niż `key`.
+ *
+ * @param values Przeglądane wartości.
+ * @param count Liczba wartości.
+ * @param key Ograniczenie (ostre).
+ * @param out Wybrane pozycje, rosnąco – miejsce na co najmniej `count` elementów.
+ * @return uint32_t Liczba wybranych pozycji.
+ */
+uint32_t select_less(const int32_t *values, uint32_t count, int32_t key, uint32_t *out);
+
+/// Nazwa używanego zestawu instrukcji ("avx2", "sse2" lub "scalar").
+const char *time_scan_isa();
+
+#endif // TIME_SCAN_H
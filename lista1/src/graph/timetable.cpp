@@ -0,0 +1,392 @@
+#include "timetable.h"
+
+#include <algorithm>
+#include <ctime>
+#include <numeric>
+#include <stdexcept>
+
+#include "../algorithms_utils/trace.h"
+
+namespace {
+
+// Północ (czasu lokalnego) dnia, w którym przypada `time`, oraz data tego dnia
+std::pair<std::chrono::system_clock::time_point, std::chrono::sys_days> local_midnight(
+    const std::chrono::system_clock::time_point &time) {
+    std::time_t t = std::chrono::system_clock::to_time_t(time);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &t);
+#else
+    localtime_r(&t, &local);
+#endif
+    const std::chrono::sys_days day = std::chrono::year_month_day{
+        std::chrono::year(local.tm_year + 1900), std::chrono::month(local.tm_mon + 1), std::chrono::day(local.tm_mday)};
+    local.tm_hour = local.tm_min = local.tm_sec = 0;
+    local.tm_isdst = -1;
+    return {std::chrono::system_clock::from_time_t(std::mktime(&local)), day};
+}
+
+// Buduje tablicę przesunięć CSR z liczności kluczy
+std::vector<uint32_t> offsets_from(const std::vector<uint32_t> &keys, size_t key_count) {
+    std::vector<uint32_t> offsets(key_count + 1, 0);
+    for (uint32_t k : keys) {
+        ++offsets[k + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    return offsets;
+}
+
+// Rozkłada indeksy krawędzi do kubełków kluczy, zachowując kolejność wejściową
+std::vector<uint32_t> bucket(const std::vector<uint32_t> &keys, const std::vector<uint32_t> &offsets) {
+    std::vector<uint32_t> order(keys.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (uint32_t i = 0; i < keys.size(); ++i) {
+        order[fill[keys[i]]++] = i;
+    }
+    return order;
+}
+
+} // namespace
+
+timetable::timetable(std::vector<edge> edges, service_calendar calendar, const footpath_options &walking)
+    : calendar(std::move(calendar)) {
+    TRACE_SCOPE("timetable_build", "connections", static_cast<int64_t>(edges.size()));
+    std::unordered_map<std::string, uint32_t> line_ids;
+    std::unordered_map<std::string, uint32_t> company_ids;
+    auto intern_stop = [this](const std::string &name) {
+        auto [it, inserted] = stop_ids.emplace(name, static_cast<uint32_t>(stop_names.size()));
+        if (inserted) {
+            stop_names.push_back(name);
+        }
+        return it->second;
+    };
+    auto intern = [](std::unordered_map<std::string, uint32_t> &ids, std::vector<std::string> &names,
+                     const std::string &name) {
+        auto [it, inserted] = ids.emplace(name, static_cast<uint32_t>(names.size()));
+        if (inserted) {
+            names.push_back(name);
+        }
+        return it->second;
+    };
+
+    // Dzień odniesienia – dzień najwcześniejszego odjazdu; godziny rozkładu liczone są od jego północy
+    const size_t n = edges.size();
+    if (n == 0) {
+        origin = time_point();
+        origin_day = std::chrono::floor<std::chrono::days>(origin);
+        min_departure = max_departure = min_arrival = max_arrival = duration::zero();
+    } else {
+        auto earliest = std::min_element(edges.begin(), edges.end(), [](const edge &a, const edge &b) {
+            return a.getDepartureTime() < b.getDepartureTime();
+        });
+        std::tie(origin, origin_day) = local_midnight(earliest->getDepartureTime());
+    }
+
+    records.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const edge &e = edges[i];
+        connection &c = records[i];
+        c.departure = seconds_of(e.getDepartureTime());
+        c.arrival = seconds_of(e.getArrivalTime());
+        c.from = intern_stop(e.getStartStop());
+        c.to = intern_stop(e.getEndStop());
+        c.line = intern(line_ids, line_names, e.getLine());
+        const uint32_t company = intern(company_ids, company_names, e.getCompany());
+        if (company > UINT16_MAX) {
+            // Rekord connection ma na przewoźnika 16 bitów – obcięty identyfikator wskazywałby innego przewoźnika
+            throw std::runtime_error("Zbyt wielu przewoźników w rozkładzie (ponad " + std::to_string(UINT16_MAX + 1) + ")");
+        }
+        c.company = static_cast<uint16_t>(company);
+        c.service = e.getService();
+        cover(c);
+        if (e.getId() != i && source_ids.empty()) {
+            source_ids.resize(n);
+            std::iota(source_ids.begin(), source_ids.begin() + static_cast<std::ptrdiff_t>(i), 0);
+        }
+        if (!source_ids.empty()) {
+            source_ids[i] = e.getId();
+        }
+    }
+    const size_t stops = stop_names.size();
+
+    // Współrzędne z pierwszej krawędzi, na której przystanek występuje (tak jak dotychczasowa heurystyka)
+    coords.assign(stops, {0.0, 0.0});
+    std::vector<bool> located(stops, false);
+    for (size_t i = 0; i < n; ++i) {
+        if (!located[records[i].from]) {
+            located[records[i].from] = true;
+            coords[records[i].from] = {edges[i].getStartStopLat(), edges[i].getStartStopLon()};
+        }
+        if (!located[records[i].to]) {
+            located[records[i].to] = true;
+            coords[records[i].to] = {edges[i].getEndStopLat(), edges[i].getEndStopLon()};
+        }
+    }
+    // Napisy i współrzędne są już w tablicach rozkładu
+    edges.clear();
+    edges.shrink_to_fit();
+
+    // Przejścia piesze między przystankami w zadanym promieniu
+    walks = build_footpaths(coords, walking);
+    walk_source.resize(walks.targets.size());
+    for (uint32_t s = 0; s < stops; ++s) {
+        std::fill(walk_source.begin() + walks.offsets[s], walk_source.begin() + walks.offsets[s + 1], s);
+    }
+
+    // Zbiory linii przystanków
+    std::vector<std::vector<uint32_t>> lines(stops);
+    for (const connection &c : records) {
+        lines[c.from].push_back(c.line);
+        lines[c.to].push_back(c.line);
+    }
+    stop_line_offsets.assign(stops + 1, 0);
+    for (size_t s = 0; s < stops; ++s) {
+        std::sort(lines[s].begin(), lines[s].end());
+        lines[s].erase(std::unique(lines[s].begin(), lines[s].end()), lines[s].end());
+        stop_line_offsets[s + 1] = stop_line_offsets[s] + static_cast<uint32_t>(lines[s].size());
+        stop_lines.insert(stop_lines.end(), lines[s].begin(), lines[s].end());
+    }
+
+    // Połączenia wychodzące – stabilnie po odjeździe, więc równe odjazdy zachowują kolejność z pliku
+    std::vector<uint32_t> from_stop(n);
+    std::vector<uint32_t> to_stop(n);
+    for (size_t i = 0; i < n; ++i) {
+        from_stop[i] = records[i].from;
+        to_stop[i] = records[i].to;
+    }
+    out_offsets = offsets_from(from_stop, stops);
+    out_edge_index = bucket(from_stop, out_offsets);
+    for (size_t s = 0; s < stops; ++s) {
+        std::stable_sort(out_edge_index.begin() + out_offsets[s], out_edge_index.begin() + out_offsets[s + 1],
+                         [this](uint32_t a, uint32_t b) {
+                             return records[a].departure < records[b].departure;
+                         });
+    }
+    out_to_stop.resize(n);
+    out_line_id.resize(n);
+    out_slot_id.resize(n);
+    out_departure.resize(n);
+    out_arrival.resize(n);
+    for (uint32_t pos = 0; pos < n; ++pos) {
+        fill_out(pos);
+    }
+
+    // Połączenia przychodzące – malejąco po przyjeździe
+    in_offsets = offsets_from(to_stop, stops);
+    in_edge_index = bucket(to_stop, in_offsets);
+    for (size_t s = 0; s < stops; ++s) {
+        std::sort(in_edge_index.begin() + in_offsets[s], in_edge_index.begin() + in_offsets[s + 1],
+                  [this](uint32_t a, uint32_t b) {
+                      return records[a].arrival > records[b].arrival;
+                  });
+    }
+    in_from_stop.resize(n);
+    in_departure.resize(n);
+    in_arrival.resize(n);
+    for (uint32_t pos = 0; pos < n; ++pos) {
+        fill_in(pos);
+    }
+}
+
+void timetable::cover(const connection &c) {
+    const duration departure = std::chrono::seconds(c.departure);
+    const duration arrival = std::chrono::seconds(c.arrival);
+    min_departure = std::min(min_departure, departure);
+    max_departure = std::max(max_departure, departure);
+    min_arrival = std::min(min_arrival, arrival);
+    max_arrival = std::max(max_arrival, arrival);
+}
+
+void timetable::fill_out(uint32_t pos) {
+    const connection &c = records[out_edge_index[pos]];
+    out_to_stop[pos] = c.to;
+    out_line_id[pos] = c.line;
+    out_slot_id[pos] = static_cast<uint32_t>(
+        std::lower_bound(lines_begin(c.to), lines_end(c.to), c.line) - stop_lines.data());
+    out_departure[pos] = c.departure;
+    out_arrival[pos] = c.arrival;
+}
+
+void timetable::fill_in(uint32_t pos) {
+    const connection &c = records[in_edge_index[pos]];
+    in_from_stop[pos] = c.from;
+    in_departure[pos] = c.departure;
+    in_arrival[pos] = c.arrival;
+}
+
+void timetable::drop_cancelled() {
+    // Zachowujemy kolejność pozostałych pozycji, więc zakresy pozostają posortowane
+    auto compact = [this](std::vector<uint32_t> &offsets, std::vector<uint32_t> &index, auto &&...columns) {
+        uint32_t write = 0;
+        for (size_t s = 0; s + 1 < offsets.size(); ++s) {
+            const uint32_t begin = offsets[s];
+            const uint32_t end = offsets[s + 1];
+            offsets[s] = write;
+            for (uint32_t pos = begin; pos < end; ++pos) {
+                if (!active(index[pos])) continue;
+                index[write] = index[pos];
+                ((columns[write] = columns[pos]), ...);
+                ++write;
+            }
+        }
+        offsets.back() = write;
+        index.resize(write);
+        (columns.resize(write), ...);
+    };
+    compact(out_offsets, out_edge_index, out_to_stop, out_line_id, out_slot_id, out_departure, out_arrival);
+    compact(in_offsets, in_edge_index, in_from_stop, in_departure, in_arrival);
+}
+
+std::shared_ptr<timetable> timetable::patched(const std::vector<edge_change> &changes, uint64_t version) const {
+    auto next = std::make_shared<timetable>(*this);
+    next->version_number = version;
+
+    std::vector<uint32_t> out_stops;
+    std::vector<uint32_t> in_stops;
+    bool removed = false;
+    for (const auto &change : changes) {
+        if (change.cancelled) {
+            if (next->cancelled.empty()) {
+                next->cancelled.assign(records.size(), 0);
+            }
+            removed |= next->cancelled[change.edge] == 0;
+            next->cancelled[change.edge] = 1;
+            continue;
+        }
+        connection &c = next->records[change.edge];
+        c.departure = seconds_of(change.departure);
+        c.arrival = seconds_of(change.arrival);
+        next->cover(c);
+        out_stops.push_back(c.from);
+        in_stops.push_back(c.to);
+    }
+    if (removed) {
+        next->drop_cancelled();
+    }
+
+    // Lokalna naprawa: ponownie sortowane są tylko zakresy przystanków, których dotyczą zmiany
+    auto unique_stops = [](std::vector<uint32_t> &stops) {
+        std::sort(stops.begin(), stops.end());
+        stops.erase(std::unique(stops.begin(), stops.end()), stops.end());
+    };
+    unique_stops(out_stops);
+    unique_stops(in_stops);
+    const std::vector<connection> &records = next->records;
+    for (uint32_t s : out_stops) {
+        std::stable_sort(next->out_edge_index.begin() + next->out_offsets[s],
+                         next->out_edge_index.begin() + next->out_offsets[s + 1],
+                         [&records](uint32_t a, uint32_t b) {
+                             return records[a].departure < records[b].departure;
+                         });
+        for (uint32_t pos = next->out_offsets[s]; pos < next->out_offsets[s + 1]; ++pos) {
+            next->fill_out(pos);
+        }
+    }
+    for (uint32_t s : in_stops) {
+        std::stable_sort(next->in_edge_index.begin() + next->in_offsets[s],
+                         next->in_edge_index.begin() + next->in_offsets[s + 1],
+                         [&records](uint32_t a, uint32_t b) {
+                             return records[a].arrival > records[b].arrival;
+                         });
+        for (uint32_t pos = next->in_offsets[s]; pos < next->in_offsets[s + 1]; ++pos) {
+            next->fill_in(pos);
+        }
+    }
+    return next;
+}
+
+uint32_t timetable::stop_id(const std::string &name) const {
+    auto it = stop_ids.find(name);
+    return it == stop_ids.end() ? NONE : it->second;
+}
+
+int32_t timetable::seconds_of(const time_point &time) const {
+    return floor_seconds(time - origin);
+}
+
+int32_t timetable::ceil_seconds(duration offset) {
+    const auto seconds = std::chrono::ceil<std::chrono::seconds>(offset).count();
+    return static_cast<int32_t>(std::clamp<decltype(seconds)>(seconds, INT32_MIN, INT32_MAX));
+}
+
+int32_t timetable::floor_seconds(duration offset) {
+    const auto seconds = std::chrono::floor<std::chrono::seconds>(offset).count();
+    return static_cast<int32_t>(std::clamp<decltype(seconds)>(seconds, INT32_MIN, INT32_MAX));
+}
+
+uint32_t timetable::first_departing_at(uint32_t stop, const time_point &time) const {
+    const uint32_t first = out_offsets[stop];
+    return first + lower_bound_ascending(out_departure.data() + first, out_offsets[stop + 1] - first,
+                                         ceil_seconds(time - origin));
+}
+
+uint32_t timetable::first_arriving_by(uint32_t stop, const time_point &time) const {
+    const uint32_t first = in_offsets[stop];
+    return first + lower_bound_descending(in_arrival.data() + first, in_offsets[stop + 1] - first,
+                                          floor_seconds(time - origin));
+}
+
+std::pair<uint32_t, uint32_t> timetable::departures_between(uint32_t stop, const time_point &from,
+                                                            const time_point &until) const {
+    const uint32_t begin = first_departing_at(stop, from);
+    const uint32_t end = begin + lower_bound_ascending(out_departure.data() + begin, out_offsets[stop + 1] - begin,
+                                                       ceil_seconds(until - origin));
+    return {begin, end};
+}
+
+int32_t timetable::day_of(const time_point &time) const {
+    return static_cast<int32_t>(std::chrono::floor<std::chrono::days>(time - origin).count());
+}
+
+bool timetable::departs_between(uint32_t stop, const time_point &from, const time_point &until) const {
+    // Jak for_each_departure, ale kończy na pierwszym kursującym połączeniu
+    const int32_t last = day_before(until - origin - min_departure);
+    for (int32_t day = day_at_or_after(from - origin - max_departure); day <= last; ++day) {
+        const duration s = shift(day);
+        const auto [begin, end] = departures_between(stop, from - s, until - s);
+        for (uint32_t pos = begin; pos < end; ++pos) {
+            if (runs(out_edge_index[pos], day)) return true;
+        }
+    }
+    return false;
+}
+
+edge timetable::edge_at(uint32_t e, duration shift) const {
+    const connection &c = records[e];
+    edge result(source_ids.empty() ? e : source_ids[e], company_names[c.company], line_names[c.line],
+                at(c.departure) + shift, at(c.arrival) + shift, stop_names[c.from], stop_names[c.to],
+                coords[c.from].first, coords[c.from].second, coords[c.to].first, coords[c.to].second);
+    result.setService(c.service);
+    return result;
+}
+
+std::vector<edge> timetable::materialize() const {
+    std::vector<edge> result;
+    result.reserve(records.size());
+    for (uint32_t e = 0; e < records.size(); ++e) {
+        result.push_back(edge_at(e, duration::zero()));
+    }
+    return result;
+}
+
+std::vector<memory_entry> timetable::memory_usage() const {
+    return {
+        {"połączenia (connection)", vector_bytes(records) + vector_bytes(source_ids) + vector_bytes(cancelled)},
+        {"nazwy przystanków", strings_bytes(stop_names) + string_map_bytes(stop_ids)},
+        {"nazwy linii i przewoźników", strings_bytes(line_names) + strings_bytes(company_names)},
+        {"współrzędne przystanków", vector_bytes(coords)},
+        {"linie przystanków", vector_bytes(stop_line_offsets) + vector_bytes(stop_lines)},
+        {"indeks odjazdów (CSR)", vector_bytes(out_offsets) + vector_bytes(out_edge_index) +
+                                  vector_bytes(out_to_stop) + vector_bytes(out_line_id) + vector_bytes(out_slot_id) +
+                                  vector_bytes(out_departure) + vector_bytes(out_arrival)},
+        {"indeks przyjazdów (CSR)", vector_bytes(in_offsets) + vector_bytes(in_edge_index) +
+                                    vector_bytes(in_from_stop) + vector_bytes(in_departure) + vector_bytes(in_arrival)},
+        {"przejścia piesze", vector_bytes(walks.offsets) + vector_bytes(walks.targets) + vector_bytes(walks.seconds) +
+                             vector_bytes(walk_source)},
+    };
+}
+
+edge timetable::walk_leg(uint32_t from, uint32_t to, const time_point &departure, duration time) const {
+    return edge(NONE, "", "pieszo", departure, departure + time, stop_names[from], stop_names[to],
+                coords[from].first, coords[from].second, coords[to].first, coords[to].second);
+}
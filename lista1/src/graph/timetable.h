@@ -0,0 +1,352 @@
+#ifndef TIMETABLE_H
+#define TIMETABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <unordered_map>
+#include "connection.h"
+#include "edge.h"
+#include "memory_usage.h"
+#include "service_calendar.h"
+#include "footpaths.h"
+#include "time_scan.h"
+
+// Przegląd połączeń wstawiany w pętlę wyszukiwania (GCC/Clang); inne kompilatory decydują same
+#ifdef __GNUC__
+#define SCAN_ALWAYS_INLINE __attribute__((always_inline))
+#define SCAN_NOINLINE __attribute__((noinline))
+#else
+#define SCAN_ALWAYS_INLINE
+#define SCAN_NOINLINE
+#endif
+
+/**
+ * @struct edge_change
+ * @brief Zmiana pojedynczego połączenia w czasie rzeczywistym.
+ */
+struct edge_change {
+    uint32_t edge;                                   ///< Numer połączenia w rozkładzie (pozycja na liście wejściowej)
+    std::chrono::system_clock::time_point departure; ///< Nowy czas odjazdu
+    std::chrono::system_clock::time_point arrival;   ///< Nowy czas przyjazdu
+    bool cancelled = false;                          ///< Połączenie odwołane (czasy są wtedy pomijane)
+};
+
+/**
+ * @class timetable
+ * @brief Niezmienny rozkład jazdy współdzielony przez wątki wykonujące zapytania.
+ *
+ * Nazwy przystanków, linii i przewoźników są zamieniane na kolejne identyfikatory, a każde połączenie
+ * zapisywane jako 24-bajtowy rekord connection (współrzędne trzymane są raz na przystanek). Lista edge
+ * przekazana do konstruktora nie jest przechowywana – edge_at() i materialize() odtwarzają krawędzie
+ * na potrzeby wyniku. Połączenia układane są dodatkowo w dwóch indeksach CSR:
+ *  - wychodzące z przystanku s zajmują zakres [out_begin(s), out_end(s)) i są posortowane rosnąco
+ *    po czasie odjazdu (pierwsze połączenie odjeżdżające nie wcześniej niż t wyznacza wyszukiwanie binarne),
+ *  - przychodzące do przystanku s zajmują zakres [in_begin(s), in_end(s)) i są posortowane malejąco
+ *    po czasie przyjazdu (na potrzeby wyszukiwania wstecznego).
+ *
+ * Indeksy są kolumnowe: każda cecha połączenia (krawędź, przystanek, linia, odjazd, przyjazd) ma osobną
+ * tablicę, więc przeglądanie odjazdów czyta tylko potrzebne kolumny. Czasy zapisane są jako int32_t –
+ * sekundy od północy dnia odniesienia (rozkład i aktualizacje podają czasy z dokładnością do sekundy) –
+ * dzięki czemu pierwszy odjazd i filtr przyjazdów liczone są porównaniami wektorowymi (time_scan.h).
+ *
+ * Dla każdego przystanku przechowywane są też współrzędne i zbiór obsługujących go linii, dzięki czemu
+ * heurystyka A* nie przegląda całej listy krawędzi. Wszystkie metody są stałe, więc jeden obiekt
+ * może obsługiwać zapytania z wielu wątków jednocześnie; stan zapytania trzyma query_workspace.
+ *
+ * Zmiany w czasie rzeczywistym nie modyfikują obiektu: patched() tworzy nową wersję rozkładu,
+ * a zapytania w toku dalej korzystają z poprzedniej.
+ *
+ * Rozkład jest okresowy: godziny połączeń opisują dzień odniesienia (day 0), a ten sam kurs w dniu
+ * kursowania `day` odjeżdża o out_dep(pos) + shift(day), o ile pozwala na to kalendarz (runs()).
+ * Kolejne dni nie są więc zapisywane w pamięci – wyszukiwanie przechodzi na następny dzień przez
+ * for_each_departure() / for_each_arrival(). Przesunięcie dnia to zawsze 24 h (zmiana czasu
+ * letniego jest pomijana).
+ *
+ * Opcjonalnie rozkład zawiera przejścia piesze między pobliskimi przystankami (footpath_options).
+ * W etykietach wyszukiwania przejście zajmuje miejsce krawędzi – ma identyfikator walk_id(w) spoza
+ * zakresu edges(), a trasę uzupełnia walk_leg().
+ */
+class timetable {
+public:
+    typedef std::chrono::system_clock::time_point time_point;
+
+    /// Identyfikator zwracany dla nieznanego przystanku lub linii.
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    typedef std::chrono::system_clock::duration duration;
+
+    /// Długość dnia kursowania.
+    static constexpr std::chrono::days DAY{1};
+
+    /// Linia przypisywana etykiecie po przejściu pieszym (następne wejście do pojazdu jest przesiadką).
+    static constexpr uint32_t WALK_LINE = UINT32_MAX - 1;
+
+    /// @throws std::runtime_error Jeśli przewoźników jest więcej, niż mieści pole connection::company.
+    explicit timetable(std::vector<edge> edges, service_calendar calendar = service_calendar(),
+                       const footpath_options &walking = footpath_options());
+
+    /// Liczba połączeń; numer połączenia to jego pozycja na liście przekazanej do konstruktora.
+    size_t connection_count() const { return records.size(); }
+    const connection &record(uint32_t e) const { return records[e]; }
+    /// Odjazd i przyjazd połączenia `e` w dniu odniesienia.
+    time_point departure_of(uint32_t e) const { return at(records[e].departure); }
+    time_point arrival_of(uint32_t e) const { return at(records[e].arrival); }
+
+    /// Odtwarza pełną listę krawędzi (w kolejności numerów połączeń) – dla algorytmów pracujących na edge.
+    std::vector<edge> materialize() const;
+
+    /// Rozmiary struktur rozkładu w bajtach (raport --memory-report).
+    std::vector<memory_entry> memory_usage() const;
+
+    /// Numer wersji rozkładu (0 – rozkład statyczny wczytany z pliku).
+    uint64_t version() const { return version_number; }
+
+    /**
+     * @brief Tworzy nową wersję rozkładu z opóźnionymi lub odwołanymi połączeniami.
+     *
+     * Kopiuje rozkład, a następnie naprawia lokalnie tylko zakresy CSR przystanków, których
+     * dotyczą zmiany (ponowne sortowanie zakresu); odwołane połączenia są usuwane z obu indeksów,
+     * ale pozostają w edges(), więc indeksy krawędzi się nie zmieniają.
+     *
+     * @param changes Zmiany połączeń.
+     * @param version Numer nowej wersji.
+     * @return std::shared_ptr<timetable> Nowa wersja rozkładu.
+     */
+    std::shared_ptr<timetable> patched(const std::vector<edge_change> &changes, uint64_t version) const;
+
+    /// Czy połączenie nie zostało odwołane.
+    bool active(uint32_t e) const { return cancelled.empty() || !cancelled[e]; }
+
+    size_t stop_count() const { return stop_names.size(); }
+    size_t line_count() const { return line_names.size(); }
+
+    /// Identyfikator przystanku lub timetable::NONE, jeśli przystanek nie występuje w rozkładzie.
+    uint32_t stop_id(const std::string &name) const;
+    const std::string &stop_name(uint32_t stop) const { return stop_names[stop]; }
+    const std::string &line_name(uint32_t line) const { return line_names[line]; }
+
+    // --- połączenia wychodzące (rosnąco po odjeździe) ---
+    uint32_t out_begin(uint32_t stop) const { return out_offsets[stop]; }
+    uint32_t out_end(uint32_t stop) const { return out_offsets[stop + 1]; }
+    /// Pierwsza pozycja w zakresie przystanku, od której odjazdy są nie wcześniejsze niż `time`.
+    uint32_t first_departing_at(uint32_t stop, const time_point &time) const;
+    /// Najpóźniejszy odjazd z przystanku (przystanek musi mieć połączenia wychodzące).
+    time_point last_departure(uint32_t stop) const { return at(out_departure[out_offsets[stop + 1] - 1]); }
+
+    uint32_t out_edge(uint32_t pos) const { return out_edge_index[pos]; }
+    uint32_t out_to(uint32_t pos) const { return out_to_stop[pos]; }
+    uint32_t out_line(uint32_t pos) const { return out_line_id[pos]; }
+    /// Numer pary (przystanek docelowy, linia) – zakres [0, slot_count()).
+    uint32_t out_slot(uint32_t pos) const { return out_slot_id[pos]; }
+    time_point out_dep(uint32_t pos) const { return at(out_departure[pos]); }
+    time_point out_arr(uint32_t pos) const { return at(out_arrival[pos]); }
+
+    // --- połączenia przychodzące (malejąco po przyjeździe) ---
+    uint32_t in_begin(uint32_t stop) const { return in_offsets[stop]; }
+    uint32_t in_end(uint32_t stop) const { return in_offsets[stop + 1]; }
+    /// Pierwsza pozycja w zakresie przystanku, od której przyjazdy są nie późniejsze niż `time`.
+    uint32_t first_arriving_by(uint32_t stop, const time_point &time) const;
+
+    uint32_t in_edge(uint32_t pos) const { return in_edge_index[pos]; }
+    uint32_t in_from(uint32_t pos) const { return in_from_stop[pos]; }
+    time_point in_dep(uint32_t pos) const { return at(in_departure[pos]); }
+    time_point in_arr(uint32_t pos) const { return at(in_arrival[pos]); }
+
+    // --- dni kursowania ---
+    /// Numer dnia kursowania, w którym przypada `time` (0 – dzień odniesienia rozkładu).
+    int32_t day_of(const time_point &time) const;
+    /// Początek (północ) dnia kursowania `day`.
+    time_point day_start(int32_t day) const { return origin + shift(day); }
+    /// Najwcześniejszy odjazd połączeń dnia kursowania `day` (kursy z godzinami po północy mogą odjeżdżać następnego dnia).
+    time_point service_begin(int32_t day) const { return day_start(day) + min_departure; }
+    /// Najpóźniejszy odjazd połączeń dnia kursowania `day`.
+    time_point service_end(int32_t day) const { return day_start(day) + max_departure; }
+    /// O ile przesunąć godziny rozkładu, aby otrzymać czasy w dniu kursowania `day`.
+    static duration shift(int32_t day) { return DAY * day; }
+    /// Czy wszystkie połączenia kursują codziennie.
+    bool daily() const { return calendar.daily(); }
+    /// Czy połączenie o indeksie `e` z listy edges() kursuje w dniu `day`.
+    bool runs(uint32_t e, int32_t day) const {
+        return calendar.daily() || calendar.runs(records[e].service, origin_day + std::chrono::days(day));
+    }
+
+    /**
+     * @brief Przegląda połączenia odjeżdżające z przystanku w przedziale [from, until).
+     *
+     * Dla każdego dnia kursowania, w którym odjazd może wypaść w przedziale, wywołuje
+     * `visit(pos, shift)` dla pozycji kursujących tego dnia (rosnąco po odjeździe w obrębie dnia);
+     * rzeczywiste czasy to out_dep(pos) + shift i out_arr(pos) + shift.
+     */
+    template<typename Visit>
+    SCAN_ALWAYS_INLINE void for_each_departure(uint32_t stop, const time_point &from, const time_point &until, Visit &&visit) const {
+        const int32_t last = day_before(until - origin - min_departure);
+        for (int32_t day = day_at_or_after(from - origin - max_departure); day <= last; ++day) {
+            const duration s = shift(day);
+            const auto [begin, end] = departures_between(stop, from - s, until - s);
+            for (uint32_t pos = begin; pos < end; ++pos) {
+                if (runs(out_edge_index[pos], day)) visit(pos, s);
+            }
+        }
+    }
+
+    /**
+     * @brief Jak for_each_departure(), ale pomija połączenia przyjeżdżające nie wcześniej niż `arrive_before`.
+     *
+     * Przyjazdy z zakresu odjazdów filtrowane są blokami po SCAN_BLOCK pozycji (select_less), zanim
+     * wyszukiwanie zajrzy do swoich etykiet – przydatne, gdy znany jest już przyjazd do celu.
+     */
+    template<typename Visit>
+    SCAN_ALWAYS_INLINE void for_each_departure(uint32_t stop, const time_point &from, const time_point &until,
+                                               const time_point &arrive_before, Visit &&visit) const {
+        uint32_t picked[SCAN_BLOCK];
+        const int32_t last = day_before(until - origin - min_departure);
+        for (int32_t day = day_at_or_after(from - origin - max_departure); day <= last; ++day) {
+            const duration s = shift(day);
+            const auto [begin, end] = departures_between(stop, from - s, until - s);
+            const int32_t limit = ceil_seconds(arrive_before - s - origin);
+            for (uint32_t block = begin; block < end; block += SCAN_BLOCK) {
+                const uint32_t n = select_less(out_arrival.data() + block, std::min(end - block, SCAN_BLOCK), limit, picked);
+                for (uint32_t i = 0; i < n; ++i) {
+                    const uint32_t pos = block + picked[i];
+                    if (runs(out_edge_index[pos], day)) visit(pos, s);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Przegląda połączenia przyjeżdżające na przystanek w przedziale [from, until].
+     *
+     * Dni kursowania przeglądane są od najpóźniejszego, a w obrębie dnia – malejąco po przyjeździe;
+     * `visit(pos, shift)` otrzymuje pozycję w indeksie przychodzącym.
+     */
+    template<typename Visit>
+    void for_each_arrival(uint32_t stop, const time_point &from, const time_point &until, Visit &&visit) const {
+        const int32_t first = day_at_or_after(from - origin - max_arrival);
+        for (int32_t day = day_before(until - origin - min_arrival + duration(1)); day >= first; --day) {
+            const duration s = shift(day);
+            const uint32_t begin = first_arriving_by(stop, until - s);
+            const uint32_t end = begin + lower_bound_descending(in_arrival.data() + begin, in_end(stop) - begin,
+                                                                ceil_seconds(from - s - origin) - 1);
+            for (uint32_t pos = begin; pos < end; ++pos) {
+                if (runs(in_edge_index[pos], day)) visit(pos, s);
+            }
+        }
+    }
+
+    /// Czy z przystanku odjeżdża jakiekolwiek połączenie w przedziale [from, until).
+    bool departs_between(uint32_t stop, const time_point &from, const time_point &until) const;
+
+    /// Połączenie `e` jako krawędź z czasami przesuniętymi o `shift`.
+    edge edge_at(uint32_t e, duration shift) const;
+
+    // --- przejścia piesze (symetryczne, posortowane po przystanku docelowym) ---
+    uint32_t walk_begin(uint32_t stop) const { return walks.offsets[stop]; }
+    uint32_t walk_end(uint32_t stop) const { return walks.offsets[stop + 1]; }
+    size_t walk_count() const { return walks.targets.size(); }
+    uint32_t walk_to(uint32_t w) const { return walks.targets[w]; }
+    std::chrono::seconds walk_time(uint32_t w) const { return std::chrono::seconds(walks.seconds[w]); }
+
+    /// Identyfikator przejścia `w` w miejscu indeksu krawędzi (search_label::edge, best_edge).
+    uint32_t walk_id(uint32_t w) const { return static_cast<uint32_t>(records.size()) + w; }
+    /// Czy identyfikator krawędzi oznacza przejście piesze.
+    bool is_walk(uint32_t e) const { return e != NONE && e >= records.size(); }
+    /// Numer przejścia o identyfikatorze `e`.
+    uint32_t walk_index(uint32_t e) const { return e - static_cast<uint32_t>(records.size()); }
+    /// Przystanek, z którego prowadzi przejście `w`.
+    uint32_t walk_from(uint32_t w) const { return walk_source[w]; }
+
+    /// Linia etykiety po przejściu pieszym – przed pierwszym przejazdem przejście nie liczy się jako przesiadka.
+    static uint32_t line_after_walk(uint32_t line) { return line == NONE ? NONE : WALK_LINE; }
+
+    /// Odcinek trasy pieszej z przystanku `from` do `to` rozpoczęty w chwili `departure`.
+    edge walk_leg(uint32_t from, uint32_t to, const time_point &departure, duration time) const;
+
+    // --- dane przystanków ---
+    double stop_lat(uint32_t stop) const { return coords[stop].first; }
+    double stop_lon(uint32_t stop) const { return coords[stop].second; }
+    /// Linie obsługujące przystanek (odjazdy i przyjazdy), posortowane rosnąco.
+    const uint32_t *lines_begin(uint32_t stop) const { return stop_lines.data() + stop_line_offsets[stop]; }
+    const uint32_t *lines_end(uint32_t stop) const { return stop_lines.data() + stop_line_offsets[stop + 1]; }
+    size_t slot_count() const { return stop_lines.size(); }
+
+    /// Przystanki i linia połączenia `e`.
+    uint32_t edge_from(uint32_t e) const { return records[e].from; }
+    uint32_t edge_to(uint32_t e) const { return records[e].to; }
+    uint32_t edge_line(uint32_t e) const { return records[e].line; }
+
+private:
+    /// Rozmiar bloku filtrowania przyjazdów w for_each_departure().
+    static constexpr uint32_t SCAN_BLOCK = 64;
+
+    /// Punkt w czasie odpowiadający sekundom od północy dnia odniesienia.
+    time_point at(int32_t seconds) const { return origin + std::chrono::seconds(seconds); }
+    /// Czas w sekundach od północy dnia odniesienia (czasy rozkładu są pełnymi sekundami).
+    int32_t seconds_of(const time_point &time) const;
+    /// Najmniejsza pełna sekunda nie mniejsza niż `offset`, przycięta do zakresu int32_t.
+    static int32_t ceil_seconds(duration offset);
+    /// Największa pełna sekunda nie większa niż `offset`, przycięta do zakresu int32_t.
+    static int32_t floor_seconds(duration offset);
+    /// Zakres pozycji przystanku z odjazdami w przedziale [from, until) (czasy dnia odniesienia).
+    std::pair<uint32_t, uint32_t> departures_between(uint32_t stop, const time_point &from,
+                                                     const time_point &until) const;
+
+    /// Uzupełnia kolumny indeksów na pozycji `pos` na podstawie krawędzi.
+    void fill_out(uint32_t pos);
+    void fill_in(uint32_t pos);
+    /// Usuwa odwołane połączenia z obu indeksów CSR.
+    void drop_cancelled();
+    /// Rozszerza zakres godzin rozkładu (względem początku dnia odniesienia) o połączenie `c`.
+    void cover(const connection &c);
+
+    /// Najmniejszy dzień k, dla którego k * DAY >= offset.
+    static int32_t day_at_or_after(duration offset) {
+        return static_cast<int32_t>(std::chrono::ceil<std::chrono::days>(offset).count());
+    }
+    /// Największy dzień k, dla którego k * DAY < offset.
+    static int32_t day_before(duration offset) { return day_at_or_after(offset) - 1; }
+
+    std::vector<connection> records;
+    std::vector<uint32_t> source_ids; ///< Identyfikatory z pliku – pusty, jeśli równe numerom połączeń
+    uint64_t version_number = 0;
+    std::vector<uint8_t> cancelled; ///< Pusty, dopóki żadne połączenie nie zostało odwołane
+
+    service_calendar calendar;
+    time_point origin;                    ///< Północ dnia odniesienia
+    std::chrono::sys_days origin_day;     ///< Data dnia odniesienia (czas lokalny)
+    duration min_departure = duration::max();
+    duration max_departure = duration::min();
+    duration min_arrival = duration::max();
+    duration max_arrival = duration::min();
+
+    std::unordered_map<std::string, uint32_t> stop_ids;
+    std::vector<std::string> stop_names;
+    std::vector<std::string> line_names;
+    std::vector<std::string> company_names;
+
+    std::vector<uint32_t> out_offsets;
+    std::vector<uint32_t> out_edge_index;
+    std::vector<uint32_t> out_to_stop;
+    std::vector<uint32_t> out_line_id;
+    std::vector<uint32_t> out_slot_id;
+    std::vector<int32_t> out_departure;   ///< Sekundy od północy dnia odniesienia
+    std::vector<int32_t> out_arrival;
+
+    std::vector<uint32_t> in_offsets;
+    std::vector<uint32_t> in_edge_index;
+    std::vector<uint32_t> in_from_stop;
+    std::vector<int32_t> in_departure;
+    std::vector<int32_t> in_arrival;
+
+    std::vector<std::pair<double, double>> coords;
+    footpath_set walks;
+    std::vector<uint32_t> walk_source;
+    std::vector<uint32_t> stop_line_offsets;
+    std::vector<uint32_t> stop_lines;
+};
+
+#endif // TIMETABLE_H
@@ -0,0 +1,92 @@
+#include "trips.h"
+#include "timetable.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+
+/**
+ * Wspólny przebieg grupowania. `Source` udostępnia: size(), departure(i), arrival(i), line(i) (nazwa linii)
+ * oraz start_key(i) / end_key(i) – klucz pary (linia, przystanek początkowy / końcowy) typu Source::key.
+ */
+template<typename Source>
+std::vector<trip> group(const Source &source) {
+    std::vector<uint32_t> order(source.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&source](uint32_t a, uint32_t b) {
+        return source.departure(a) < source.departure(b);
+    });
+
+    // Otwarte końce kursów: (linia, przystanek końcowy) -> lista kursów, które tam dojechały
+    struct open_tail {
+        uint32_t trip;
+        std::chrono::system_clock::time_point arrival;
+    };
+    std::unordered_map<typename Source::key, std::vector<open_tail>> tails;
+
+    std::vector<trip> trips;
+    for (uint32_t idx : order) {
+        const auto departure = source.departure(idx);
+        auto &candidates = tails[source.start_key(idx)];
+
+        // Usuwamy końce, które już nigdy nie zostaną przedłużone (krawędzie są posortowane po odjeździe)
+        std::erase_if(candidates, [&](const open_tail &t) {
+            return departure - t.arrival > MAX_TRIP_DWELL;
+        });
+
+        auto best = candidates.end();
+        for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+            if (it->arrival <= departure && (best == candidates.end() || it->arrival > best->arrival)) {
+                best = it;
+            }
+        }
+
+        uint32_t trip_idx;
+        if (best != candidates.end()) {
+            trip_idx = best->trip;
+            candidates.erase(best);
+        } else {
+            trip_idx = static_cast<uint32_t>(trips.size());
+            trips.push_back({source.line(idx), {}});
+        }
+        trips[trip_idx].edges.push_back(idx);
+        tails[source.end_key(idx)].push_back({trip_idx, source.arrival(idx)});
+    }
+    return trips;
+}
+
+struct edge_source {
+    typedef std::string key;
+    const std::vector<edge> &edges;
+
+    size_t size() const { return edges.size(); }
+    auto departure(uint32_t i) const { return edges[i].getDepartureTime(); }
+    auto arrival(uint32_t i) const { return edges[i].getArrivalTime(); }
+    const std::string &line(uint32_t i) const { return edges[i].getLine(); }
+    key start_key(uint32_t i) const { return edges[i].getLine() + '\x1f' + edges[i].getStartStop(); }
+    key end_key(uint32_t i) const { return edges[i].getLine() + '\x1f' + edges[i].getEndStop(); }
+};
+
+struct timetable_source {
+    typedef uint64_t key;
+    const timetable &tt;
+
+    size_t size() const { return tt.connection_count(); }
+    auto departure(uint32_t i) const { return tt.departure_of(i); }
+    auto arrival(uint32_t i) const { return tt.arrival_of(i); }
+    const std::string &line(uint32_t i) const { return tt.line_name(tt.edge_line(i)); }
+    key start_key(uint32_t i) const { return (static_cast<uint64_t>(tt.edge_line(i)) << 32) | tt.edge_from(i); }
+    key end_key(uint32_t i) const { return (static_cast<uint64_t>(tt.edge_line(i)) << 32) | tt.edge_to(i); }
+};
+
+} // namespace
+
+std::vector<trip> group_into_trips(const std::vector<edge> &edges) {
+    return group(edge_source{edges});
+}
+
+std::vector<trip> group_into_trips(const timetable &tt) {
+    return group(timetable_source{tt});
+}
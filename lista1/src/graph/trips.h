@@ -0,0 +1,47 @@
+#ifndef TRIPS_H
+#define TRIPS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "edge.h"
+
+class timetable;
+
+/**
+ * @brief Maksymalny postój pojazdu na przystanku, przy którym dwie kolejne krawędzie
+ * tej samej linii są jeszcze traktowane jako jeden kurs.
+ */
+constexpr std::chrono::minutes MAX_TRIP_DWELL{5};
+
+/**
+ * @struct trip
+ * @brief Kurs – ciąg kolejnych krawędzi jednej linii obsługiwany przez ten sam pojazd.
+ *
+ * Plik CSV nie zawiera identyfikatora kursu, dlatego kursy są odtwarzane z krawędzi:
+ * krawędź przedłuża kurs, jeśli należy do tej samej linii, zaczyna się na przystanku,
+ * na którym kurs się kończy, i odjeżdża nie wcześniej niż kurs tam przyjechał.
+ */
+struct trip {
+    std::string line;             ///< Nazwa linii
+    std::vector<uint32_t> edges;  ///< Indeksy krawędzi (w wektorze wejściowym) w kolejności przejazdu
+};
+
+/**
+ * @brief Grupuje krawędzie wygenerowane przez graph_generator w kursy.
+ *
+ * Krawędzie przetwarzane są w kolejności czasu odjazdu. Dla każdej krawędzi wybierany jest
+ * otwarty kurs tej samej linii kończący się na jej przystanku początkowym, z najpóźniejszym
+ * przyjazdem nie późniejszym niż odjazd krawędzi (i nie wcześniejszym niż MAX_TRIP_DWELL).
+ * Jeśli takiego kursu nie ma, krawędź rozpoczyna nowy kurs.
+ *
+ * @param edges Lista krawędzi.
+ * @return std::vector<trip> Kursy; każda krawędź należy do dokładnie jednego kursu.
+ */
+std::vector<trip> group_into_trips(const std::vector<edge> &edges);
+
+/// Jak wyżej, ale na połączeniach rozkładu (indeksy krawędzi to numery połączeń).
+std::vector<trip> group_into_trips(const timetable &tt);
+
+#endif // TRIPS_H
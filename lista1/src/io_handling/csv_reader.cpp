@@ -16,16 +16,7 @@ std::vector<std::string> resultData;
     }
     file.imbue(std::locale(file.getloc(), new std::codecvt_utf8<wchar_t>));    std::string line;
     while (std::getline(file, line)) {
-        std::vector<std::string> row;
-        std::stringstream ss(line);
-        std::string token;
-
-        while (std::getline(ss, token)) {
-            row.push_back(token);
-        }
-        resultData.push_back(token);
-
-
+        resultData.push_back(std::move(line));
     }
 
     file.close();
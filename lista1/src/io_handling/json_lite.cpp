@@ -0,0 +1,215 @@
+#include "json_lite.h"
+
+#include <cctype>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+struct json_cursor {
+    const std::string &s;
+    size_t pos = 0;
+
+    void skip_ws() {
+        while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+    }
+    bool eat(char c) {
+        skip_ws();
+        if (pos < s.size() && s[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+};
+
+void append_utf8(std::string &out, unsigned cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+bool parse_string(json_cursor &c, std::string &out, std::string &error) {
+    if (!c.eat('"')) {
+        error = "oczekiwano napisu";
+        return false;
+    }
+    out.clear();
+    while (c.pos < c.s.size()) {
+        char ch = c.s[c.pos++];
+        if (ch == '"') return true;
+        if (ch != '\\') {
+            out += ch;
+            continue;
+        }
+        if (c.pos >= c.s.size()) break;
+        char esc = c.s[c.pos++];
+        switch (esc) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                if (c.pos + 4 > c.s.size()) {
+                    error = "niepełna sekwencja \\u";
+                    return false;
+                }
+                unsigned cp = static_cast<unsigned>(std::stoul(c.s.substr(c.pos, 4), nullptr, 16));
+                c.pos += 4;
+                // Para surogatów UTF-16
+                if (cp >= 0xD800 && cp < 0xDC00 && c.pos + 6 <= c.s.size() && c.s[c.pos] == '\\' && c.s[c.pos + 1] == 'u') {
+                    unsigned low = static_cast<unsigned>(std::stoul(c.s.substr(c.pos + 2, 4), nullptr, 16));
+                    c.pos += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                error = "nieznana sekwencja ucieczki";
+                return false;
+        }
+    }
+    error = "niezakończony napis";
+    return false;
+}
+
+bool parse_scalar(json_cursor &c, std::string &out, bool &is_string, std::string &error) {
+    c.skip_ws();
+    if (c.pos < c.s.size() && c.s[c.pos] == '"') {
+        is_string = true;
+        return parse_string(c, out, error);
+    }
+    is_string = false;
+    size_t begin = c.pos;
+    while (c.pos < c.s.size() && c.s[c.pos] != ',' && c.s[c.pos] != '}' && c.s[c.pos] != ']' &&
+           !std::isspace(static_cast<unsigned char>(c.s[c.pos]))) {
+        ++c.pos;
+    }
+    out = c.s.substr(begin, c.pos - begin);
+    if (out.empty()) {
+        error = "oczekiwano wartości";
+        return false;
+    }
+    return true;
+}
+
+bool parse_object(const std::string &line, std::unordered_map<std::string, json_value> &out, std::string &error) {
+    json_cursor c{line};
+    out.clear();
+    if (!c.eat('{')) {
+        error = "oczekiwano '{'";
+        return false;
+    }
+    if (c.eat('}')) return true;
+    do {
+        std::string key;
+        if (!parse_string(c, key, error)) return false;
+        if (!c.eat(':')) {
+            error = "oczekiwano ':'";
+            return false;
+        }
+        json_value value;
+        if (c.eat('[')) {
+            value.is_array = true;
+            if (!c.eat(']')) {
+                do {
+                    std::string item;
+                    bool is_string = false;
+                    if (!parse_scalar(c, item, is_string, error)) return false;
+                    value.items.push_back(item);
+                } while (c.eat(','));
+                if (!c.eat(']')) {
+                    error = "oczekiwano ']'";
+                    return false;
+                }
+            }
+        } else if (!parse_scalar(c, value.text, value.is_string, error)) {
+            return false;
+        }
+        out[key] = std::move(value);
+    } while (c.eat(','));
+    if (!c.eat('}')) {
+        error = "oczekiwano '}'";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool parse_flat_json(const std::string &line, std::unordered_map<std::string, json_value> &out, std::string &error) {
+    try {
+        return parse_object(line, out, error);
+    } catch (const std::exception &) {
+        error = "niepoprawna sekwencja \\u";
+        return false;
+    }
+}
+
+bool is_json_number(const std::string &text) {
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    size_t i = 0;
+    auto digits = [&text, &i]() {
+        const size_t begin = i;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9') ++i;
+        return i > begin;
+    };
+    if (i < text.size() && text[i] == '-') ++i;
+    if (i < text.size() && text[i] == '0') {
+        ++i;
+    } else if (!digits()) {
+        return false;
+    }
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        if (!digits()) return false;
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        ++i;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-')) ++i;
+        if (!digits()) return false;
+    }
+    return i == text.size();
+}
+
+std::string json_quote(const std::string &text) {
+    std::string out;
+    out.reserve(text.size() + 2);
+    out += '"';
+    for (char ch : text) {
+        switch (ch) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(ch));
+                    out += buf;
+                } else {
+                    out += ch;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
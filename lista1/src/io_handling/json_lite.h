@@ -0,0 +1,42 @@
+#ifndef JSON_LITE_H
+#define JSON_LITE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * @struct json_value
+ * @brief Wartość pola płaskiego obiektu JSON.
+ *
+ * Liczby, wartości logiczne i null przechowywane są w postaci tekstowej (`text`),
+ * tablice – jako lista elementów (`items`, tylko napisy i liczby).
+ */
+struct json_value {
+    std::string text;
+    std::vector<std::string> items;
+    bool is_array = false;
+    bool is_string = false;
+};
+
+/**
+ * @brief Parsuje płaski obiekt JSON (bez zagnieżdżonych obiektów) – np. jedną linię JSON Lines.
+ *
+ * @param line Tekst obiektu.
+ * @param out Wynikowe pola obiektu.
+ * @param error Opis błędu w przypadku niepowodzenia.
+ * @return true, jeśli obiekt sparsowano poprawnie.
+ */
+bool parse_flat_json(const std::string &line, std::unordered_map<std::string, json_value> &out, std::string &error);
+
+/**
+ * @brief Czy tekst jest poprawną liczbą JSON (np. wartość pola bez cudzysłowów, którą można wypisać bez zmian).
+ */
+bool is_json_number(const std::string &text);
+
+/**
+ * @brief Zwraca napis w postaci literału JSON (w cudzysłowach, ze znakami specjalnymi zamienionymi na sekwencje).
+ */
+std::string json_quote(const std::string &text);
+
+#endif // JSON_LITE_H
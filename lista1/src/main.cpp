@@ -3,11 +3,19 @@
 #include <vector>
 #include <chrono>
 #include <iomanip>   // Dla std::setprecision
+#include <algorithm>
 #include "io_handling/csv_reader.h"
 #include "graph/graph_generator.h"
 #include "graph/graph.h"
 #include "ui/user_cli.h"
+#include "ui/batch_runner.h"
+#include "ui/query_executor.h"
+#include "ui/query_server.h"
+#include "ui/result_cache.h"
+#include "ui/realtime_feed.h"
+#include "graph/service_calendar.h"
 #include "graph/edge.h"
+#include "algorithms_utils/trace.h"
 #include <fcntl.h>
 
 #ifdef _WIN32
@@ -31,33 +39,209 @@ void printRoute(const std::vector<edge>& route) {
     }
 }
 
-int main() {
+// Funkcja pomocnicza do wypisania sposobu użycia
+void printUsage(const char *program) {
+    std::cerr << "Użycie: " << program << " [--data <plik.csv>] [--calendar <plik>] [--batch <plik|-> [--batch-group N]] [--serve <port> [--workers N] [--max-pending N]] [--cache-mb N] [--realtime <plik> [--realtime-interval S]] [--walk-radius M [--min-change S]] [--build-indexes] [--memory-report] [--trace <plik.json>]\n"
+              << "  --data         plik z rozkładem (domyślnie ../data/connection_graph.csv)\n"
+              << "  --calendar     kalendarz kursowania: numer,maska dni (7 znaków 0/1 od poniedziałku),od,do (RRRR-MM-DD);\n"
+              << "                 wzorzec połączenia wskazuje opcjonalna 12. kolumna pliku z rozkładem (domyślnie 0 – codziennie)\n"
+              << "  --batch        tryb wsadowy: zapytania JSON Lines lub CSV z pliku albo ze standardowego wejścia (-)\n"
+              << "  --batch-group  zapytania wsadowe wczytywane po N; te o wspólnym początku i czasie (Dijkstra, kryterium\n"
+              << "                 czasowe) wykonywane jednym przeszukiwaniem, np. 256 dla plików z wieloma celami\n"
+              << "                 (domyślnie 0 – każde zapytanie wykonywane i wypisywane zaraz po wczytaniu)\n"
+              << "  --serve        serwer zapytań HTTP na 127.0.0.1:<port> (POST /query, GET /health, GET /stats, GET /stops?q=)\n"
+              << "  --workers      liczba wątków serwera (domyślnie 4)\n"
+              << "  --max-pending  maksymalna liczba połączeń w kolejce, nadmiarowe dostają 503 (domyślnie 64)\n"
+              << "  --cache-mb     limit pamięci podręcznej wyników w trybie wsadowym i serwerze, 0 wyłącza (domyślnie 64)\n"
+              << "  --realtime     plik z opóźnieniami i odwołaniami kursów (linia,przystanek,HH:MM:SS,opóźnienie_s|X[,od_przystanku])\n"
+              << "  --realtime-interval  co ile sekund serwer sprawdza zmiany pliku z opóźnieniami (domyślnie 30)\n"
+              << "  --walk-radius  przejścia piesze między przystankami odległymi o co najwyżej M metrów (domyślnie 0 – wyłączone)\n"
+              << "  --min-change   minimalny czas przesiadki z przejściem pieszym w sekundach (domyślnie 60)\n"
+              << "  --build-indexes  buduje indeksy Trip-Based i Transfer Patterns i zapisuje je obok pliku --data\n"
+              << "                 (<plik>.trip_based.bin, <plik>.transfer_patterns.bin), po czym kończy działanie;\n"
+              << "                 --serve wczytuje je (albo buduje) przy starcie, zanim przyjmie pierwsze zapytanie\n"
+              << "  --memory-report  rozmiary struktur w pamięci: samodzielnie na standardowe wyjście,\n"
+              << "                 z --batch/--serve na standardowe wyjście błędów (po zapytaniach / przy starcie)\n"
+              << "  --trace        ślad faz wykonania (wczytywanie, budowa rozkładu, zapytania, iteracje tabu)\n"
+              << "                 w formacie Chrome trace event – do otwarcia w chrome://tracing lub ui.perfetto.dev\n";
+}
+
+int main(int argc, char *argv[]) {
 #ifdef _WIN32
     SetConsoleCP(CP_UTF8); // Ustawienie konsoli na UTF-8
 #endif
     std::locale::global(std::locale(""));
     std::wcout.imbue(std::locale());
 
-    std::vector<std::string> data = readCSVFile("../data/connection_graph.csv");
-    if (data.empty()) {
-        std::cerr << "Błąd wczytywania danych z pliku CSV." << std::endl;
-        return 1;
+    std::string dataPath = "../data/connection_graph.csv";
+    std::string batchPath;
+    size_t batchGroup = 0;
+    std::string calendarPath;
+    bool serve = false;
+    server_options serverOptions;
+    cache_options cacheOptions;
+    std::string realtimePath;
+    long realtimeInterval = 30;
+    footpath_options walking;
+    bool memoryReport = false;
+    bool buildIndexes = false;
+    std::string tracePath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--data" && i + 1 < argc) {
+                dataPath = argv[++i];
+            } else if (arg == "--calendar" && i + 1 < argc) {
+                calendarPath = argv[++i];
+            } else if (arg == "--batch" && i + 1 < argc) {
+                batchPath = argv[++i];
+            } else if (arg == "--batch-group" && i + 1 < argc) {
+                batchGroup = std::stoul(argv[++i]);
+            } else if (arg == "--serve" && i + 1 < argc) {
+                serve = true;
+                serverOptions.port = static_cast<uint16_t>(std::stoul(argv[++i]));
+            } else if (arg == "--workers" && i + 1 < argc) {
+                serverOptions.workers = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--max-pending" && i + 1 < argc) {
+                serverOptions.max_pending = std::stoul(argv[++i]);
+            } else if (arg == "--cache-mb" && i + 1 < argc) {
+                cacheOptions.memory_budget = std::stoul(argv[++i]) << 20;
+            } else if (arg == "--realtime" && i + 1 < argc) {
+                realtimePath = argv[++i];
+            } else if (arg == "--realtime-interval" && i + 1 < argc) {
+                realtimeInterval = std::max(1L, std::stol(argv[++i]));
+            } else if (arg == "--walk-radius" && i + 1 < argc) {
+                walking.radius_m = std::max(0.0, std::stod(argv[++i]));
+            } else if (arg == "--min-change" && i + 1 < argc) {
+                walking.min_change = std::chrono::seconds(std::max(0L, std::stol(argv[++i])));
+            } else if (arg == "--build-indexes") {
+                buildIndexes = true;
+            } else if (arg == "--memory-report") {
+                memoryReport = true;
+            } else if (arg == "--trace" && i + 1 < argc) {
+                tracePath = argv[++i];
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } catch (const std::exception &) {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Ślad zapisywany przy wyjściu z main – po zakończeniu wątków serwera i aktualizacji
+    trace_session trace(tracePath);
+
+    std::vector<edge> edges;
+    {
+        // Wiersze pliku przechodzą do generatora, a krawędzie z generatora – bez kopiowania
+        std::vector<std::string> data;
+        {
+            TRACE_SCOPE("csv_read");
+            data = readCSVFile(dataPath);
+        }
+        if (data.empty()) {
+            std::cerr << "Błąd wczytywania danych z pliku CSV." << std::endl;
+            return 1;
+        }
+        data.erase(data.begin()); // Usuwamy nagłówek
+
+        TRACE_SCOPE("parse_rows", "rows", static_cast<int64_t>(data.size()));
+        try {
+            graph_generator generator(std::move(data));
+            edges = generator.release_graphs();
+        } catch (const std::exception &e) {
+            std::cerr << "Błąd wczytywania danych z pliku CSV: " << e.what() << std::endl;
+            return 1;
+        }
     }
-    data.erase(data.begin()); // Usuwamy nagłówek
 
-    graph_generator generator(data);
-    std::vector<edge> edges = generator.get_graphs();
+    service_calendar calendar;
+    if (!calendarPath.empty()) {
+        TRACE_SCOPE("calendar_read");
+        std::ifstream calendarFile(calendarPath);
+        std::string error;
+        if (!calendarFile.is_open() || !service_calendar::parse(calendarFile, calendar, error)) {
+            std::cerr << "Błąd wczytywania kalendarza " << calendarPath << ": "
+                      << (error.empty() ? "nie można otworzyć pliku" : error) << std::endl;
+            return 1;
+        }
+    }
 
+    // Jedyny właściciel rozkładu we wszystkich trybach – przejmuje krawędzie i trzyma tylko zwarte rekordy
+    const size_t inputBytes = memoryReport ? edges_bytes(edges) : 0;
+    std::unique_ptr<query_executor> loaded;
+    try {
+        loaded = std::make_unique<query_executor>(std::move(edges), calendar, walking, dataPath);
+    } catch (const std::runtime_error &e) {
+        std::cerr << "Błąd budowy rozkładu: " << e.what() << std::endl;
+        return 1;
+    }
+    query_executor &executor = *loaded;
+
+    if (buildIndexes) {
+        // Prekomputacja offline: zapisane migawki indeksów serwer przy starcie tylko wczytuje
+        if (!executor.prepare_indexes()) {
+            std::cerr << "Indeksy Trip-Based i Transfer Patterns nie obsługują kalendarza kursowania ani przejść pieszych." << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
+    if (serve || !batchPath.empty() || memoryReport) {
+        if (!serve && batchPath.empty()) {
+            executor.memory_report(std::cout, inputBytes);
+            return 0;
+        }
+        if (cacheOptions.memory_budget > 0) {
+            executor.enable_cache(cacheOptions);
+        }
+        realtime_feed feed(executor, realtimePath, std::chrono::seconds(realtimeInterval));
+        if (!realtimePath.empty() && !feed.poll() && !serve) {
+            return 1;
+        }
+        if (serve) {
+            // Serwer: rozkład wczytany raz, zapytania obsługiwane przez pulę wątków,
+            // a plik z opóźnieniami sprawdzany w tle
+            if (!realtimePath.empty()) {
+                feed.start();
+            }
+            // Indeksy gotowe przed pierwszym zapytaniem – budowa nie blokuje wątków obsługujących zapytania
+            executor.prepare_indexes();
+            if (memoryReport) {
+                executor.memory_report(std::cerr, inputBytes);
+            }
+            return run_server(executor, serverOptions);
+        }
+
+        // Tryb wsadowy: rozkład wczytany raz, zapytania wykonywane jedno po drugim
+        int failed;
+        if (batchPath == "-") {
+            failed = run_batch(executor, std::cin, std::cout, batchGroup);
+        } else {
+            std::ifstream queries(batchPath);
+            if (!queries.is_open()) {
+                std::cerr << "Nie można otworzyć pliku z zapytaniami: " << batchPath << std::endl;
+                return 1;
+            }
+            failed = run_batch(executor, queries, std::cout, batchGroup);
+        }
+        if (memoryReport) {
+            executor.memory_report(std::cerr, inputBytes);
+        }
+        return failed == 0 ? 0 : 1;
+    }
 
     user_cli cli;
 
-    std::pair<std::vector<edge>, double> result = cli.execute(edges);
+    std::pair<std::vector<edge>, double> result = cli.execute(executor);
 
 
-    std::vector<edge> bestRoute = result.first;
+    const std::vector<edge> &bestRoute = result.first;
     double bestCost = result.second;
 
+    TRACE_SCOPE("print");
     printDivider("Wynik trasy");
     printRoute(bestRoute);
 
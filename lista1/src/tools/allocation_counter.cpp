@@ -0,0 +1,62 @@
+#include "allocation_counter.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace {
+
+thread_local uint64_t allocations = 0;
+
+void *checked(void *p) {
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+} // namespace
+
+uint64_t thread_allocation_count() {
+    return allocations;
+}
+
+// Postaci tablicowe i nothrow biblioteka standardowa sprowadza do poniższych
+void *operator new(std::size_t size) {
+    ++allocations;
+    return checked(std::malloc(size ? size : 1));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    ++allocations;
+    const std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+    return checked(_aligned_malloc(size ? size : 1, align));
+#else
+    // aligned_alloc wymaga rozmiaru będącego wielokrotnością wyrównania
+    return checked(std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align));
+#endif
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(p, alignment);
+}
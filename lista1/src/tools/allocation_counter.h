@@ -0,0 +1,19 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+/**
+ * @file allocation_counter.h
+ * @brief Zliczanie wywołań globalnego operatora new w narzędziach pomiarowych (lista1_bench, lista1_diff).
+ *
+ * allocation_counter.cpp zastępuje globalne operatory new i delete wersjami, które zwiększają licznik
+ * bieżącego wątku i przekazują przydział do malloc/free. Licznik jest zmienną thread_local, więc pomiar
+ * wielowątkowy nie rywalizuje o wspólną linię pamięci podręcznej. Plik dołączany jest tylko do narzędzi –
+ * program lista1 korzysta ze standardowych operatorów.
+ */
+
+/// Wywołania globalnego operatora new (wszystkich postaci) w bieżącym wątku od jego startu.
+uint64_t thread_allocation_count();
+
+#endif // ALLOCATION_COUNTER_H
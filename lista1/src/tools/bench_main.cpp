@@ -0,0 +1,167 @@
+// bench_main.cpp – cel lista1_bench: pomiar przepustowości i opóźnień wszystkich algorytmów
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../io_handling/csv_reader.h"
+#include "../graph/graph_generator.h"
+#include "../ui/query_executor.h"
+#include "benchmark.h"
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cerr << "Użycie: " << program << " [--data <plik.csv>] [--seed N] [--queries N] [--tabu-queries N] [--required N] [--warmup N] [--only a,b,...] [--threads N,M,...] [--label TEKST] [--json <plik|->]\n"
+              << "  --data          plik z rozkładem (domyślnie ../data/connection_graph.csv)\n"
+              << "  --seed          ziarno zestawu zapytań (domyślnie 42)\n"
+              << "  --queries       zapytania na wariant (domyślnie 200)\n"
+              << "  --tabu-queries  zapytania na wariant tabu i Knox (domyślnie 20)\n"
+              << "  --required      przystanki pośrednie w zapytaniach tabu (domyślnie 2)\n"
+              << "  --warmup        niemierzone zapytania przed pomiarem każdego wariantu (domyślnie 5)\n"
+              << "  --only          mierzone warianty, oddzielone przecinkami:\n"
+              << "                 ";
+    for (const bench_variant &variant : bench_variants()) {
+        std::cerr << " " << variant.name;
+    }
+    std::cerr << "\n"
+              << "  --threads       tryb przepustowości: dla każdej liczby wątków wszystkie wątki jednocześnie\n"
+              << "                  zapytują wspólny rozkład; zap/s, histogram opóźnień i efektywność skalowania\n"
+              << "                  względem najmniejszej liczby wątków (np. 1,2,4,8)\n"
+              << "  --label         opis przebiegu zapisywany w raporcie JSON (np. skrót commita)\n"
+              << "  --json          raport JSON do pliku albo na standardowe wyjście (-, domyślnie);\n"
+              << "                  tabela dla człowieka trafia na standardowe wyjście błędów\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string dataPath = "../data/connection_graph.csv";
+    std::string jsonPath = "-";
+    bench_report report;
+    bench_options &options = report.options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--data" && i + 1 < argc) {
+                dataPath = argv[++i];
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--queries" && i + 1 < argc) {
+                options.queries = std::stoul(argv[++i]);
+            } else if (arg == "--tabu-queries" && i + 1 < argc) {
+                options.tabu_queries = std::stoul(argv[++i]);
+            } else if (arg == "--required" && i + 1 < argc) {
+                options.required_stops = std::stoul(argv[++i]);
+            } else if (arg == "--warmup" && i + 1 < argc) {
+                options.warmup = std::stoul(argv[++i]);
+            } else if (arg == "--only" && i + 1 < argc) {
+                std::stringstream names(argv[++i]);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    if (!name.empty()) options.only.push_back(name);
+                }
+            } else if (arg == "--threads" && i + 1 < argc) {
+                std::stringstream counts(argv[++i]);
+                std::string count;
+                while (std::getline(counts, count, ',')) {
+                    const unsigned long threads = std::stoul(count);
+                    if (threads == 0) throw std::invalid_argument(count);
+                    options.threads.push_back(static_cast<unsigned>(threads));
+                }
+            } else if (arg == "--label" && i + 1 < argc) {
+                report.label = argv[++i];
+            } else if (arg == "--json" && i + 1 < argc) {
+                jsonPath = argv[++i];
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } catch (const std::exception &) {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<const bench_variant *> selected;
+    for (const bench_variant &variant : bench_variants()) {
+        if (options.only.empty() || std::find(options.only.begin(), options.only.end(), variant.name) != options.only.end()) {
+            selected.push_back(&variant);
+        }
+    }
+    for (const std::string &name : options.only) {
+        if (std::none_of(selected.begin(), selected.end(), [&name](const bench_variant *v) { return v->name == name; })) {
+            std::cerr << "Nieznany wariant: " << name << std::endl;
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Rozkład wczytywany raz – mierzone są wyłącznie zapytania
+    const auto loadStart = std::chrono::steady_clock::now();
+    std::vector<edge> edges;
+    {
+        std::vector<std::string> data = readCSVFile(dataPath);
+        if (data.empty()) {
+            std::cerr << "Błąd wczytywania danych z pliku CSV." << std::endl;
+            return 1;
+        }
+        data.erase(data.begin()); // Usuwamy nagłówek
+
+        try {
+            graph_generator generator(std::move(data));
+            edges = generator.release_graphs();
+        } catch (const std::exception &e) {
+            std::cerr << "Błąd wczytywania danych z pliku CSV: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    std::unique_ptr<query_executor> loaded;
+    try {
+        loaded = std::make_unique<query_executor>(std::move(edges), service_calendar(), footpath_options(), dataPath);
+    } catch (const std::runtime_error &e) {
+        std::cerr << "Błąd budowy rozkładu: " << e.what() << std::endl;
+        return 1;
+    }
+    query_executor &executor = *loaded;
+    const std::shared_ptr<const timetable> tt = executor.current();
+    report.load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+    report.data_path = dataPath;
+    report.stops = tt->stop_count();
+    report.connections = tt->connection_count();
+
+    // Jeden zestaw dla wszystkich wariantów – warianty tabu korzystają z jego początku
+    const std::vector<route_query> workload =
+        make_workload(*tt, std::max(options.queries, options.tabu_queries), options.seed, options.required_stops);
+    for (const bench_variant *variant : selected) {
+        const size_t count = std::min(workload.size(), variant->uses_required_stops ? options.tabu_queries
+                                                                                    : options.queries);
+        const std::vector<route_query> queries(workload.begin(), workload.begin() + count);
+        report.results.push_back(run_variant(executor, *variant, queries, options.warmup));
+        std::cerr << "." << std::flush;
+
+        std::vector<parallel_result> scaling;
+        for (unsigned threads : options.threads) {
+            scaling.push_back(run_parallel(executor, *variant, queries, threads, options.warmup));
+            std::cerr << "." << std::flush;
+        }
+        compute_scaling(scaling);
+        report.parallel.insert(report.parallel.end(), scaling.begin(), scaling.end());
+    }
+    std::cerr << "\n";
+
+    write_bench_table(std::cerr, report);
+    if (jsonPath == "-") {
+        write_bench_json(std::cout, report);
+    } else {
+        std::ofstream json(jsonPath);
+        if (!json.is_open()) {
+            std::cerr << "Nie można zapisać raportu: " << jsonPath << std::endl;
+            return 1;
+        }
+        write_bench_json(json, report);
+    }
+    return 0;
+}
@@ -0,0 +1,373 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <latch>
+#include <random>
+#include <thread>
+
+#include "../io_handling/json_lite.h"
+#include "allocation_counter.h"
+
+const std::vector<bench_variant> &bench_variants() {
+    static const std::vector<bench_variant> variants = {
+        {"dijkstra_time", 1, 't', false},
+        {"dijkstra_change", 1, 'p', false},
+        {"astar_time", 2, 't', false},
+        {"astar_change", 2, 'p', false},
+        {"tabu_time", 3, 't', true},
+        {"tabu_change", 3, 'p', true},
+        {"tabu_knox", 4, 't', true},
+        {"trip_based", 5, 't', false},
+        {"transfer_patterns", 6, 't', false},
+        {"arrive_by", 1, 'o', false},
+    };
+    return variants;
+}
+
+std::vector<route_query> make_workload(const timetable &tt, size_t count, uint64_t seed, size_t required_stops) {
+    std::vector<uint32_t> origins;
+    for (uint32_t s = 0; s < tt.stop_count(); ++s) {
+        if (tt.out_begin(s) < tt.out_end(s)) {
+            origins.push_back(s);
+        }
+    }
+    std::vector<route_query> workload;
+    if (origins.empty() || tt.stop_count() < 2) {
+        return workload;
+    }
+
+    // Rzutowanie modulo zamiast std::uniform_int_distribution – wynik nie zależy od biblioteki standardowej
+    std::mt19937_64 rng(seed);
+    auto pick = [&rng](size_t n) { return static_cast<uint32_t>(rng() % n); };
+    const auto first_day = tt.day_start(0);
+
+    workload.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        route_query query;
+        const uint32_t source = origins[pick(origins.size())];
+        uint32_t target = pick(tt.stop_count());
+        if (target == source) {
+            target = (target + 1) % static_cast<uint32_t>(tt.stop_count());
+        }
+        query.start_stop = tt.stop_name(source);
+        query.end_stop = tt.stop_name(target);
+        query.start_time = first_day + std::chrono::hours(5) + std::chrono::seconds(pick(18 * 3600));
+        for (size_t r = 0; r < required_stops; ++r) {
+            query.required_stops.push_back(tt.stop_name(pick(tt.stop_count())));
+        }
+        workload.push_back(std::move(query));
+    }
+    return workload;
+}
+
+latency_summary summarize_latencies(std::vector<double> samples_us) {
+    latency_summary summary;
+    if (samples_us.empty()) {
+        return summary;
+    }
+    std::sort(samples_us.begin(), samples_us.end());
+    // Percentyl p: najmniejsza próbka, od której nie dłużej trwa co najmniej p% zapytań
+    auto percentile = [&samples_us](double p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples_us.size()));
+        return samples_us[std::max<size_t>(rank, 1) - 1];
+    };
+    summary.count = samples_us.size();
+    for (double sample : samples_us) {
+        summary.total_us += sample;
+    }
+    summary.mean_us = summary.total_us / summary.count;
+    summary.p50_us = percentile(50);
+    summary.p95_us = percentile(95);
+    summary.p99_us = percentile(99);
+    summary.max_us = samples_us.back();
+    summary.throughput = summary.total_us > 0.0 ? summary.count / (summary.total_us / 1e6) : 0.0;
+    return summary;
+}
+
+namespace {
+
+route_query prepare_query(route_query query, const bench_variant &variant) {
+    query.algorithm_choice = variant.algorithm;
+    query.optimization_criteria = variant.criterion;
+    if (!variant.uses_required_stops) {
+        query.required_stops.clear();
+    }
+    return query;
+}
+
+bool route_found(const std::pair<std::vector<edge>, double> &result) {
+    return !result.first.empty() || result.second == 0.0;
+}
+
+} // namespace
+
+bench_result run_variant(query_executor &executor, const bench_variant &variant,
+                         const std::vector<route_query> &workload, size_t warmup) {
+    auto prepare = [&variant](const route_query &query) { return prepare_query(query, variant); };
+
+    bench_result result;
+    result.name = variant.name;
+    for (size_t i = 0; i < std::min(warmup, workload.size()); ++i) {
+        executor.execute(prepare(workload[i]));
+    }
+
+    std::vector<double> samples;
+    samples.reserve(workload.size());
+    uint64_t allocations = 0;
+    for (const route_query &original : workload) {
+        const route_query query = prepare(original);
+        const uint64_t allocated = thread_allocation_count();
+        const auto start = std::chrono::steady_clock::now();
+        const auto found = executor.execute(query);
+        samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        allocations += thread_allocation_count() - allocated;
+        if (route_found(found)) {
+            ++result.found;
+            result.cost_sum += found.second;
+        }
+    }
+    result.allocations_per_query = workload.empty() ? 0.0 : static_cast<double>(allocations) / workload.size();
+    result.latency = summarize_latencies(std::move(samples));
+    return result;
+}
+
+latency_histogram::latency_histogram() : counts(index_of(UINT64_MAX) + 1, 0) {}
+
+size_t latency_histogram::index_of(uint64_t ns) {
+    constexpr uint64_t exact = uint64_t(1) << SUB_BITS;
+    if (ns < exact) {
+        return static_cast<size_t>(ns);
+    }
+    // Potęga dwójki wyznacza przesunięcie, najstarsze SUB_BITS bitów – przedział w jej obrębie
+    const unsigned shift = static_cast<unsigned>(std::bit_width(ns)) - SUB_BITS;
+    const uint64_t mantissa = ns >> shift; // [2^(SUB_BITS-1), 2^SUB_BITS)
+    return static_cast<size_t>(exact + (shift - 1) * (exact / 2) + (mantissa - exact / 2));
+}
+
+uint64_t latency_histogram::upper_bound_of(size_t index) {
+    constexpr uint64_t exact = uint64_t(1) << SUB_BITS;
+    if (index < exact) {
+        return index;
+    }
+    const uint64_t shift = (index - exact) / (exact / 2) + 1;
+    const uint64_t mantissa = (index - exact) % (exact / 2) + exact / 2;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void latency_histogram::record(uint64_t ns) {
+    ++counts[index_of(ns)];
+    ++total;
+    sum += ns;
+    max_value = std::max(max_value, ns);
+}
+
+latency_histogram &latency_histogram::operator+=(const latency_histogram &other) {
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    max_value = std::max(max_value, other.max_value);
+    return *this;
+}
+
+uint64_t latency_histogram::percentile(double p) const {
+    if (total == 0) {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p / 100.0 * total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(upper_bound_of(i), max_value);
+        }
+    }
+    return max_value;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> latency_histogram::buckets() const {
+    std::vector<std::pair<uint64_t, uint64_t>> result;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0) {
+            result.emplace_back(upper_bound_of(i), counts[i]);
+        }
+    }
+    return result;
+}
+
+parallel_result run_parallel(query_executor &executor, const bench_variant &variant,
+                             const std::vector<route_query> &workload, unsigned threads, size_t warmup) {
+    parallel_result result;
+    result.name = variant.name;
+    result.threads = std::max(1u, threads);
+    std::vector<route_query> queries;
+    queries.reserve(workload.size());
+    for (const route_query &query : workload) {
+        queries.push_back(prepare_query(query, variant));
+    }
+    for (size_t i = 0; i < std::min(warmup, queries.size()); ++i) {
+        executor.execute(queries[i]);
+    }
+    if (queries.empty()) {
+        return result;
+    }
+
+    std::vector<latency_histogram> histograms(result.threads);
+    std::vector<size_t> found(result.threads, 0);
+    std::latch ready(result.threads + 1);
+    std::latch start(1);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < result.threads; ++t) {
+        pool.emplace_back([&, t]() {
+            const size_t offset = queries.size() * t / result.threads;
+            ready.count_down();
+            start.wait();
+            for (size_t i = 0; i < queries.size(); ++i) {
+                const route_query &query = queries[(offset + i) % queries.size()];
+                const auto begin = std::chrono::steady_clock::now();
+                const auto route = executor.execute(query);
+                const auto elapsed = std::chrono::steady_clock::now() - begin;
+                histograms[t].record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                found[t] += route_found(route);
+            }
+        });
+    }
+    // Pomiar od chwili, gdy wszystkie wątki czekają na start
+    ready.arrive_and_wait();
+    const auto begin = std::chrono::steady_clock::now();
+    start.count_down();
+    for (std::thread &worker : pool) {
+        worker.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    for (unsigned t = 0; t < result.threads; ++t) {
+        result.latency += histograms[t];
+        result.found += found[t];
+    }
+    result.throughput = result.seconds > 0.0 ? result.latency.count() / result.seconds : 0.0;
+    return result;
+}
+
+void compute_scaling(std::vector<parallel_result> &results) {
+    const parallel_result *base = nullptr;
+    for (const parallel_result &r : results) {
+        if (!base || r.threads < base->threads) base = &r;
+    }
+    if (!base || base->throughput <= 0.0) {
+        return;
+    }
+    const double per_thread = base->throughput / base->threads;
+    for (parallel_result &r : results) {
+        r.efficiency = r.throughput / r.threads / per_thread;
+    }
+}
+
+void write_bench_json(std::ostream &out, const bench_report &report) {
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"label\":" << json_quote(report.label)
+        << ",\"data\":" << json_quote(report.data_path)
+        << ",\"stops\":" << report.stops
+        << ",\"connections\":" << report.connections
+        << ",\"load_ms\":" << report.load_ms
+        << ",\"seed\":" << report.options.seed
+        << ",\"queries\":" << report.options.queries
+        << ",\"tabu_queries\":" << report.options.tabu_queries
+        << ",\"required_stops\":" << report.options.required_stops
+        << ",\"warmup\":" << report.options.warmup
+        << ",\"results\":[";
+    for (size_t i = 0; i < report.results.size(); ++i) {
+        const bench_result &r = report.results[i];
+        out << (i ? "," : "") << "{\"algorithm\":" << json_quote(r.name)
+            << ",\"queries\":" << r.latency.count
+            << ",\"found\":" << r.found
+            << ",\"cost_sum\":" << r.cost_sum
+            << ",\"allocations_per_query\":" << r.allocations_per_query
+            << ",\"total_ms\":" << r.latency.total_us / 1000.0
+            << ",\"throughput_qps\":" << r.latency.throughput
+            << ",\"mean_us\":" << r.latency.mean_us
+            << ",\"p50_us\":" << r.latency.p50_us
+            << ",\"p95_us\":" << r.latency.p95_us
+            << ",\"p99_us\":" << r.latency.p99_us
+            << ",\"max_us\":" << r.latency.max_us << "}";
+    }
+    out << "]";
+    if (!report.parallel.empty()) {
+        out << ",\"threads\":[";
+        for (size_t i = 0; i < report.options.threads.size(); ++i) {
+            out << (i ? "," : "") << report.options.threads[i];
+        }
+        out << "],\"parallel\":[";
+        for (size_t i = 0; i < report.parallel.size(); ++i) {
+            const parallel_result &r = report.parallel[i];
+            const latency_histogram &h = r.latency;
+            out << (i ? "," : "") << "{\"algorithm\":" << json_quote(r.name)
+                << ",\"threads\":" << r.threads
+                << ",\"queries\":" << h.count()
+                << ",\"found\":" << r.found
+                << ",\"seconds\":" << r.seconds
+                << ",\"throughput_qps\":" << r.throughput
+                << ",\"efficiency\":" << r.efficiency
+                << ",\"mean_us\":" << h.mean() / 1000.0
+                << ",\"p50_us\":" << h.percentile(50) / 1000.0
+                << ",\"p90_us\":" << h.percentile(90) / 1000.0
+                << ",\"p99_us\":" << h.percentile(99) / 1000.0
+                << ",\"p999_us\":" << h.percentile(99.9) / 1000.0
+                << ",\"max_us\":" << h.max() / 1000.0
+                << ",\"histogram_ns\":[";
+            // Niepuste przedziały: [górna granica, liczba próbek]
+            const auto buckets = h.buckets();
+            for (size_t b = 0; b < buckets.size(); ++b) {
+                out << (b ? "," : "") << "[" << buckets[b].first << "," << buckets[b].second << "]";
+            }
+            out << "]}";
+        }
+        out << "]";
+    }
+    out << "}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void write_bench_table(std::ostream &out, const bench_report &report) {
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << "Rozkład: " << report.stops << " przystanków, " << report.connections << " połączeń (wczytanie "
+        << std::fixed << std::setprecision(0) << report.load_ms << " ms), seed " << report.options.seed
+        << ", czasy w µs\n";
+    out << std::left << std::setw(20) << "algorytm" << std::right << std::setw(10) << "zapytania" << std::setw(8)
+        << "trasy" << std::setw(12) << "zap/s" << std::setw(11) << "p50" << std::setw(11) << "p95"
+        << std::setw(11) << "p99" << std::setw(12) << "max" << std::setw(12) << "alok./zap." << "\n";
+    out << std::setprecision(1);
+    for (const bench_result &r : report.results) {
+        out << std::left << std::setw(20) << r.name << std::right << std::setw(10) << r.latency.count
+            << std::setw(8) << r.found << std::setw(12) << r.latency.throughput << std::setw(11) << r.latency.p50_us
+            << std::setw(11) << r.latency.p95_us << std::setw(11) << r.latency.p99_us << std::setw(12)
+            << r.latency.max_us << std::setprecision(2) << std::setw(12) << r.allocations_per_query
+            << std::setprecision(1) << "\n";
+    }
+    if (!report.parallel.empty()) {
+        out << "\nPrzepustowość (wspólny rozkład, każdy wątek wykonuje cały zestaw):\n";
+        out << std::left << std::setw(20) << "algorytm" << std::right << std::setw(8) << "wątki" << std::setw(12)
+            << "zap/s" << std::setw(12) << "efekt." << std::setw(11) << "p50" << std::setw(11) << "p90"
+            << std::setw(11) << "p99" << std::setw(11) << "p99.9" << std::setw(12) << "max" << "\n";
+        for (const parallel_result &r : report.parallel) {
+            const latency_histogram &h = r.latency;
+            out << std::left << std::setw(20) << r.name << std::right << std::setw(8) << r.threads
+                << std::setprecision(1) << std::setw(12) << r.throughput << std::setprecision(2) << std::setw(12)
+                << r.efficiency << std::setprecision(1) << std::setw(11) << h.percentile(50) / 1000.0
+                << std::setw(11) << h.percentile(90) / 1000.0 << std::setw(11) << h.percentile(99) / 1000.0
+                << std::setw(11) << h.percentile(99.9) / 1000.0 << std::setw(12) << h.max() / 1000.0 << "\n";
+        }
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,198 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../graph/timetable.h"
+#include "../ui/query_executor.h"
+
+/**
+ * @file benchmark.h
+ * @brief Powtarzalne zestawy zapytań i pomiar opóźnień algorytmów (cel lista1_bench) – pojedynczo
+ *        albo w trybie przepustowości, na wielu wątkach współdzielących jeden rozkład.
+ */
+
+/**
+ * @struct bench_variant
+ * @brief Wariant mierzonego wyszukiwania – algorytm i kryterium jak w route_query.
+ */
+struct bench_variant {
+    std::string name;
+    int algorithm;            ///< Numeracja jak w menu user_cli
+    char criterion;           ///< 't', 'p' lub 'o'
+    bool uses_required_stops; ///< Warianty tabu dostają przystanki pośrednie i osobny (mniejszy) limit zapytań
+};
+
+/// Wszystkie warianty: Dijkstra, A*, tabu, Knox, Trip-Based, Transfer Patterns i przyjazd na czas.
+const std::vector<bench_variant> &bench_variants();
+
+/**
+ * @struct bench_options
+ * @brief Parametry zestawu zapytań.
+ */
+struct bench_options {
+    uint64_t seed = 42;           ///< Ziarno generatora – ten sam seed daje te same zapytania
+    size_t queries = 200;         ///< Zapytania na wariant
+    size_t tabu_queries = 20;     ///< Zapytania na wariant tabu i Knox
+    size_t required_stops = 2;    ///< Przystanki pośrednie zapytań tabu
+    size_t warmup = 5;            ///< Niemierzone zapytania przed pomiarem (m.in. budowa indeksów TB/TP)
+    std::vector<std::string> only; ///< Nazwy mierzonych wariantów (puste – wszystkie)
+    std::vector<unsigned> threads; ///< Liczby wątków trybu przepustowości (puste – pomiar jednowątkowy)
+};
+
+/**
+ * @brief Generuje zestaw zapytań z ziarna.
+ *
+ * Przystanek początkowy losowany jest spośród przystanków z odjazdami, docelowy – spośród wszystkich
+ * pozostałych, czas – co do sekundy w godzinach 05:00-23:00 pierwszego dnia rozkładu. Generator
+ * (std::mt19937_64 z prostym rzutowaniem modulo) nie zależy od implementacji rozkładów biblioteki
+ * standardowej, więc ten sam seed daje ten sam zestaw na każdej platformie. Wszystkie warianty
+ * korzystają z tego samego zestawu (tabu – z jego początku), a algorytm i kryterium ustawia run_variant().
+ *
+ * @param tt Rozkład.
+ * @param count Liczba zapytań.
+ * @param seed Ziarno.
+ * @param required_stops Liczba przystanków pośrednich w każdym zapytaniu.
+ * @return std::vector<route_query> Zapytania (algorytm i kryterium domyślne).
+ */
+std::vector<route_query> make_workload(const timetable &tt, size_t count, uint64_t seed, size_t required_stops);
+
+/**
+ * @struct latency_summary
+ * @brief Rozkład opóźnień zapytań jednego wariantu.
+ */
+struct latency_summary {
+    size_t count = 0;
+    double total_us = 0.0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p95_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+    double throughput = 0.0; ///< Zapytania na sekundę (jeden wątek)
+};
+
+/// Statystyki próbek w mikrosekundach (percentyle metodą najbliższej rangi).
+latency_summary summarize_latencies(std::vector<double> samples_us);
+
+/**
+ * @struct bench_result
+ * @brief Wynik pomiaru jednego wariantu.
+ */
+struct bench_result {
+    std::string name;
+    latency_summary latency;
+    size_t found = 0;       ///< Zapytania, dla których znaleziono trasę
+    double cost_sum = 0.0;  ///< Suma kosztów znalezionych tras – zmienia się, gdy zmieniają się wyniki
+    double allocations_per_query = 0.0; ///< Wywołania globalnego operatora new na zapytanie (allocation_counter.h)
+};
+
+/**
+ * @brief Mierzy wariant na zestawie zapytań.
+ *
+ * Pierwsze `warmup` zapytań wykonywanych jest bez pomiaru, następnie każde zapytanie zestawu –
+ * pojedynczo, z pomiarem czasu std::chrono::steady_clock. Wywołania globalnego operatora new liczone są
+ * tylko w executor.execute (łącznie z przydziałem zwracanej trasy), poza mierzonym czasem.
+ */
+bench_result run_variant(query_executor &executor, const bench_variant &variant,
+                         const std::vector<route_query> &workload, size_t warmup);
+
+/**
+ * @class latency_histogram
+ * @brief Histogram opóźnień o stałej względnej dokładności (jak HdrHistogram).
+ *
+ * Wartości w nanosekundach; poniżej 2^SUB_BITS każda ma własny przedział, powyżej każda potęga dwójki
+ * dzielona jest na 2^(SUB_BITS-1) równych przedziałów, więc błąd względny percentyla nie przekracza
+ * 2^-(SUB_BITS-1) (ok. 1,6%) w całym zakresie. Zapis to inkrementacja licznika bez alokacji –
+ * każdy wątek ma własny histogram, a wyniki łączy operator+=.
+ */
+class latency_histogram {
+public:
+    static constexpr unsigned SUB_BITS = 7;
+
+    latency_histogram();
+
+    /// Dopisuje jedną próbkę.
+    void record(uint64_t ns);
+
+    /// Dołącza próbki innego histogramu.
+    latency_histogram &operator+=(const latency_histogram &other);
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    /// Najmniejsza wartość (górna granica przedziału), od której nie jest większe co najmniej p% próbek.
+    uint64_t percentile(double p) const;
+
+    /// Niepuste przedziały jako pary (górna granica w ns, liczba próbek), rosnąco.
+    std::vector<std::pair<uint64_t, uint64_t>> buckets() const;
+
+private:
+    static size_t index_of(uint64_t ns);
+    static uint64_t upper_bound_of(size_t index);
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t max_value = 0;
+};
+
+/**
+ * @struct parallel_result
+ * @brief Wynik trybu przepustowości jednego wariantu dla jednej liczby wątków.
+ */
+struct parallel_result {
+    std::string name;
+    unsigned threads = 1;
+    double seconds = 0.0;     ///< Czas od startu wszystkich wątków do zakończenia ostatniego
+    double throughput = 0.0;  ///< Zapytania na sekundę łącznie
+    double efficiency = 0.0;  ///< Przepustowość na wątek względem najmniejszej mierzonej liczby wątków
+    size_t found = 0;
+    latency_histogram latency;
+};
+
+/**
+ * @brief Mierzy przepustowość wariantu na `threads` wątkach zapytujących ten sam rozkład.
+ *
+ * Po niemierzonej rozgrzewce (jeden wątek – m.in. budowa indeksów) wątki startują jednocześnie
+ * i każdy wykonuje cały zestaw zapytań, zaczynając od innego miejsca (przesunięcie o 1/threads
+ * zestawu), korzystając z własnej przestrzeni roboczej executora. Opóźnienie każdego zapytania
+ * trafia do histogramu wątku; histogramy łączone są po zakończeniu pomiaru.
+ */
+parallel_result run_parallel(query_executor &executor, const bench_variant &variant,
+                             const std::vector<route_query> &workload, unsigned threads, size_t warmup);
+
+/**
+ * @brief Uzupełnia efficiency wyników jednego wariantu (kolejne liczby wątków).
+ *
+ * Efektywność N wątków to (przepustowość N / N) / (przepustowość M / M), gdzie M jest najmniejszą
+ * zmierzoną liczbą wątków – 1,0 oznacza skalowanie liniowe.
+ */
+void compute_scaling(std::vector<parallel_result> &results);
+
+/**
+ * @struct bench_report
+ * @brief Pełny raport przebiegu lista1_bench.
+ */
+struct bench_report {
+    std::string label;        ///< Dowolny opis przebiegu (np. skrót commita)
+    std::string data_path;
+    size_t stops = 0;
+    size_t connections = 0;
+    double load_ms = 0.0;     ///< Wczytanie CSV i budowa rozkładu
+    bench_options options;
+    std::vector<bench_result> results;
+    std::vector<parallel_result> parallel; ///< Wyniki trybu przepustowości (--threads)
+};
+
+/// Zapisuje raport jako jeden obiekt JSON (do porównań między commitami).
+void write_bench_json(std::ostream &out, const bench_report &report);
+
+/// Wypisuje raport jako tabelę dla człowieka.
+void write_bench_table(std::ostream &out, const bench_report &report);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,174 @@
+// diff_main.cpp – cel lista1_diff: różnicowe porównanie poprawności i czasu algorytmów
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../io_handling/csv_reader.h"
+#include "../graph/graph_generator.h"
+#include "../ui/query_executor.h"
+#include "benchmark.h"
+#include "differential.h"
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cerr << "Użycie: " << program << " [--data <plik.csv>] [--seed N] [--queries N] [--late N] [--warmup N] [--only a,b,...] [--repro <plik>]\n"
+              << "       " << program << " [--data <plik.csv>] [--seed N] [--queries N] --write-batch <plik>\n"
+              << "       " << program << " --compare-batch <wzorzec.jsonl> <wynik.jsonl>\n"
+              << "  --data     plik z rozkładem – rzeczywisty albo z lista1_gen (domyślnie ../data/connection_graph.csv)\n"
+              << "  --seed     ziarno zestawu zapytań (domyślnie 42)\n"
+              << "  --queries  liczba porównywanych zapytań (domyślnie 500)\n"
+              << "  --late     dodatkowe zapytania z ostatnich dwóch godzin pierwszego dnia rozkładu (domyślnie 100)\n"
+              << "  --warmup   niemierzone i nieporównywane zapytania na początku (domyślnie 5)\n"
+              << "  --only     porównywane warianty, oddzielone przecinkami (wzorzec grupy – zawsze):\n"
+              << "            ";
+    for (const auto &group : diff_groups({})) {
+        for (const bench_variant *variant : group) {
+            std::cerr << " " << variant->name;
+        }
+    }
+    std::cerr << "\n"
+              << "  --repro    minimalne rozbieżne zapytania jako JSON Lines dla lista1 --batch\n"
+              << "  --write-batch    zamiast porównania zapisuje zestaw zapytań (każde każdym wariantem) jako JSON Lines\n"
+              << "                   dla lista1 --batch – do uruchomienia dwiema wersjami programu\n"
+              << "  --compare-batch  porównuje wyniki lista1 --batch (found, cost, route) według id\n"
+              << "Kod wyjścia 1 oznacza rozbieżność z wzorcem (Dijkstra tego samego kryterium) albo między plikami wyników.\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string dataPath = "../data/connection_graph.csv";
+    std::string reproPath;
+    std::string batchPath;
+    uint64_t seed = 42;
+    size_t queries = 500;
+    size_t late = 100;
+    size_t warmup = 5;
+    std::vector<std::string> only;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--data" && i + 1 < argc) {
+                dataPath = argv[++i];
+            } else if (arg == "--seed" && i + 1 < argc) {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--queries" && i + 1 < argc) {
+                queries = std::stoul(argv[++i]);
+            } else if (arg == "--late" && i + 1 < argc) {
+                late = std::stoul(argv[++i]);
+            } else if (arg == "--warmup" && i + 1 < argc) {
+                warmup = std::stoul(argv[++i]);
+            } else if (arg == "--only" && i + 1 < argc) {
+                std::stringstream names(argv[++i]);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    if (!name.empty()) only.push_back(name);
+                }
+            } else if (arg == "--repro" && i + 1 < argc) {
+                reproPath = argv[++i];
+            } else if (arg == "--write-batch" && i + 1 < argc) {
+                batchPath = argv[++i];
+            } else if (arg == "--compare-batch" && i + 2 < argc) {
+                std::ifstream expected(argv[i + 1]);
+                std::ifstream actual(argv[i + 2]);
+                if (!expected.is_open() || !actual.is_open()) {
+                    std::cerr << "Nie można otworzyć pliku: " << (expected.is_open() ? argv[i + 2] : argv[i + 1])
+                              << std::endl;
+                    return 2;
+                }
+                const batch_comparison comparison = compare_batch_results(expected, actual);
+                std::cout << "Porównane: " << comparison.compared << ", pominięte: " << comparison.skipped
+                          << ", różny koszt: " << comparison.cost_mismatches << ", różna trasa: "
+                          << comparison.route_mismatches << "\n";
+                for (size_t m = 0; m < std::min<size_t>(comparison.mismatched_ids.size(), 10); ++m) {
+                    std::cout << "  id " << comparison.mismatched_ids[m] << "\n";
+                }
+                return comparison.mismatched_ids.empty() ? 0 : 1;
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } catch (const std::exception &) {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    const auto groups = diff_groups({});
+    for (const std::string &name : only) {
+        const bool known = std::any_of(groups.begin(), groups.end(), [&name](const auto &group) {
+            return std::any_of(group.begin(), group.end(), [&name](const bench_variant *v) { return v->name == name; });
+        });
+        if (!known) {
+            std::cerr << "Nieznany lub nieporównywalny wariant: " << name << std::endl;
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<edge> edges;
+    {
+        std::vector<std::string> data = readCSVFile(dataPath);
+        if (data.empty()) {
+            std::cerr << "Błąd wczytywania danych z pliku CSV." << std::endl;
+            return 1;
+        }
+        data.erase(data.begin()); // Usuwamy nagłówek
+
+        try {
+            graph_generator generator(std::move(data));
+            edges = generator.release_graphs();
+        } catch (const std::exception &e) {
+            std::cerr << "Błąd wczytywania danych z pliku CSV: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    std::unique_ptr<query_executor> loaded;
+    try {
+        loaded = std::make_unique<query_executor>(std::move(edges), service_calendar(), footpath_options(), dataPath);
+    } catch (const std::runtime_error &e) {
+        std::cerr << "Błąd budowy rozkładu: " << e.what() << std::endl;
+        return 1;
+    }
+    query_executor &executor = *loaded;
+    const std::shared_ptr<const timetable> tt = executor.current();
+    std::cerr << "Rozkład: " << tt->stop_count() << " przystanków, " << tt->connection_count() << " połączeń, seed "
+              << seed << std::endl;
+
+    if (!batchPath.empty()) {
+        std::ofstream batch(batchPath);
+        if (!batch.is_open()) {
+            std::cerr << "Nie można zapisać pliku: " << batchPath << std::endl;
+            return 1;
+        }
+        write_batch_workload(batch, make_workload(*tt, queries, seed, 0), tt->day_start(0));
+        std::cerr << "Zapisano " << queries << " × " << bench_variants().size() << " zapytań do " << batchPath
+                  << std::endl;
+        return 0;
+    }
+
+    std::vector<route_query> workload = make_workload(*tt, queries + warmup, seed, 0);
+    const std::vector<route_query> evening = make_late_workload(*tt, late, seed);
+    workload.insert(workload.end(), evening.begin(), evening.end());
+    const diff_report report = run_differential(executor, workload, only, warmup);
+    write_diff_table(std::cout, report);
+
+    if (!reproPath.empty()) {
+        std::ofstream repro(reproPath);
+        if (!repro.is_open()) {
+            std::cerr << "Nie można zapisać pliku: " << reproPath << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < report.divergences.size(); ++i) {
+            repro << format_repro(report.divergences[i].minimal, i + 1, report.day_start) << "\n";
+        }
+    }
+    std::cerr << (report.divergences.empty() ? "Wszystkie warianty zgodne ze wzorcem."
+                                             : std::to_string(report.divergences.size()) + " rozbieżności.")
+              << std::endl;
+    return report.divergences.empty() ? 0 : 1;
+}
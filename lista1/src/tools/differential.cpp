@@ -0,0 +1,336 @@
+#include "differential.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+#include "../io_handling/json_lite.h"
+
+namespace {
+
+route_query prepared(route_query query, const bench_variant &variant) {
+    query.algorithm_choice = variant.algorithm;
+    query.optimization_criteria = variant.criterion;
+    query.required_stops.clear();
+    return query;
+}
+
+// HH:MM:SS od `day_start`, godziny od 24 wzwyż dla kolejnych dni (jak w pliku z rozkładem)
+std::string format_time(const std::chrono::system_clock::time_point &tp,
+                        const std::chrono::system_clock::time_point &day_start) {
+    const long long seconds = std::chrono::duration_cast<std::chrono::seconds>(tp - day_start).count();
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%02lld:%02lld:%02lld", seconds / 3600, seconds / 60 % 60, seconds % 60);
+    return buf;
+}
+
+std::string describe(const diff_outcome &outcome, const std::chrono::system_clock::time_point &day_start) {
+    if (!outcome.found) {
+        return "brak trasy";
+    }
+    std::ostringstream out;
+    out << "przyjazd " << format_time(outcome.arrival, day_start) << ", koszt " << outcome.cost << ", " << outcome.legs
+        << " odcinków";
+    return out.str();
+}
+
+// Wartość pola `key` linii wyniku wsadowego w postaci tekstowej (napis w cudzysłowach, tablica z nawiasami),
+// pusta, jeśli pola nie ma. Cudzysłowy w napisach są poprzedzone '\', więc wzorzec nie trafia do ich wnętrza.
+std::string batch_field(const std::string &line, const std::string &key) {
+    const std::string pattern = "\"" + key + "\":";
+    size_t begin = line.find(pattern);
+    if (begin == std::string::npos) {
+        return {};
+    }
+    begin += pattern.size();
+    size_t end = begin;
+    int depth = 0;
+    bool in_string = false;
+    for (; end < line.size(); ++end) {
+        const char ch = line[end];
+        if (in_string) {
+            if (ch == '\\') {
+                ++end;
+            } else if (ch == '"') {
+                in_string = false;
+            }
+        } else if (ch == '"') {
+            in_string = true;
+        } else if (ch == '[' || ch == '{') {
+            ++depth;
+        } else if (ch == ']' || ch == '}') {
+            if (depth == 0) break;
+            --depth;
+        } else if (ch == ',' && depth == 0) {
+            break;
+        }
+    }
+    return line.substr(begin, end - begin);
+}
+
+struct batch_line {
+    bool answered = false; ///< Wynik zapytania, a nie linia błędu
+    std::string found;
+    double cost = 0.0;
+    std::string route;
+};
+
+std::unordered_map<std::string, batch_line> load_batch_results(std::istream &in, std::vector<std::string> &order) {
+    std::unordered_map<std::string, batch_line> results;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line.front() != '{') continue;
+        const std::string id = batch_field(line, "id");
+        if (id.empty()) continue;
+        batch_line &result = results[id];
+        order.push_back(id);
+        result.found = batch_field(line, "found");
+        result.route = batch_field(line, "route");
+        result.answered = !result.found.empty();
+        if (result.answered) {
+            result.cost = std::strtod(batch_field(line, "cost").c_str(), nullptr);
+        }
+    }
+    return results;
+}
+
+} // namespace
+
+std::vector<std::vector<const bench_variant *>> diff_groups(const std::vector<std::string> &only) {
+    std::vector<std::vector<const bench_variant *>> groups;
+    for (char criterion : {'t', 'p'}) {
+        std::vector<const bench_variant *> group;
+        for (const bench_variant &variant : bench_variants()) {
+            if (variant.criterion != criterion || variant.uses_required_stops) continue;
+            const bool selected = only.empty() || std::find(only.begin(), only.end(), variant.name) != only.end();
+            if (group.empty() || selected) {
+                group.push_back(&variant);
+            }
+        }
+        if (group.size() > 1) {
+            groups.push_back(std::move(group));
+        }
+    }
+    return groups;
+}
+
+std::vector<route_query> make_late_workload(const timetable &tt, size_t count, uint64_t seed) {
+    std::vector<route_query> workload = make_workload(tt, count, seed, 0);
+    const auto last = std::min(tt.service_end(0), tt.day_start(1) - std::chrono::seconds(1));
+    std::mt19937_64 rng(seed);
+    for (route_query &query : workload) {
+        query.start_time = last - std::chrono::seconds(rng() % (2 * 3600));
+    }
+    return workload;
+}
+
+diff_outcome run_outcome(query_executor &executor, const bench_variant &variant, route_query query) {
+    query = prepared(std::move(query), variant);
+    diff_outcome outcome;
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = executor.execute(query);
+    outcome.elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    // Koszt 0 bez odcinków – start jest celem
+    outcome.found = !result.first.empty() || result.second == 0.0;
+    outcome.cost = result.second;
+    outcome.legs = result.first.size();
+    outcome.arrival = result.first.empty() ? query.start_time : result.first.back().getArrivalTime();
+    return outcome;
+}
+
+bool outcomes_agree(char criterion, const diff_outcome &expected, const diff_outcome &actual) {
+    if (expected.found != actual.found) return false;
+    if (!expected.found) return true;
+    return criterion == 'p' ? expected.cost == actual.cost : expected.arrival == actual.arrival;
+}
+
+void minimize_divergence(query_executor &executor, const bench_variant &reference, const bench_variant &engine,
+                         divergence &found) {
+    found.minimal = found.query;
+    // Trasa wyznaczająca przystanki pośrednie kandydatów
+    const route_query query = prepared(found.query, found.expected.found ? reference : engine);
+    const std::vector<edge> route = executor.execute(query).first;
+    if (route.size() < 2) {
+        return;
+    }
+
+    auto diverges = [&](const route_query &candidate) {
+        const diff_outcome expected = run_outcome(executor, reference, candidate);
+        const diff_outcome actual = run_outcome(executor, engine, candidate);
+        if (outcomes_agree(reference.criterion, expected, actual)) {
+            return false;
+        }
+        found.minimal = prepared(candidate, engine);
+        found.expected = expected;
+        found.actual = actual;
+        return true;
+    };
+
+    // Najkrótsza rozbieżna końcówka trasy
+    size_t first = 0;
+    for (size_t i = route.size() - 1; i > 0; --i) {
+        route_query candidate = found.query;
+        candidate.start_stop = route[i].getStartStop();
+        candidate.start_time = route[i].getDepartureTime();
+        if (candidate.start_stop != candidate.end_stop && diverges(candidate)) {
+            first = i;
+            break;
+        }
+    }
+    // Najkrótszy rozbieżny początek tej końcówki
+    const route_query suffix = found.minimal;
+    for (size_t j = first; j + 1 < route.size(); ++j) {
+        route_query candidate = suffix;
+        candidate.end_stop = route[j].getEndStop();
+        if (candidate.start_stop != candidate.end_stop && diverges(candidate)) {
+            break;
+        }
+    }
+}
+
+diff_report run_differential(query_executor &executor, const std::vector<route_query> &workload,
+                             const std::vector<std::string> &only, size_t warmup) {
+    diff_report report;
+    report.day_start = executor.current()->day_start(0);
+    const auto groups = diff_groups(only);
+    std::vector<std::vector<std::vector<double>>> ratios(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g) {
+        ratios[g].resize(groups[g].size());
+        for (const bench_variant *variant : groups[g]) {
+            engine_diff summary;
+            summary.name = variant->name;
+            if (variant != groups[g].front()) {
+                summary.reference = groups[g].front()->name;
+            }
+            report.engines.push_back(summary);
+        }
+    }
+
+    for (size_t q = 0; q < workload.size(); ++q) {
+        size_t slot = 0;
+        for (size_t g = 0; g < groups.size(); ++g) {
+            const bench_variant &reference = *groups[g].front();
+            const diff_outcome expected = run_outcome(executor, reference, workload[q]);
+            for (size_t v = 0; v < groups[g].size(); ++v, ++slot) {
+                const bench_variant &engine = *groups[g][v];
+                const diff_outcome actual = v == 0 ? expected : run_outcome(executor, engine, workload[q]);
+                if (q < warmup) continue;
+
+                engine_diff &summary = report.engines[slot];
+                ++summary.compared;
+                summary.found += actual.found;
+                summary.total_us += actual.elapsed_us;
+                summary.reference_us += expected.elapsed_us;
+                if (expected.elapsed_us > 0.0) {
+                    ratios[g][v].push_back(actual.elapsed_us / expected.elapsed_us);
+                }
+                if (!outcomes_agree(reference.criterion, expected, actual)) {
+                    ++summary.divergent;
+                    divergence found{engine.name, reference.name, prepared(workload[q], engine), {}, expected, actual};
+                    minimize_divergence(executor, reference, engine, found);
+                    report.divergences.push_back(std::move(found));
+                }
+            }
+        }
+    }
+
+    size_t slot = 0;
+    for (auto &group : ratios) {
+        for (auto &samples : group) {
+            if (!samples.empty()) {
+                std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+                report.engines[slot].median_ratio = samples[samples.size() / 2];
+            }
+            ++slot;
+        }
+    }
+    return report;
+}
+
+void write_diff_table(std::ostream &out, const diff_report &report, size_t per_engine) {
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::left << std::setw(20) << "algorytm" << std::setw(16) << "wzorzec" << std::right << std::setw(10)
+        << "zapytania" << std::setw(8) << "trasy" << std::setw(12) << "rozbieżne" << std::setw(12) << "czas [ms]"
+        << std::setw(10) << "iloraz" << std::setw(10) << "mediana" << "\n";
+    out << std::fixed;
+    for (const engine_diff &engine : report.engines) {
+        const double ratio = engine.reference_us > 0.0 ? engine.total_us / engine.reference_us : 0.0;
+        out << std::left << std::setw(20) << engine.name << std::setw(16)
+            << (engine.reference.empty() ? "-" : engine.reference) << std::right << std::setw(10) << engine.compared
+            << std::setw(8) << engine.found << std::setw(12) << engine.divergent << std::setprecision(1)
+            << std::setw(12) << engine.total_us / 1000.0 << std::setprecision(3) << std::setw(10) << ratio
+            << std::setw(10) << engine.median_ratio << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+
+    for (const engine_diff &engine : report.engines) {
+        size_t shown = 0;
+        for (const divergence &d : report.divergences) {
+            if (d.engine != engine.name) continue;
+            if (shown++ == per_engine) {
+                out << "  ... i " << engine.divergent - per_engine << " kolejnych (wszystkie w --repro)\n";
+                break;
+            }
+            out << "\nRozbieżność " << d.engine << " względem " << d.reference << ":\n"
+                << "  zapytanie:  " << format_repro(d.query, 0, report.day_start) << "\n"
+                << "  minimalne:  " << format_repro(d.minimal, 0, report.day_start) << "\n"
+                << "  " << d.reference << ": " << describe(d.expected, report.day_start) << "\n"
+                << "  " << d.engine << ": " << describe(d.actual, report.day_start) << "\n";
+        }
+    }
+}
+
+std::string format_repro(const route_query &query, size_t id, const std::chrono::system_clock::time_point &day_start) {
+    std::ostringstream out;
+    out << "{\"id\":" << id << ",\"start\":" << json_quote(query.start_stop) << ",\"end\":"
+        << json_quote(query.end_stop) << ",\"time\":\"" << format_time(query.start_time, day_start) << "\",\"criterion\":\""
+        << query.optimization_criteria << "\",\"algorithm\":" << query.algorithm_choice << "}";
+    return out.str();
+}
+
+void write_batch_workload(std::ostream &out, const std::vector<route_query> &workload,
+                          const std::chrono::system_clock::time_point &day_start) {
+    const std::vector<bench_variant> &variants = bench_variants();
+    for (size_t q = 0; q < workload.size(); ++q) {
+        for (size_t v = 0; v < variants.size(); ++v) {
+            out << format_repro(prepared(workload[q], variants[v]), q * variants.size() + v + 1, day_start) << "\n";
+        }
+    }
+}
+
+batch_comparison compare_batch_results(std::istream &expected, std::istream &actual) {
+    std::vector<std::string> order;
+    std::vector<std::string> actual_order;
+    const auto reference = load_batch_results(expected, order);
+    const auto results = load_batch_results(actual, actual_order);
+
+    batch_comparison comparison;
+    for (const std::string &id : order) {
+        const batch_line &a = reference.at(id);
+        const auto it = results.find(id);
+        if (!a.answered || it == results.end() || !it->second.answered) {
+            ++comparison.skipped;
+            continue;
+        }
+        const batch_line &b = it->second;
+        ++comparison.compared;
+        if (a.found != b.found || std::abs(a.cost - b.cost) > 1e-6) {
+            ++comparison.cost_mismatches;
+            comparison.mismatched_ids.push_back(id);
+        } else if (a.route != b.route) {
+            ++comparison.route_mismatches;
+            comparison.mismatched_ids.push_back(id);
+        }
+    }
+    for (const std::string &id : actual_order) {
+        if (!reference.contains(id)) ++comparison.skipped;
+    }
+    return comparison;
+}
@@ -0,0 +1,162 @@
+#ifndef DIFFERENTIAL_H
+#define DIFFERENTIAL_H
+
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../ui/query_executor.h"
+#include "benchmark.h"
+
+/**
+ * @file differential.h
+ * @brief Różnicowe porównanie algorytmów na tych samych zapytaniach (cel lista1_diff).
+ *
+ * Warianty z bench_variants() dzielone są na grupy według kryterium: czasowe ('t') porównuje się
+ * po godzinie przyjazdu, przesiadkowe ('p') – po liczbie przesiadek (koszcie). Pierwszy wariant
+ * grupy (Dijkstra) jest wzorcem; warianty tabu (zależne od losowego porządku przystanków) i przyjazd
+ * na czas (jedyny algorytm swojego kryterium) nie są porównywane. Nowy wariant dopisany do
+ * bench_variants() trafia do porównania bez zmian w tym module.
+ */
+
+/**
+ * @struct diff_outcome
+ * @brief Wynik jednego wariantu dla jednego zapytania.
+ */
+struct diff_outcome {
+    bool found = false;
+    std::chrono::system_clock::time_point arrival; ///< Przyjazd ostatnim odcinkiem (czas zapytania dla pustej trasy)
+    double cost = -1.0;
+    size_t legs = 0;
+    double elapsed_us = 0.0;
+};
+
+/**
+ * @struct divergence
+ * @brief Zapytanie, dla którego wariant nie zgadza się ze wzorcem.
+ */
+struct divergence {
+    std::string engine;
+    std::string reference;
+    route_query query;       ///< Zapytanie z zestawu (algorytm i kryterium wariantu)
+    route_query minimal;     ///< Najkrótsze znalezione zapytanie z tą samą rozbieżnością
+    diff_outcome expected;   ///< Wynik wzorca dla `minimal`
+    diff_outcome actual;     ///< Wynik wariantu dla `minimal`
+};
+
+/**
+ * @struct engine_diff
+ * @brief Podsumowanie porównania jednego wariantu ze wzorcem.
+ */
+struct engine_diff {
+    std::string name;
+    std::string reference;   ///< Puste dla wzorca grupy
+    size_t compared = 0;
+    size_t divergent = 0;
+    size_t found = 0;
+    double total_us = 0.0;
+    double reference_us = 0.0; ///< Łączny czas wzorca na tych samych zapytaniach
+    double median_ratio = 0.0; ///< Mediana ilorazów czasu wariantu i wzorca dla pojedynczych zapytań
+};
+
+/**
+ * @struct diff_report
+ * @brief Wynik przebiegu lista1_diff.
+ */
+struct diff_report {
+    std::chrono::system_clock::time_point day_start; ///< Północ pierwszego dnia rozkładu
+    std::vector<engine_diff> engines;
+    std::vector<divergence> divergences;
+};
+
+/**
+ * @brief Porównywane grupy wariantów (pierwszy wariant grupy jest wzorcem).
+ * @param only Nazwy porównywanych wariantów (puste – wszystkie); wzorzec grupy jest dołączany zawsze.
+ */
+std::vector<std::vector<const bench_variant *>> diff_groups(const std::vector<std::string> &only);
+
+/**
+ * @brief Zapytania późnym wieczorem: zestaw make_workload() z czasami z ostatnich dwóch godzin pierwszego dnia
+ *        rozkładu (przed jego ostatnim odjazdem albo północą).
+ *
+ * Trasy takich zapytań często wymagają kursów następnego dnia kursowania, a indeksy Trip-Based i Transfer
+ * Patterns obejmują kursy jednego dnia – zestaw sprawdza, że warianty te nadal zgadzają się z Dijkstrą.
+ */
+std::vector<route_query> make_late_workload(const timetable &tt, size_t count, uint64_t seed);
+
+/// Wykonuje zapytanie wariantem i zapamiętuje przyjazd, koszt i czas.
+diff_outcome run_outcome(query_executor &executor, const bench_variant &variant, route_query query);
+
+/**
+ * @brief Czy wynik wariantu zgadza się ze wzorcem.
+ *
+ * Oba warianty muszą znaleźć trasę albo oba jej nie znaleźć; dla kryterium 't' przyjazdy muszą być
+ * równe, dla 'p' – liczby przesiadek.
+ */
+bool outcomes_agree(char criterion, const diff_outcome &expected, const diff_outcome &actual);
+
+/**
+ * @brief Zawęża rozbieżne zapytanie do najkrótszego fragmentu trasy, na którym rozbieżność występuje.
+ *
+ * Trasa wzorca (albo wariantu, jeśli wzorzec jej nie znalazł) wyznacza kandydatów: najpierw coraz
+ * dłuższe końcówki trasy (start z przystanku pośredniego o godzinie odjazdu z niego), a od najkrótszej
+ * rozbieżnej końcówki – coraz dłuższe początki (cel w przystanku pośrednim). Wybierane jest pierwsze
+ * zapytanie, dla którego wariant nadal nie zgadza się ze wzorcem.
+ *
+ * @param found Rozbieżność na zapytaniu z zestawu (query, expected i actual wypełnione).
+ */
+void minimize_divergence(query_executor &executor, const bench_variant &reference, const bench_variant &engine,
+                         divergence &found);
+
+/**
+ * @brief Porównuje warianty na zestawie zapytań.
+ *
+ * Każde zapytanie wykonywane jest kolejno przez wszystkie warianty grupy; pierwsze `warmup` zapytań
+ * (m.in. budowa indeksów Trip-Based i Transfer Patterns) nie jest mierzone ani porównywane.
+ */
+diff_report run_differential(query_executor &executor, const std::vector<route_query> &workload,
+                             const std::vector<std::string> &only, size_t warmup);
+
+/// Wypisuje podsumowanie i najwyżej `per_engine` rozbieżności każdego wariantu dla człowieka.
+void write_diff_table(std::ostream &out, const diff_report &report, size_t per_engine = 3);
+
+/**
+ * @brief Zapytanie jako linia JSON trybu wsadowego (lista1 --batch) – do odtworzenia rozbieżności.
+ *
+ * Czas zapisywany jest jako HH:MM:SS od północy pierwszego dnia rozkładu (godziny od 24 wzwyż –
+ * kolejne dni), więc zapytanie odtwarza się także po wczytaniu rozkładu innego dnia.
+ */
+std::string format_repro(const route_query &query, size_t id, const std::chrono::system_clock::time_point &day_start);
+
+/**
+ * @brief Zestaw zapytań jako JSON Lines dla lista1 --batch – każde zapytanie każdym wariantem z bench_variants().
+ *
+ * Zapytanie `q` wariantu `v` dostaje id q · (liczba wariantów) + v + 1. Plik wykonany przez dwie wersje
+ * programu (np. sprzed i po zmianie algorytmu) porównuje compare_batch_results – także wtedy, gdy
+ * starsza wersja nie ma jeszcze lista1_diff.
+ */
+void write_batch_workload(std::ostream &out, const std::vector<route_query> &workload,
+                          const std::chrono::system_clock::time_point &day_start);
+
+/**
+ * @struct batch_comparison
+ * @brief Wynik porównania dwóch plików wynikowych lista1 --batch.
+ */
+struct batch_comparison {
+    size_t compared = 0;        ///< Zapytania z wynikiem w obu plikach
+    size_t skipped = 0;         ///< Zapytania z błędem albo bez wyniku w jednym z plików
+    size_t cost_mismatches = 0; ///< Różne "found" albo "cost"
+    size_t route_mismatches = 0; ///< Ten sam koszt, inna trasa
+    std::vector<std::string> mismatched_ids; ///< Identyfikatory rozbieżnych zapytań (literały JSON)
+};
+
+/**
+ * @brief Porównuje wyniki lista1 --batch tych samych zapytań (według "id").
+ *
+ * Porównywane są pola "found", "cost" i "route" (linie, przystanki, odjazdy i przyjazdy); czas wykonania
+ * i liczniki przeszukiwania są pomijane.
+ */
+batch_comparison compare_batch_results(std::istream &expected, std::istream &actual);
+
+#endif // DIFFERENTIAL_H
@@ -0,0 +1,121 @@
+// gen_main.cpp – cel lista1_gen: syntetyczny rozkład w formacie connection_graph.csv
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "timetable_generator.h"
+
+namespace {
+
+void printUsage(const char *program) {
+    generator_options defaults;
+    std::cerr << "Użycie: " << program << " [--out <plik.csv|->] [--stops N] [--lines N] [--stops-per-line N] [--trips N] [--headway MIN[-MAX]] [--first HH:MM] [--dwell S] [--speed KMH] [--center LAT,LON] [--radius KM] [--company NAZWA] [--seed N]\n"
+              << "  --out             plik wynikowy albo standardowe wyjście (-, domyślnie)\n"
+              << "  --stops           liczba przystanków (domyślnie " << defaults.stops << ")\n"
+              << "  --lines           liczba linii, każda kursuje w obu kierunkach (domyślnie " << defaults.lines << ")\n"
+              << "  --stops-per-line  przystanki na trasie linii (domyślnie " << defaults.stops_per_line << ")\n"
+              << "  --trips           kursy linii w każdym kierunku (domyślnie " << defaults.trips_per_line << ")\n"
+              << "  --headway         odstęp między kursami w minutach, stały albo losowany dla linii z zakresu\n"
+              << "                    (domyślnie " << defaults.headway_min << "-" << defaults.headway_max << ")\n"
+              << "  --first           pierwszy odjazd (domyślnie 05:00)\n"
+              << "  --dwell           postój na przystanku w sekundach (domyślnie " << defaults.dwell << ")\n"
+              << "  --speed           średnia prędkość w km/h (domyślnie " << defaults.speed_kmh << ")\n"
+              << "  --center          środek obszaru (domyślnie " << defaults.center_lat << "," << defaults.center_lon << ")\n"
+              << "  --radius          promień obszaru w km (domyślnie " << defaults.radius_km << ")\n"
+              << "  --company         przewoźnik (domyślnie " << defaults.company << ")\n"
+              << "  --seed            ziarno – ten sam seed daje ten sam plik (domyślnie " << defaults.seed << ")\n";
+}
+
+// "MIN" albo "MIN-MAX"
+void parseHeadway(const std::string &text, generator_options &options) {
+    const size_t dash = text.find('-');
+    options.headway_min = static_cast<uint32_t>(std::stoul(text.substr(0, dash)));
+    options.headway_max = dash == std::string::npos ? options.headway_min
+                                                    : static_cast<uint32_t>(std::stoul(text.substr(dash + 1)));
+}
+
+// "HH:MM" w sekundach od północy
+uint32_t parseClock(const std::string &text) {
+    const size_t colon = text.find(':');
+    if (colon == std::string::npos) {
+        throw std::invalid_argument(text);
+    }
+    return static_cast<uint32_t>(std::stoul(text.substr(0, colon)) * 3600 + std::stoul(text.substr(colon + 1)) * 60);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    generator_options options;
+    std::string outPath = "-";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--out" && i + 1 < argc) {
+                outPath = argv[++i];
+            } else if (arg == "--stops" && i + 1 < argc) {
+                options.stops = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--lines" && i + 1 < argc) {
+                options.lines = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--stops-per-line" && i + 1 < argc) {
+                options.stops_per_line = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--trips" && i + 1 < argc) {
+                options.trips_per_line = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--headway" && i + 1 < argc) {
+                parseHeadway(argv[++i], options);
+            } else if (arg == "--first" && i + 1 < argc) {
+                options.first_departure = parseClock(argv[++i]);
+            } else if (arg == "--dwell" && i + 1 < argc) {
+                options.dwell = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--speed" && i + 1 < argc) {
+                options.speed_kmh = std::stod(argv[++i]);
+            } else if (arg == "--center" && i + 1 < argc) {
+                const std::string center = argv[++i];
+                const size_t comma = center.find(',');
+                if (comma == std::string::npos) {
+                    throw std::invalid_argument(center);
+                }
+                options.center_lat = std::stod(center.substr(0, comma));
+                options.center_lon = std::stod(center.substr(comma + 1));
+            } else if (arg == "--radius" && i + 1 < argc) {
+                options.radius_km = std::stod(argv[++i]);
+            } else if (arg == "--company" && i + 1 < argc) {
+                options.company = argv[++i];
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = std::stoull(argv[++i]);
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } catch (const std::exception &) {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::string error;
+    if (!validate_generator_options(options, error)) {
+        std::cerr << "Niepoprawne parametry: " << error << std::endl;
+        return 2;
+    }
+
+    std::FILE *out = outPath == "-" ? stdout : std::fopen(outPath.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Nie można zapisać pliku: " << outPath << std::endl;
+        return 1;
+    }
+    std::cerr << "Generowanie " << expected_connections(options) << " połączeń..." << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    const generator_stats stats = generate_timetable(options, out);
+    bool failed = std::ferror(out) != 0;
+    failed = (out != stdout ? std::fclose(out) : std::fflush(out)) != 0 || failed;
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (failed) {
+        std::cerr << "Błąd zapisu: " << outPath << std::endl;
+        return 1;
+    }
+    std::cerr << "Zapisano " << stats.connections << " połączeń (" << stats.bytes / (1024 * 1024) << " MiB) w "
+              << seconds << " s, ostatni przyjazd " << stats.last_arrival / 3600 << ":"
+              << (stats.last_arrival / 60 % 60 < 10 ? "0" : "") << stats.last_arrival / 60 % 60 << std::endl;
+    return 0;
+}
@@ -0,0 +1,156 @@
+// matrix_main.cpp – cel lista1_matrix: macierze czasów przejazdu między wszystkimi parami przystanków
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../io_handling/csv_reader.h"
+#include "../graph/graph_generator.h"
+#include "../graph/footpaths.h"
+#include "../graph/service_calendar.h"
+#include "../graph/timetable.h"
+#include "travel_matrix.h"
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cerr << "Użycie: " << program << " --out <plik> [--data <plik.csv>] [--calendar <plik>] [--walk-radius M [--min-change S]] [--times HH:MM[:SS],...] [--threads N]\n"
+              << "  --out          plik wynikowy (format – travel_matrix.h)\n"
+              << "  --data         plik z rozkładem (domyślnie ../data/connection_graph.csv)\n"
+              << "  --calendar     kalendarz kursowania – jak w lista1 (domyślnie wszystkie połączenia codziennie)\n"
+              << "  --walk-radius  przejścia piesze między przystankami odległymi o co najwyżej M metrów (domyślnie 0 – wyłączone)\n"
+              << "  --min-change   minimalny czas przesiadki z przejściem pieszym w sekundach (domyślnie 60)\n"
+              << "  --times        czasy odjazdu od początku pierwszego dnia rozkładu, godziny od 24 wzwyż – kolejne dni\n"
+              << "                 (domyślnie 08:00)\n"
+              << "  --threads      liczba wątków (domyślnie liczba rdzeni)\n"
+              << "Z tymi samymi --data, --calendar, --walk-radius i --min-change czasy są równe kosztom tras lista1\n"
+              << "(Dijkstra, kryterium czasowe).\n";
+}
+
+// "HH:MM" albo "HH:MM:SS" w sekundach
+long parseClock(const std::string &text) {
+    std::stringstream parts(text);
+    std::string part;
+    long seconds = 0;
+    int fields = 0;
+    while (std::getline(parts, part, ':')) {
+        seconds = seconds * 60 + std::stol(part);
+        ++fields;
+    }
+    if (fields < 2 || fields > 3) {
+        throw std::invalid_argument(text);
+    }
+    return fields == 2 ? seconds * 60 : seconds;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string dataPath = "../data/connection_graph.csv";
+    std::string outPath;
+    std::string calendarPath;
+    footpath_options walking;
+    std::vector<long> clocks;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--data" && i + 1 < argc) {
+                dataPath = argv[++i];
+            } else if (arg == "--out" && i + 1 < argc) {
+                outPath = argv[++i];
+            } else if (arg == "--calendar" && i + 1 < argc) {
+                calendarPath = argv[++i];
+            } else if (arg == "--walk-radius" && i + 1 < argc) {
+                walking.radius_m = std::max(0.0, std::stod(argv[++i]));
+            } else if (arg == "--min-change" && i + 1 < argc) {
+                walking.min_change = std::chrono::seconds(std::max(0L, std::stol(argv[++i])));
+            } else if (arg == "--times" && i + 1 < argc) {
+                std::stringstream times(argv[++i]);
+                std::string time;
+                while (std::getline(times, time, ',')) {
+                    if (!time.empty()) clocks.push_back(parseClock(time));
+                }
+            } else if (arg == "--threads" && i + 1 < argc) {
+                threads = static_cast<unsigned>(std::stoul(argv[++i]));
+                if (threads == 0) throw std::invalid_argument(argv[i]);
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } catch (const std::exception &) {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (outPath.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (clocks.empty()) {
+        clocks.push_back(8 * 3600);
+    }
+
+    std::vector<edge> edges;
+    {
+        std::vector<std::string> data = readCSVFile(dataPath);
+        if (data.empty()) {
+            std::cerr << "Błąd wczytywania danych z pliku CSV." << std::endl;
+            return 1;
+        }
+        data.erase(data.begin()); // Usuwamy nagłówek
+
+        try {
+            graph_generator generator(std::move(data));
+            edges = generator.release_graphs();
+        } catch (const std::exception &e) {
+            std::cerr << "Błąd wczytywania danych z pliku CSV: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    service_calendar calendar;
+    if (!calendarPath.empty()) {
+        std::ifstream calendarFile(calendarPath);
+        std::string error;
+        if (!calendarFile.is_open() || !service_calendar::parse(calendarFile, calendar, error)) {
+            std::cerr << "Błąd wczytywania kalendarza " << calendarPath << ": "
+                      << (error.empty() ? "nie można otworzyć pliku" : error) << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<const timetable> loaded;
+    try {
+        loaded = std::make_unique<const timetable>(std::move(edges), calendar, walking);
+    } catch (const std::runtime_error &e) {
+        std::cerr << "Błąd budowy rozkładu: " << e.what() << std::endl;
+        return 1;
+    }
+    const timetable &tt = *loaded;
+
+    std::vector<std::chrono::system_clock::time_point> departures;
+    for (long clock : clocks) {
+        departures.push_back(tt.day_start(0) + std::chrono::seconds(clock));
+    }
+    std::cerr << "Rozkład: " << tt.stop_count() << " przystanków, " << tt.connection_count() << " połączeń, "
+              << tt.walk_count() << " przejść pieszych; "
+              << departures.size() << " × " << tt.stop_count() << " przeszukiwań na " << threads << " wątkach"
+              << std::endl;
+
+    matrix_stats stats;
+    std::string error;
+    if (!write_travel_matrix(tt, departures, threads, outPath, stats, error)) {
+        std::cerr << "Błąd: " << error << std::endl;
+        return 1;
+    }
+    const double pairs = static_cast<double>(stats.rows) * static_cast<double>(tt.stop_count());
+    std::cerr << "Zapisano " << outPath << ": " << stats.bytes / 1024 << " KiB, " << stats.rows << " wierszy w "
+              << stats.elapsed_ms << " ms (" << stats.rows * 1000.0 / std::max(stats.elapsed_ms, 1e-3)
+              << " wierszy/s), pary z trasą " << (pairs > 0 ? stats.reachable * 100.0 / pairs : 0.0) << "%"
+              << std::endl;
+    return 0;
+}
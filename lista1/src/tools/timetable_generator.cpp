@@ -0,0 +1,231 @@
+#include "timetable_generator.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double EARTH_RADIUS_KM = 6371.0;
+constexpr double KM_PER_DEGREE = 111.32;
+// Kandydaci na kolejny przystanek trasy – najbliższy z nich przedłuża trasę
+constexpr int CANDIDATES = 8;
+
+struct stop_point {
+    double lat;
+    double lon;
+    std::string name;
+    std::string coords; ///< "lat,lon" sformatowane raz, z 8 miejscami po przecinku jak w danych źródłowych
+};
+
+double distance_km(const stop_point &a, const stop_point &b) {
+    const double to_rad = PI / 180.0;
+    const double dlat = (b.lat - a.lat) * to_rad;
+    const double dlon = (b.lon - a.lon) * to_rad;
+    const double h = std::sin(dlat / 2) * std::sin(dlat / 2) +
+                     std::cos(a.lat * to_rad) * std::cos(b.lat * to_rad) * std::sin(dlon / 2) * std::sin(dlon / 2);
+    return 2.0 * EARTH_RADIUS_KM * std::asin(std::sqrt(h));
+}
+
+// Liczby losowe niezależne od implementacji rozkładów biblioteki standardowej
+class random_source {
+public:
+    explicit random_source(uint64_t seed) : rng(seed) {}
+
+    double unit() { return static_cast<double>(rng() >> 11) * 0x1.0p-53; }
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(rng() % n); }
+    uint32_t between(uint32_t lo, uint32_t hi) { return lo + below(hi - lo + 1); }
+
+private:
+    std::mt19937_64 rng;
+};
+
+// Bufor wierszy zapisywany do pliku blokami
+class row_writer {
+public:
+    explicit row_writer(std::FILE *out) : out(out) {}
+    ~row_writer() { flush(); }
+
+    void text(const std::string &s) {
+        reserve(s.size());
+        std::copy(s.begin(), s.end(), buffer.data() + used);
+        used += s.size();
+    }
+    void put(char c) {
+        reserve(1);
+        buffer[used++] = c;
+    }
+    void number(uint64_t value) {
+        reserve(20);
+        used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data();
+    }
+    // HH:MM:SS, godziny od 24 wzwyż dla kursów po północy
+    void clock(uint32_t seconds) {
+        const uint32_t hours = seconds / 3600;
+        if (hours < 10) put('0');
+        number(hours);
+        two_digits(seconds / 60 % 60);
+        two_digits(seconds % 60);
+    }
+    void flush() {
+        if (used > 0) {
+            written += std::fwrite(buffer.data(), 1, used, out);
+            used = 0;
+        }
+    }
+
+    uint64_t written = 0;
+
+private:
+    void two_digits(uint32_t value) {
+        reserve(3);
+        buffer[used++] = ':';
+        buffer[used++] = static_cast<char>('0' + value / 10);
+        buffer[used++] = static_cast<char>('0' + value % 10);
+    }
+    void reserve(size_t n) {
+        if (used + n > buffer.size()) flush();
+    }
+
+    std::FILE *out;
+    std::vector<char> buffer = std::vector<char>(size_t(1) << 20);
+    size_t used = 0;
+};
+
+std::vector<stop_point> place_stops(const generator_options &options, random_source &random) {
+    std::vector<stop_point> stops(options.stops);
+    const double lon_scale = std::cos(options.center_lat * PI / 180.0);
+    char buf[64];
+    for (uint32_t s = 0; s < options.stops; ++s) {
+        // Równomiernie w kole: promień z pierwiastka, kąt jednostajnie
+        const double r = options.radius_km * std::sqrt(random.unit());
+        const double angle = 2.0 * PI * random.unit();
+        stop_point &stop = stops[s];
+        stop.lat = options.center_lat + r * std::sin(angle) / KM_PER_DEGREE;
+        stop.lon = options.center_lon + r * std::cos(angle) / (KM_PER_DEGREE * lon_scale);
+        stop.name = "Przystanek " + std::to_string(s + 1);
+        std::snprintf(buf, sizeof(buf), "%.8f,%.8f", stop.lat, stop.lon);
+        stop.coords = buf;
+    }
+    return stops;
+}
+
+// Trasa linii: różne przystanki, kolejny – najbliższy z CANDIDATES losowych nieodwiedzonych
+std::vector<uint32_t> route_pattern(const generator_options &options, const std::vector<stop_point> &stops,
+                                    std::vector<uint32_t> &visited, uint32_t line, random_source &random) {
+    std::vector<uint32_t> route;
+    route.reserve(options.stops_per_line);
+    uint32_t current = random.below(options.stops);
+    visited[current] = line + 1;
+    route.push_back(current);
+    while (route.size() < options.stops_per_line) {
+        uint32_t best = options.stops;
+        double best_distance = 0.0;
+        for (int c = 0; c < CANDIDATES || best == options.stops; ++c) {
+            const uint32_t candidate = random.below(options.stops);
+            if (visited[candidate] == line + 1) continue;
+            const double d = distance_km(stops[current], stops[candidate]);
+            if (best == options.stops || d < best_distance) {
+                best = candidate;
+                best_distance = d;
+            }
+        }
+        visited[best] = line + 1;
+        route.push_back(best);
+        current = best;
+    }
+    return route;
+}
+
+} // namespace
+
+bool validate_generator_options(const generator_options &options, std::string &error) {
+    if (options.stops < 2) {
+        error = "potrzebne są co najmniej 2 przystanki";
+    } else if (options.lines < 1 || options.trips_per_line < 1) {
+        error = "liczba linii i kursów musi być dodatnia";
+    } else if (options.stops_per_line < 2 || options.stops_per_line > options.stops) {
+        error = "liczba przystanków na trasie musi należeć do [2, liczba przystanków]";
+    } else if (options.headway_min < 1 || options.headway_min > options.headway_max) {
+        error = "odstęp między kursami: 1 <= min <= max";
+    } else if (!(options.speed_kmh > 0.0) || !(options.radius_km > 0.0)) {
+        error = "prędkość i promień obszaru muszą być dodatnie";
+    } else if (std::abs(options.center_lat) > 85.0 || std::abs(options.center_lon) > 180.0) {
+        error = "niepoprawny środek obszaru";
+    } else if (options.company.empty() || options.company.find_first_of(",\n") != std::string::npos) {
+        error = "nazwa przewoźnika nie może być pusta ani zawierać przecinka";
+    } else {
+        return true;
+    }
+    return false;
+}
+
+uint64_t expected_connections(const generator_options &options) {
+    return uint64_t(options.lines) * 2 * options.trips_per_line * (options.stops_per_line - 1);
+}
+
+generator_stats generate_timetable(const generator_options &options, std::FILE *out) {
+    random_source random(options.seed);
+    const std::vector<stop_point> stops = place_stops(options, random);
+    std::vector<uint32_t> visited(options.stops, 0);
+
+    generator_stats stats;
+    row_writer writer(out);
+    writer.text(",company,line,departure_time,arrival_time,start_stop,end_stop,"
+                "start_stop_lat,start_stop_lon,end_stop_lat,end_stop_lon\n");
+
+    std::vector<uint32_t> travel;
+    for (uint32_t line = 0; line < options.lines; ++line) {
+        std::vector<uint32_t> route = route_pattern(options, stops, visited, line, random);
+        const std::string name = std::to_string(line + 1);
+        const uint32_t headway = random.between(options.headway_min, options.headway_max) * 60;
+
+        for (int direction = 0; direction < 2; ++direction) {
+            if (direction == 1) {
+                std::reverse(route.begin(), route.end());
+            }
+            // Czasy przejazdu między kolejnymi przystankami – co najmniej minuta
+            travel.assign(route.size() - 1, 0);
+            for (size_t i = 0; i + 1 < route.size(); ++i) {
+                const double seconds = distance_km(stops[route[i]], stops[route[i + 1]]) / options.speed_kmh * 3600.0;
+                travel[i] = std::max<uint32_t>(60, static_cast<uint32_t>(std::lround(seconds)));
+            }
+            const uint32_t offset = random.below(headway);
+
+            for (uint32_t trip = 0; trip < options.trips_per_line; ++trip) {
+                uint32_t time = options.first_departure + offset + trip * headway;
+                for (size_t i = 0; i + 1 < route.size(); ++i) {
+                    const stop_point &from = stops[route[i]];
+                    const stop_point &to = stops[route[i + 1]];
+                    const uint32_t arrival = time + travel[i];
+                    writer.number(stats.connections++);
+                    writer.put(',');
+                    writer.text(options.company);
+                    writer.put(',');
+                    writer.text(name);
+                    writer.put(',');
+                    writer.clock(time);
+                    writer.put(',');
+                    writer.clock(arrival);
+                    writer.put(',');
+                    writer.text(from.name);
+                    writer.put(',');
+                    writer.text(to.name);
+                    writer.put(',');
+                    writer.text(from.coords);
+                    writer.put(',');
+                    writer.text(to.coords);
+                    writer.put('\n');
+                    stats.last_arrival = std::max(stats.last_arrival, arrival);
+                    time = arrival + options.dwell;
+                }
+            }
+        }
+    }
+    writer.flush();
+    stats.bytes = writer.written;
+    return stats;
+}
@@ -0,0 +1,76 @@
+#ifndef TIMETABLE_GENERATOR_H
+#define TIMETABLE_GENERATOR_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * @file timetable_generator.h
+ * @brief Syntetyczne rozkłady w formacie pliku connection_graph.csv (cel lista1_gen).
+ */
+
+/**
+ * @struct generator_options
+ * @brief Parametry generowanego rozkładu.
+ */
+struct generator_options {
+    uint32_t stops = 500;             ///< Liczba przystanków
+    uint32_t lines = 60;              ///< Liczba linii (każda kursuje w obu kierunkach)
+    uint32_t stops_per_line = 20;     ///< Przystanki na trasie linii
+    uint32_t trips_per_line = 60;     ///< Kursy linii w każdym kierunku
+    uint32_t headway_min = 5;         ///< Najkrótszy odstęp między kursami linii w minutach
+    uint32_t headway_max = 20;        ///< Najdłuższy odstęp (odstęp linii losowany z [min, max])
+    uint32_t first_departure = 5 * 3600; ///< Pierwszy odjazd w sekundach od północy
+    uint32_t dwell = 0;               ///< Postój na przystanku pośrednim w sekundach
+    double speed_kmh = 25.0;          ///< Średnia prędkość przejazdu
+    double center_lat = 51.11;        ///< Środek obszaru (domyślnie Wrocław)
+    double center_lon = 17.03;
+    double radius_km = 10.0;          ///< Promień obszaru, w którym losowane są przystanki
+    uint64_t seed = 1;                ///< Ziarno – ten sam seed daje ten sam plik
+    std::string company = "MPK";
+};
+
+/**
+ * @struct generator_stats
+ * @brief Podsumowanie wygenerowanego rozkładu.
+ */
+struct generator_stats {
+    uint64_t connections = 0;
+    uint64_t bytes = 0;
+    uint32_t last_arrival = 0; ///< Najpóźniejszy przyjazd w sekundach od północy pierwszego dnia
+};
+
+/**
+ * @brief Sprawdza spójność parametrów.
+ * @param error Opis błędu.
+ * @return true, jeśli z parametrów da się zbudować rozkład.
+ */
+bool validate_generator_options(const generator_options &options, std::string &error);
+
+/// Liczba połączeń rozkładu o podanych parametrach (bez generowania).
+uint64_t expected_connections(const generator_options &options);
+
+/**
+ * @brief Generuje rozkład i zapisuje go strumieniowo jako CSV z nagłówkiem i 11 kolumnami
+ *        (id,company,line,departure_time,arrival_time,start_stop,end_stop,start_stop_lat,start_stop_lon,
+ *        end_stop_lat,end_stop_lon) – tak jak oczekuje graph_generator::generate_graph.
+ *
+ * Przystanki ("Przystanek N") losowane są równomiernie w kole o promieniu radius_km. Trasa linii
+ * to ciąg różnych przystanków, w którym kolejny jest najbliższym z kilku wylosowanych kandydatów,
+ * więc linie przebiegają przez sąsiednie przystanki. Kursy w kierunku powrotnym jadą tą samą trasą
+ * w odwrotnej kolejności. Czas przejazdu wynika z odległości i prędkości (co najmniej minuta),
+ * a kursy linii odjeżdżają co jej odstęp od losowego przesunięcia po first_departure; godziny
+ * od 24 wzwyż oznaczają kursy po północy.
+ *
+ * Pamięć zależy tylko od liczby przystanków i linii, a wiersze formatowane są bez alokacji do
+ * bufora zapisywanego blokami – rozkłady z dziesiątkami milionów połączeń powstają w czasie
+ * ograniczonym zapisem na dysk.
+ *
+ * @param options Parametry (poprawne według validate_generator_options).
+ * @param out Plik wyjściowy.
+ * @return generator_stats Liczba połączeń, bajtów i najpóźniejszy przyjazd.
+ */
+generator_stats generate_timetable(const generator_options &options, std::FILE *out);
+
+#endif // TIMETABLE_GENERATOR_H
@@ -0,0 +1,98 @@
+#include "travel_matrix.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "../algorithms/dijkstra.h"
+#include "../algorithms_utils/query_workspace.h"
+
+namespace {
+
+template<typename T>
+void write_value(std::ofstream &out, const T &value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+} // namespace
+
+bool write_travel_matrix(const timetable &tt,
+                         const std::vector<std::chrono::system_clock::time_point> &departures,
+                         unsigned threads,
+                         const std::string &path,
+                         matrix_stats &stats,
+                         std::string &error) {
+    const auto start = std::chrono::steady_clock::now();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "nie można zapisać pliku: " + path;
+        return false;
+    }
+
+    const uint32_t stops = static_cast<uint32_t>(tt.stop_count());
+    const uint32_t times = static_cast<uint32_t>(departures.size());
+    uint64_t header = 4 * sizeof(uint32_t) + sizeof(uint64_t) + times * sizeof(int64_t);
+    for (uint32_t s = 0; s < stops; ++s) {
+        header += sizeof(uint32_t) + tt.stop_name(s).size();
+    }
+    const uint64_t offset = (header + 63) / 64 * 64;
+
+    write_value(out, TRAVEL_MATRIX_MAGIC);
+    write_value(out, TRAVEL_MATRIX_VERSION);
+    write_value(out, stops);
+    write_value(out, times);
+    write_value(out, offset);
+    for (const auto &departure : departures) {
+        write_value(out, static_cast<int64_t>(
+                             std::chrono::duration_cast<std::chrono::seconds>(departure - tt.day_start(0)).count()));
+    }
+    for (uint32_t s = 0; s < stops; ++s) {
+        const std::string &name = tt.stop_name(s);
+        write_value(out, static_cast<uint32_t>(name.size()));
+        out.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+
+    // Wiersz (czas odjazdu, przystanek początkowy) – numer z licznika, miejsce w pliku wynika z numeru
+    const uint64_t rows = static_cast<uint64_t>(times) * stops;
+    const uint64_t row_bytes = static_cast<uint64_t>(stops) * sizeof(int32_t);
+    std::atomic<uint64_t> next{0};
+    std::atomic<uint64_t> reachable{0};
+    std::mutex write_mutex;
+    auto worker = [&] {
+        query_workspace ws;
+        std::vector<int32_t> row;
+        uint64_t found = 0;
+        for (uint64_t r = next++; r < rows; r = next++) {
+            ws.reset_memory();
+            dijkstra_time_all(tt, ws, static_cast<uint32_t>(r % stops), departures[r / stops], row);
+            found += static_cast<uint64_t>(std::count_if(row.begin(), row.end(), [](int32_t t) { return t >= 0; }));
+            std::lock_guard<std::mutex> lock(write_mutex);
+            out.seekp(static_cast<std::streamoff>(offset + r * row_bytes));
+            out.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(row_bytes));
+        }
+        reachable += found;
+    };
+
+    const unsigned count = std::max(1u, threads);
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < count; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    out.close();
+    if (!out) {
+        error = "błąd zapisu pliku: " + path;
+        return false;
+    }
+    stats.rows = rows;
+    stats.reachable = reachable.load();
+    stats.bytes = offset + rows * row_bytes;
+    stats.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
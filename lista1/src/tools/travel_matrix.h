@@ -0,0 +1,67 @@
+#ifndef TRAVEL_MATRIX_H
+#define TRAVEL_MATRIX_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../graph/timetable.h"
+
+/**
+ * @file travel_matrix.h
+ * @brief Macierze czasów przejazdu między wszystkimi parami przystanków (cel lista1_matrix).
+ *
+ * Format pliku (liczby w porządku bajtów maszyny, jak migawka Trip-Based):
+ *  - nagłówek: magic "LTM1" (uint32), wersja (uint32), liczba przystanków N (uint32), liczba czasów
+ *    odjazdu T (uint32), przesunięcie macierzy od początku pliku (uint64),
+ *  - T czasów odjazdu w sekundach od początku pierwszego dnia rozkładu (int64),
+ *  - N nazw przystanków: długość (uint32) i bajty UTF-8,
+ *  - od przesunięcia (wyrównanego do 64 B): T macierzy N×N czasów przejazdu w sekundach (int32, -1 – brak
+ *    trasy), wierszami według przystanku początkowego.
+ *
+ * Czas z przystanku `from` do `to` dla odjazdu `t` leży pod przesunięciem
+ * offset + ((t · N + from) · N + to) · 4, więc plik można odwzorować w pamięci (mmap, numpy.memmap)
+ * i czytać wybrane wiersze bez wczytywania całości.
+ *
+ * Macierz opisuje rozkład `tt` z jego kalendarzem kursowania i przejściami pieszymi – lista1_matrix
+ * przyjmuje te same opcje --calendar, --walk-radius i --min-change co lista1.
+ */
+
+constexpr uint32_t TRAVEL_MATRIX_MAGIC = 0x314d544c; // "LTM1"
+constexpr uint32_t TRAVEL_MATRIX_VERSION = 1;
+
+/**
+ * @struct matrix_stats
+ * @brief Podsumowanie obliczenia macierzy.
+ */
+struct matrix_stats {
+    uint64_t rows = 0;        ///< Wykonane przeszukiwania jeden-do-wszystkich (T · N)
+    uint64_t reachable = 0;   ///< Pary z trasą (także przystanek sam do siebie)
+    uint64_t bytes = 0;       ///< Rozmiar pliku
+    double elapsed_ms = 0.0;
+};
+
+/**
+ * @brief Oblicza macierze czasów przejazdu i zapisuje je do pliku.
+ *
+ * Dla każdego czasu odjazdu i przystanku początkowego wykonywane jest jedno przeszukiwanie
+ * jeden-do-wszystkich (dijkstra_time_all). Wątki pobierają kolejne wiersze ze wspólnego licznika,
+ * każdy z własną przestrzenią roboczą, a gotowy wiersz od razu zapisują na jego miejscu w pliku –
+ * w pamięci jest co najwyżej jeden wiersz na wątek.
+ *
+ * @param tt Rozkład jazdy.
+ * @param departures Czasy odjazdu.
+ * @param threads Liczba wątków (co najmniej 1).
+ * @param path Plik wynikowy.
+ * @param stats Podsumowanie.
+ * @param error Opis błędu zapisu.
+ * @return true, jeśli plik zapisano.
+ */
+bool write_travel_matrix(const timetable &tt,
+                         const std::vector<std::chrono::system_clock::time_point> &departures,
+                         unsigned threads,
+                         const std::string &path,
+                         matrix_stats &stats,
+                         std::string &error);
+
+#endif // TRAVEL_MATRIX_H
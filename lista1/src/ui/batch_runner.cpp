@@ -0,0 +1,371 @@
+#include "batch_runner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+#include "../algorithms_utils/trace.h"
+#include "../graph/graph_generator.h"
+#include "../io_handling/json_lite.h"
+#include "result_cache.h"
+
+namespace {
+
+std::string trim(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+bool parse_algorithm(const std::string &text, int &algorithm) {
+    static const std::unordered_map<std::string, int> names = {
+        {"dijkstra", 1}, {"astar", 2}, {"a*", 2}, {"tabu", 3}, {"knox", 4},
+        {"trip_based", 5}, {"tb", 5}, {"transfer_patterns", 6}, {"tp", 6},
+    };
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    auto it = names.find(lower);
+    if (it != names.end()) {
+        algorithm = it->second;
+        return true;
+    }
+    try {
+        algorithm = std::stoi(text);
+        return true;
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+bool parse_clock(const std::string &text, std::chrono::system_clock::time_point &time, std::string &error) {
+    try {
+        time = parse_time(text);
+        return true;
+    } catch (const std::exception &) {
+        error = "niepoprawny czas: " + text;
+        return false;
+    }
+}
+
+std::tm local_time(const std::chrono::system_clock::time_point &tp) {
+    // Wersje wielowątkowo bezpieczne – wyniki formatuje także serwer zapytań
+    std::time_t t = std::chrono::system_clock::to_time_t(tp);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &t);
+#else
+    localtime_r(&t, &local);
+#endif
+    return local;
+}
+
+// Godzina, a jeśli przypada innego dnia niż `reference` (czas zapytania) – data i godzina
+std::string format_clock(const std::chrono::system_clock::time_point &tp,
+                         const std::chrono::system_clock::time_point &reference) {
+    const std::tm local = local_time(tp);
+    const std::tm day = local_time(reference);
+    const bool same_day = local.tm_year == day.tm_year && local.tm_yday == day.tm_yday;
+    char buf[32];
+    std::strftime(buf, sizeof(buf), same_day ? "%T" : "%F %T", &local);
+    return buf;
+}
+
+bool parse_json_query(const std::string &line, route_query &query, std::string &id, std::string &error) {
+    std::unordered_map<std::string, json_value> fields;
+    if (!parse_flat_json(line, fields, error)) return false;
+
+    auto text = [&fields](const char *key) -> const std::string * {
+        auto it = fields.find(key);
+        return it == fields.end() || it->second.is_array ? nullptr : &it->second.text;
+    };
+    if (auto it = fields.find("id"); it != fields.end()) {
+        // Identyfikator trafia do wyniku bez zmian – tylko napis (ponownie zapisany) albo liczba
+        if (it->second.is_string) {
+            id = json_quote(it->second.text);
+        } else if (!it->second.is_array && is_json_number(it->second.text)) {
+            id = it->second.text;
+        } else {
+            error = "pole id musi być liczbą albo napisem";
+            return false;
+        }
+    }
+    const std::string *start = text("start");
+    const std::string *end = text("end");
+    const std::string *time = text("time");
+    if (!start || !end || !time) {
+        error = "wymagane pola: start, end, time";
+        return false;
+    }
+    query.start_stop = *start;
+    query.end_stop = *end;
+    if (!parse_clock(*time, query.start_time, error)) return false;
+    if (const std::string *crit = text("criterion"); crit && !crit->empty()) {
+        query.optimization_criteria = (*crit)[0];
+    }
+    if (const std::string *algo = text("algorithm"); algo && !parse_algorithm(*algo, query.algorithm_choice)) {
+        error = "nieznany algorytm: " + *algo;
+        return false;
+    }
+    for (const char *key : {"required", "required_stops"}) {
+        if (auto it = fields.find(key); it != fields.end()) {
+            query.required_stops = it->second.items;
+        }
+    }
+    return true;
+}
+
+bool parse_csv_query(const std::string &line, route_query &query, std::string &error) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        fields.push_back(trim(token));
+    }
+    if (fields.size() < 3) {
+        error = "wymagane kolumny: start,end,time";
+        return false;
+    }
+    query.start_stop = fields[0];
+    query.end_stop = fields[1];
+    if (!parse_clock(fields[2], query.start_time, error)) return false;
+    if (fields.size() > 3 && !fields[3].empty()) {
+        query.optimization_criteria = fields[3][0];
+    }
+    if (fields.size() > 4 && !fields[4].empty() && !parse_algorithm(fields[4], query.algorithm_choice)) {
+        error = "nieznany algorytm: " + fields[4];
+        return false;
+    }
+    if (fields.size() > 5) {
+        std::stringstream stops(fields[5]);
+        while (std::getline(stops, token, ';')) {
+            if (!trim(token).empty()) query.required_stops.push_back(trim(token));
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool is_batch_header(const std::string &line) {
+    std::stringstream ss(line);
+    std::string field;
+    for (const char *name : {"start", "end", "time"}) {
+        if (!std::getline(ss, field, ',') || trim(field) != name) return false;
+    }
+    return true;
+}
+
+bool parse_batch_query(const std::string &line, route_query &query, std::string &id, std::string &error) {
+    query = route_query{};
+    id.clear();
+    const std::string trimmed = trim(line);
+    if (!trimmed.empty() && trimmed[0] == '{') {
+        return parse_json_query(trimmed, query, id, error);
+    }
+    return parse_csv_query(trimmed, query, error);
+}
+
+std::string format_batch_result(const std::string &id,
+                                const route_query &query,
+                                const std::pair<std::vector<edge>, double> &result,
+                                double elapsed_us,
+                                const search_stats *stats) {
+    std::ostringstream out;
+    const bool found = !result.first.empty() || result.second == 0.0;
+    out << "{\"id\":" << id
+        << ",\"start\":" << json_quote(query.start_stop)
+        << ",\"end\":" << json_quote(query.end_stop)
+        << ",\"criterion\":\"" << query.optimization_criteria << "\""
+        << ",\"algorithm\":" << query.algorithm_choice
+        << ",\"found\":" << (found ? "true" : "false")
+        << ",\"cost\":" << result.second
+        << ",\"legs\":" << result.first.size()
+        << ",\"route\":[";
+    for (size_t i = 0; i < result.first.size(); ++i) {
+        const edge &e = result.first[i];
+        out << (i ? "," : "") << "[" << json_quote(e.getLine()) << "," << json_quote(e.getStartStop()) << ","
+            << json_quote(e.getEndStop()) << ",\"" << format_clock(e.getDepartureTime(), query.start_time)
+            << "\",\"" << format_clock(e.getArrivalTime(), query.start_time) << "\"]";
+    }
+    out << "]";
+    if (stats) {
+        out << ",\"stats\":{\"labels_pushed\":" << stats->labels_pushed
+            << ",\"labels_popped\":" << stats->labels_popped
+            << ",\"edges_scanned\":" << stats->edges_scanned
+            << ",\"edges_relaxed\":" << stats->edges_relaxed
+            << ",\"heuristic_evaluations\":" << stats->heuristic_evaluations
+            << ",\"dominated_labels\":" << stats->dominated_labels
+            << ",\"peak_queue\":" << stats->peak_queue
+            << ",\"bytes_allocated\":" << stats->bytes_allocated << "}";
+    }
+    out << ",\"time_us\":" << static_cast<long long>(elapsed_us) << "}";
+    return out.str();
+}
+
+bool resolve_query_stops(const query_executor &executor, route_query &query, std::string &error) {
+    for (std::string *stop : {&query.start_stop, &query.end_stop}) {
+        if (executor.has_stop(*stop)) continue;
+        std::string resolved = executor.resolve_stop(*stop);
+        if (resolved.empty()) {
+            error = "nieznany przystanek: " + *stop;
+            const std::vector<std::string> similar = executor.suggest_stops(*stop, 3);
+            for (size_t i = 0; i < similar.size(); ++i) {
+                error += (i == 0 ? " (podobne: " : ", ") + similar[i];
+            }
+            if (!similar.empty()) error += ")";
+            return false;
+        }
+        *stop = std::move(resolved);
+    }
+    for (std::string &stop : query.required_stops) {
+        std::string resolved = executor.resolve_stop(stop);
+        if (!resolved.empty()) stop = std::move(resolved);
+    }
+    return true;
+}
+
+std::string format_batch_error(const std::string &id, const std::string &error) {
+    return "{\"id\":" + id + ",\"error\":" + json_quote(error) + "}";
+}
+
+namespace {
+
+// Zapytanie okna wsadowego wraz z wynikiem
+struct batch_entry {
+    size_t line = 0;
+    std::string id;
+    route_query query;
+    std::string error; ///< Niepusty – zapytanie błędne
+    std::pair<std::vector<edge>, double> result;
+    double elapsed_us = 0.0;
+    search_stats stats;
+};
+
+} // namespace
+
+int run_batch(query_executor &executor, std::istream &in, std::ostream &out, size_t group_window) {
+    std::string line;
+    size_t count = 0;
+    int errors = 0;
+    double total_us = 0.0;
+    search_stats totals;
+    size_t groups = 0, grouped = 0;
+    const size_t window = std::max<size_t>(group_window, 1);
+    std::vector<batch_entry> entries;
+    bool first = true;
+
+    while (in) {
+        // Okno kolejnych zapytań – przy window == 1 każde wykonywane jest zaraz po wczytaniu
+        entries.clear();
+        while (entries.size() < window && std::getline(in, line)) {
+            const std::string trimmed = trim(line);
+            if (trimmed.empty() || trimmed[0] == '#') {
+                continue;
+            }
+            // Nagłówek CSV tylko jako pierwsza linia – dalej "start,..." to zapytanie z przystankiem "start"
+            if (std::exchange(first, false) && is_batch_header(trimmed)) {
+                continue;
+            }
+            batch_entry &entry = entries.emplace_back();
+            entry.line = ++count;
+            bool ok = parse_batch_query(trimmed, entry.query, entry.id, entry.error);
+            if (entry.id.empty()) {
+                entry.id = std::to_string(count);
+            }
+            if (ok) {
+                ok = resolve_query_stops(executor, entry.query, entry.error);
+            }
+            if (!ok && entry.error.empty()) {
+                entry.error = "niepoprawne zapytanie";
+            }
+        }
+
+        // Zapytania o tym samym początku i czasie – jedno przeszukiwanie jeden-do-wielu na grupę
+        std::map<std::pair<std::string, std::chrono::system_clock::time_point>, std::vector<size_t>> shared;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (window > 1 && entries[i].error.empty() && query_executor::groupable(entries[i].query)) {
+                shared[{entries[i].query.start_stop, entries[i].query.start_time}].push_back(i);
+            }
+        }
+        std::vector<bool> done(entries.size(), false);
+        for (const auto &[key, members] : shared) {
+            if (members.size() < 2) continue;
+            TRACE_SCOPE("batch_group", "queries", static_cast<int64_t>(members.size()));
+            std::vector<route_query> queries;
+            for (size_t i : members) {
+                queries.push_back(entries[i].query);
+            }
+            search_stats stats;
+            auto start = std::chrono::steady_clock::now();
+            auto results = executor.execute_group(queries, search_stats_enabled ? &stats : nullptr);
+            double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            // Czas przeszukiwania dzielony po równo, liczniki przypisane pierwszemu zapytaniu grupy
+            for (size_t k = 0; k < members.size(); ++k) {
+                batch_entry &entry = entries[members[k]];
+                entry.result = std::move(results[k]);
+                entry.elapsed_us = elapsed_us / static_cast<double>(members.size());
+                done[members[k]] = true;
+            }
+            entries[members.front()].stats = stats;
+            ++groups;
+            grouped += members.size();
+        }
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            batch_entry &entry = entries[i];
+            if (!entry.error.empty()) {
+                ++errors;
+                out << format_batch_error(entry.id, entry.error) << "\n" << std::flush;
+                continue;
+            }
+            if (!done[i]) {
+                TRACE_SCOPE("batch_query", "line", static_cast<int64_t>(entry.line));
+                // Liczniki tylko w kompilacji z LISTA1_SEARCH_STATS – inaczej wynik ma dotychczasową postać
+                auto start = std::chrono::steady_clock::now();
+                entry.result = executor.execute(entry.query, search_stats_enabled ? &entry.stats : nullptr);
+                entry.elapsed_us =
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            }
+            total_us += entry.elapsed_us;
+            totals += entry.stats;
+
+            TRACE_SCOPE("print");
+            out << format_batch_result(entry.id, entry.query, entry.result, entry.elapsed_us,
+                                       search_stats_enabled ? &entry.stats : nullptr)
+                << "\n" << std::flush;
+        }
+    }
+
+    std::cerr << "Zapytania: " << count << ", błędy: " << errors
+              << ", łączny czas wykonania: " << total_us / 1000.0 << " ms" << std::endl;
+    const allocation_totals allocations = executor.allocations();
+    if (allocations.queries > 0) {
+        std::cerr << "Pamięć zapytań: " << allocations.memory.allocations << " przydziałów z areny ("
+                  << allocations.memory.bytes / 1024 << " KiB), " << allocations.memory.upstream_allocations
+                  << " z globalnego alokatora (" << allocations.memory.upstream_bytes / 1024 << " KiB) na "
+                  << allocations.queries << " wyszukiwań" << std::endl;
+    }
+    if (search_stats_enabled) {
+        std::cerr << "Przeszukiwanie: " << totals.labels_pushed << " etykiet w kolejce (" << totals.labels_popped
+                  << " zdjętych, " << totals.dominated_labels << " zdominowanych), " << totals.edges_scanned
+                  << " przejrzanych połączeń (" << totals.edges_relaxed << " poprawiających), "
+                  << totals.heuristic_evaluations << " obliczeń heurystyki, największa kolejka " << totals.peak_queue
+                  << std::endl;
+    }
+    if (groups > 0) {
+        std::cerr << "Grupowanie: " << grouped << " zapytań w " << groups
+                  << " przeszukiwaniach jeden-do-wielu (wspólny początek i czas)" << std::endl;
+    }
+    if (const result_cache *cache = executor.cache()) {
+        const cache_stats stats = cache->stats();
+        std::cerr << "Pamięć podręczna: trafienia " << stats.hits << ", chybienia " << stats.misses + stats.stale
+                  << " (nieaktualne " << stats.stale << "), skuteczność " << stats.hit_rate() * 100.0 << "%, "
+                  << stats.entries << " wpisów, " << stats.bytes / 1024 << " KiB" << std::endl;
+    }
+    return errors;
+}
@@ -0,0 +1,78 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <iostream>
+#include <string>
+#include "query_executor.h"
+
+/**
+ * @brief Parsuje jedną linię zapytania wsadowego (JSON Lines albo CSV).
+ *
+ * Format JSON: {"id": ..., "start": "...", "end": "...", "time": "HH:MM:SS", "criterion": "t|p|o",
+ * "algorithm": 1-6 lub nazwa (dijkstra, astar, tabu, knox, trip_based, transfer_patterns),
+ * "required": ["...", ...]}. Czas można poprzedzić datą ("RRRR-MM-DD HH:MM:SS"), domyślnie – dzisiaj.
+ * Format CSV: start,end,time[,criterion[,algorithm[,przystanki pośrednie oddzielone ';']]].
+ *
+ * @param line Linia wejścia.
+ * @param query Wypełniane zapytanie.
+ * @param id Identyfikator zapytania z pola "id" jako literał JSON (pusty, jeśli nie podano); wartość inna niż
+ *           napis lub liczba jest błędem.
+ * @param error Opis błędu.
+ * @return true, jeśli linię sparsowano poprawnie.
+ */
+bool parse_batch_query(const std::string &line, route_query &query, std::string &id, std::string &error);
+
+/// Czy linia jest nagłówkiem CSV trybu wsadowego (pierwsze kolumny: start,end,time).
+bool is_batch_header(const std::string &line);
+
+/**
+ * @brief Zamienia nazwy przystanków zapytania na nazwy z rozkładu (query_executor::resolve_stop).
+ *
+ * Nazwy wpisane bez znaków diakrytycznych lub inną wielkością liter ("kozanow") są przyjmowane, jeśli
+ * wskazują jeden przystanek. Nierozpoznane przystanki pośrednie pozostają bez zmian.
+ *
+ * @param error Dla nieznanego przystanku początkowego lub docelowego – opis z podpowiedziami.
+ * @return true, jeśli przystanek początkowy i docelowy występują w rozkładzie.
+ */
+bool resolve_query_stops(const query_executor &executor, route_query &query, std::string &error);
+
+/**
+ * @brief Formatuje wynik zapytania jako jedną linię JSON (bez znaku nowej linii).
+ *
+ * @param id Identyfikator zapytania (gotowy literał JSON – liczba albo napis w cudzysłowach).
+ * @param query Wykonane zapytanie.
+ * @param result Trasa i koszt zwrócone przez query_executor.
+ * @param elapsed_us Czas wykonania w mikrosekundach.
+ * @param stats Liczniki przeszukiwania dopisywane jako obiekt "stats" (nullptr – pomijane).
+ */
+std::string format_batch_result(const std::string &id,
+                                const route_query &query,
+                                const std::pair<std::vector<edge>, double> &result,
+                                double elapsed_us,
+                                const search_stats *stats = nullptr);
+
+/// Formatuje błąd zapytania jako jedną linię JSON.
+std::string format_batch_error(const std::string &id, const std::string &error);
+
+/**
+ * @brief Tryb wsadowy: wykonuje kolejne zapytania z `in` i strumieniuje wyniki do `out`.
+ *
+ * Każdy wynik to jedna linia JSON z trasą w zwartej postaci (linia, skąd, dokąd, odjazd, przyjazd –
+ * z datą, jeśli przypada innego dnia niż czas zapytania), kosztem i czasem wykonania zapytania w mikrosekundach. Linie puste i zaczynające się od '#'
+ * oraz nagłówek CSV (tylko jako pierwsza z pozostałych linii) są pomijane. Podsumowanie wypisywane jest na std::cerr. W kompilacji z LISTA1_SEARCH_STATS
+ * wynik zawiera też liczniki przeszukiwania ("stats"), a podsumowanie – ich sumy.
+ *
+ * Przy `group_window` > 1 zapytania wczytywane są oknami tej wielkości, a zapytania okna o tym samym
+ * przystanku początkowym i czasie (query_executor::groupable) wykonywane są jednym przeszukiwaniem
+ * jeden-do-wielu (query_executor::execute_group). Wyniki wypisywane są w kolejności wejścia; czas grupy
+ * dzielony jest po równo między jej zapytania, a liczniki przeszukiwania trafiają do pierwszego z nich.
+ *
+ * @param executor Executor z wczytanym rozkładem.
+ * @param in Strumień zapytań.
+ * @param out Strumień wyników.
+ * @param group_window Liczba zapytań wczytywanych naraz (0 lub 1 – każde wykonywane zaraz po wczytaniu).
+ * @return int Liczba zapytań zakończonych błędem.
+ */
+int run_batch(query_executor &executor, std::istream &in, std::ostream &out, size_t group_window = 0);
+
+#endif // BATCH_RUNNER_H
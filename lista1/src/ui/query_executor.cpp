@@ -0,0 +1,349 @@
+#include "query_executor.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#include "../algorithms/dijkstra.h"
+#include "../algorithms/astar.h"
+#include "../algorithms/tabu_search.h"
+#include "../algorithms/tabu_search_knox.h"
+#include "../algorithms/trip_based.h"
+#include "../algorithms/transfer_patterns.h"
+#include "../algorithms/arrive_by.h"
+#include "../algorithms_utils/query_workspace.h"
+#include "../algorithms_utils/trace.h"
+#include "../graph/realtime.h"
+#include "result_cache.h"
+
+// Ścieżka migawki obok pliku z rozkładem: ../data/connection_graph.csv -> ../data/connection_graph<suffix>
+static std::string snapshot_path(const std::string &data_path, const char *suffix) {
+    if (data_path.empty()) {
+        return std::string();
+    }
+    return std::filesystem::path(data_path).replace_extension(suffix).string();
+}
+
+// Wczytuje indeks z migawki albo buduje go i zapisuje. Nieudany zapis jest zgłaszany – bez niego
+// każde uruchomienie po cichu budowałoby indeks od nowa.
+template<typename Index, typename Load, typename Build>
+static Index load_or_build(const std::string &path, const char *name, Load load, Build build) {
+    Index index;
+    if (!path.empty() && load(path, index)) {
+        return index;
+    }
+    index = build();
+    if (!path.empty() && !index.save(path)) {
+        std::cerr << "Nie udało się zapisać migawki " << name << " do " << path
+                  << " – indeks będzie budowany przy każdym uruchomieniu\n";
+    }
+    return index;
+}
+
+query_executor::query_executor(std::vector<edge> edges, const service_calendar &calendar,
+                               const footpath_options &walking, const std::string &data_path)
+    : base(std::make_shared<const timetable>(std::move(edges), calendar, walking)), live(base),
+      trip_based_snapshot(snapshot_path(data_path, ".trip_based.bin")),
+      patterns_snapshot(snapshot_path(data_path, ".transfer_patterns.bin")) {
+    {
+        TRACE_SCOPE("stop_index");
+        std::vector<std::string> names;
+        names.reserve(base->stop_count());
+        for (uint32_t s = 0; s < base->stop_count(); ++s) {
+            names.push_back(base->stop_name(s));
+        }
+        stop_names = stop_index(names);
+    }
+    if (walking.radius_m > 0.0) {
+        std::cerr << "Przejścia piesze: " << base->walk_count() << " w promieniu " << walking.radius_m << " m\n";
+    }
+}
+
+query_executor::~query_executor() = default;
+
+// Czy zapytanie trafi do któregoś algorytmu (błędne wybory nie są zapamiętywane)
+static bool is_supported(const route_query &query) {
+    if (query.optimization_criteria == 'o') return true;
+    if (query.algorithm_choice >= 1 && query.algorithm_choice <= 4) return true;
+    return (query.algorithm_choice == 5 || query.algorithm_choice == 6) && query.optimization_criteria == 't';
+}
+
+void query_executor::enable_cache(const cache_options &options) {
+    results = std::make_unique<result_cache>(options);
+}
+
+bool query_executor::has_stop(const std::string &name) const {
+    return stop_names.find(name) != stop_index::NONE;
+}
+
+std::string query_executor::resolve_stop(const std::string &text) const {
+    uint32_t stop = stop_names.find(text);
+    if (stop == stop_index::NONE) {
+        stop = stop_names.resolve(text);
+    }
+    return stop == stop_index::NONE ? std::string() : stop_names.name(stop);
+}
+
+std::vector<std::string> query_executor::suggest_stops(const std::string &text, size_t limit) const {
+    std::vector<std::string> names;
+    for (const stop_match &match : stop_names.suggest(text, limit)) {
+        names.push_back(stop_names.name(match.stop));
+    }
+    return names;
+}
+
+update_stats query_executor::apply_updates(const std::vector<trip_update> &updates) {
+    TRACE_SCOPE("realtime_update", "updates", static_cast<int64_t>(updates.size()));
+    std::lock_guard<std::mutex> lock(update_mutex);
+    if (!updater) {
+        updater = std::make_unique<realtime_updater>(base);
+    }
+    update_stats stats;
+    live.store(updater->apply(updates, ++last_version, stats));
+    return stats;
+}
+
+const trip_based_index &query_executor::trip_based() {
+    std::call_once(trip_based_once, [this] {
+        TRACE_SCOPE("trip_based_index");
+        auto start = std::chrono::high_resolution_clock::now();
+        const timetable &tt = *base;
+        auto index = std::make_unique<trip_based_index>(load_or_build<trip_based_index>(
+            trip_based_snapshot, "indeksu Trip-Based",
+            [&tt](const std::string &path, trip_based_index &out) { return trip_based_index::load(tt, path, out); },
+            [&tt] { return trip_based_index::build(tt); }));
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+        std::cerr << "Indeks Trip-Based: " << index->trip_count() << " kursów, "
+                  << index->route_count() << " tras, " << index->transfer_count()
+                  << " przesiadek (" << duration.count() << " ms)\n";
+        std::lock_guard<std::mutex> lock(index_mutex);
+        trip_based_cache = std::move(index);
+    });
+    return *trip_based_cache;
+}
+
+const transfer_patterns &query_executor::patterns() {
+    const trip_based_index &tb = trip_based();
+    std::call_once(patterns_once, [this, &tb] {
+        TRACE_SCOPE("transfer_patterns_index");
+        auto index = std::make_unique<transfer_patterns>(load_or_build<transfer_patterns>(
+            patterns_snapshot, "wzorców przesiadek",
+            [&tb](const std::string &path, transfer_patterns &out) { return transfer_patterns::load(tb, path, out); },
+            [&tb] { return transfer_patterns::build(tb); }));
+        std::cerr << "Transfer Patterns: budowa " << index->stats().build_ms << " ms ("
+                  << index->stats().departures << " przeszukań profilowych), "
+                  << index->pattern_count() << " wzorców, " << index->node_count() << " węzłów, "
+                  << index->size_in_bytes() / 1024 << " KiB\n";
+        std::lock_guard<std::mutex> lock(index_mutex);
+        patterns_cache = std::move(index);
+    });
+    return *patterns_cache;
+}
+
+bool query_executor::prepare_indexes() {
+    // Te same warunki co w run() dla algorytmów 5 i 6 – poza nimi zapytania obsługuje Dijkstra
+    if (!base->daily() || base->walk_count() > 0) {
+        return false;
+    }
+    patterns();
+    return true;
+}
+
+void query_executor::memory_report(std::ostream &out, size_t input_bytes) {
+    std::vector<memory_entry> entries = base->memory_usage();
+    size_t timetable_bytes = 0;
+    for (const auto &entry : entries) {
+        timetable_bytes += entry.bytes;
+    }
+    entries.push_back({"rozkład razem", timetable_bytes});
+    {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        if (trip_based_cache) {
+            entries.push_back({"indeks Trip-Based", trip_based_cache->size_in_bytes()});
+        }
+        if (patterns_cache) {
+            entries.push_back({"indeks Transfer Patterns", patterns_cache->size_in_bytes()});
+        }
+    }
+    if (results) {
+        entries.push_back({"pamięć podręczna wyników", results->stats().bytes});
+    }
+    if (input_bytes > 0) {
+        entries.push_back({"lista edge z pliku (dla porównania)", input_bytes});
+    }
+
+    out << "Pamięć (" << base->connection_count() << " połączeń, " << base->stop_count() << " przystanków, "
+        << sizeof(connection) << " B na połączenie):\n";
+    for (const auto &entry : entries) {
+        out << "  " << entry.name << ": " << entry.bytes << " B (" << (entry.bytes + 512) / 1024 << " KiB)\n";
+    }
+}
+
+// Każdy wątek ma własną przestrzeń roboczą, używaną ponownie przez kolejne zapytania
+static query_workspace &thread_workspace() {
+    static thread_local query_workspace workspace;
+    return workspace;
+}
+
+std::pair<std::vector<edge>, double> query_executor::execute(const route_query &query, search_stats *stats) {
+    return execute(query, thread_workspace(), stats);
+}
+
+bool query_executor::groupable(const route_query &query) {
+    return query.optimization_criteria == 't' && query.algorithm_choice == 1;
+}
+
+std::vector<std::pair<std::vector<edge>, double>> query_executor::execute_group(const std::vector<route_query> &queries,
+                                                                                search_stats *stats) {
+    std::vector<std::pair<std::vector<edge>, double>> answers(queries.size());
+    if (stats) {
+        *stats = search_stats();
+    }
+    if (queries.empty()) {
+        return answers;
+    }
+    const route_query &first = queries.front();
+    const bool shared = std::all_of(queries.begin(), queries.end(), [&first](const route_query &q) {
+        return groupable(q) && q.start_stop == first.start_stop && q.start_time == first.start_time;
+    });
+    if (!shared) {
+        for (size_t i = 0; i < queries.size(); ++i) {
+            answers[i] = execute(queries[i]);
+        }
+        return answers;
+    }
+
+    TRACE_SCOPE("search_group", "queries", static_cast<int64_t>(queries.size()));
+    const std::shared_ptr<const timetable> tt = live.load();
+    std::vector<size_t> pending;
+    std::vector<std::string> ends;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (results && results->lookup(queries[i], tt->version(), answers[i])) continue;
+        pending.push_back(i);
+        ends.push_back(queries[i].end_stop);
+    }
+    if (pending.empty()) {
+        return answers;
+    }
+
+    query_workspace &ws = thread_workspace();
+    ws.reset_memory();
+    ws.reset_stats();
+    std::vector<std::pair<std::vector<edge>, double>> found =
+        dijkstra_time_many(*tt, ws, first.start_stop, ends, first.start_time);
+    const arena_stats used = ws.memory_stats();
+    if (stats) {
+        *stats = *ws.stats();
+        stats->bytes_allocated = used.bytes + used.upstream_bytes;
+    }
+    ++executed;
+    arena_allocations += used.allocations;
+    arena_bytes += used.bytes;
+    upstream_allocations += used.upstream_allocations;
+    upstream_bytes += used.upstream_bytes;
+    for (size_t k = 0; k < pending.size(); ++k) {
+        if (results) {
+            results->store(queries[pending[k]], tt->version(), found[k]);
+        }
+        answers[pending[k]] = std::move(found[k]);
+    }
+    return answers;
+}
+
+std::pair<std::vector<edge>, double> query_executor::execute(const route_query &query, query_workspace &ws,
+                                                             search_stats *stats) {
+    TRACE_SCOPE("search", "algorithm", query.optimization_criteria == 'o' ? 0 : query.algorithm_choice);
+    // Jedna wersja rozkładu na całe zapytanie, nawet jeśli w międzyczasie opublikowano nową
+    const std::shared_ptr<const timetable> tt = live.load();
+    const bool cached = results && is_supported(query);
+    std::pair<std::vector<edge>, double> result;
+    if (cached && results->lookup(query, tt->version(), result)) {
+        if (stats) {
+            *stats = search_stats();
+        }
+        return result;
+    }
+    // Pamięć poprzedniego zapytania wraca do areny; liczniki opisują tylko to zapytanie
+    ws.reset_memory();
+    ws.reset_stats();
+    result = run(*tt, query, ws);
+    const arena_stats used = ws.memory_stats();
+    if (stats) {
+        *stats = *ws.stats();
+        stats->bytes_allocated = used.bytes + used.upstream_bytes;
+    }
+    ++executed;
+    arena_allocations += used.allocations;
+    arena_bytes += used.bytes;
+    upstream_allocations += used.upstream_allocations;
+    upstream_bytes += used.upstream_bytes;
+    if (cached) {
+        results->store(query, tt->version(), result);
+    }
+    return result;
+}
+
+allocation_totals query_executor::allocations() const {
+    allocation_totals totals;
+    totals.queries = executed.load();
+    totals.memory = {arena_allocations.load(), arena_bytes.load(), upstream_allocations.load(), upstream_bytes.load()};
+    return totals;
+}
+
+std::pair<std::vector<edge>, double> query_executor::run(const timetable &tt, const route_query &query,
+                                                         query_workspace &ws) {
+    const std::string &start = query.start_stop;
+    const std::string &end = query.end_stop;
+    const auto &time = query.start_time;
+
+    if (query.optimization_criteria == 'o') {
+        // Podany czas jest najpóźniejszym dopuszczalnym przyjazdem do celu
+        return latest_departure(tt, ws, start, end, time);
+    }
+
+    switch (query.algorithm_choice) {
+        case 1:
+            return query.optimization_criteria == 't' ? dijkstra_time(tt, ws, start, end, time)
+                                                      : dijkstra_change(tt, ws, start, end, time);
+        case 2:
+            return query.optimization_criteria == 't' ? astar_time(tt, ws, start, end, time)
+                                                      : astar_change(tt, ws, start, end, time);
+        case 3:
+            // Klasyczny Tabu Search – wersja zależna od kryterium
+            if (query.optimization_criteria == 't') {
+                return tabu_search(tt, ws, start, end, query.required_stops, time, 100);
+            }
+            return tabu_search_change(tt, ws, start, end, query.required_stops, time, 100);
+        case 4:
+            // Tabu Search Knox – step_limit = 100, op_limit = 10
+            return tabu_search_knox(tt, ws, start, end, query.required_stops, time, 100, 10);
+        case 5:
+        case 6:
+            if (query.optimization_criteria != 't') {
+                break;
+            }
+            if (tt.version() != 0 || !tt.daily() || tt.day_of(time) != 0 || tt.walk_count() > 0 ||
+                time <= tt.service_end(-1)) {
+                // Indeksy Trip-Based i Transfer Patterns opisują statyczny rozkład jednego dnia bez przejść pieszych –
+                // po aktualizacji, przy kalendarzu kursowania, przejściach pieszych, w inny dzień lub gdy odjeżdżają
+                // jeszcze kursy poprzedniego dnia odpowiada na zapytanie Dijkstra na bieżącej wersji
+                return dijkstra_time(tt, ws, start, end, time);
+            }
+            {
+                auto result = query.algorithm_choice == 5
+                                  ? trip_based().query(*base, ws, start, end, time)
+                                  : patterns().query(trip_based(), *base, start, end, time, ws.memory(), ws.stats());
+                // Późnym wieczorem trasa może wymagać kursów następnego dnia, których indeksy nie zawierają –
+                // wynik jest pewny tylko, jeśli przyjazd nie jest późniejszy niż pierwszy odjazd dnia 1
+                const bool found = !result.first.empty() || result.second == 0.0;
+                if (!found || (!result.first.empty() && result.first.back().getArrivalTime() > tt.service_begin(1))) {
+                    return dijkstra_time(tt, ws, start, end, time);
+                }
+                return result;
+            }
+        default:
+            break;
+    }
+    std::cerr << "Niepoprawny wybór algorytmu." << std::endl;
+    return {{}, -1.0};
+}
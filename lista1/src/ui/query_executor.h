@@ -0,0 +1,202 @@
+#ifndef QUERY_EXECUTOR_H
+#define QUERY_EXECUTOR_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "../graph/edge.h"
+#include "../graph/timetable.h"
+#include "../graph/footpaths.h"
+#include "../graph/service_calendar.h"
+#include "../graph/stop_index.h"
+#include "../algorithms_utils/query_arena.h"
+#include "../algorithms_utils/search_stats.h"
+
+class trip_based_index;
+class transfer_patterns;
+class query_workspace;
+class result_cache;
+class realtime_updater;
+struct cache_options;
+struct trip_update;
+struct update_stats;
+
+/**
+ * @struct route_query
+ * @brief Pojedyncze zapytanie o trasę – te same parametry, które user_cli zbiera w trybie interaktywnym.
+ */
+struct route_query {
+    std::string start_stop;
+    std::string end_stop;
+    std::chrono::system_clock::time_point start_time;
+    char optimization_criteria = 't';  ///< 't' - czasowe, 'p' - przesiadkowe, 'o' - przyjazd na czas
+    int algorithm_choice = 1;          ///< Numeracja jak w menu user_cli (1 - Dijkstra, 2 - A*, ...)
+    std::vector<std::string> required_stops;
+};
+
+/**
+ * @struct allocation_totals
+ * @brief Łączne przydziały pamięci zapytań wykonanych przez executor (bez trafień w pamięć podręczną).
+ */
+struct allocation_totals {
+    uint64_t queries = 0;
+    arena_stats memory; ///< Sumy liczników aren zapytań
+};
+
+/**
+ * @class query_executor
+ * @brief Wykonuje zapytania o trasę na rozkładzie wczytanym jeden raz.
+ *
+ * Rozkład (timetable) budowany jest w konstruktorze, a indeksy wymagające prekomputacji
+ * (Trip-Based, Transfer Patterns) – przez prepare_indexes() albo leniwie, przy pierwszym zapytaniu,
+ * które ich potrzebuje. Dzięki temu kolejne zapytania nie płacą za wczytanie pliku CSV ani budowę grafu.
+ *
+ * Rozkład i indeksy są tylko do odczytu, a stan zapytania trzyma query_workspace, więc jeden
+ * executor może obsługiwać zapytania z wielu wątków jednocześnie. Opcjonalnie wyniki są
+ * zapamiętywane we współdzielonej pamięci podręcznej (enable_cache).
+ *
+ * Opóźnienia i odwołania kursów (apply_updates) publikowane są w stylu RCU: nowa wersja rozkładu
+ * powstaje jako kopia, a następnie atomowo podmienia wskaźnik. Każde zapytanie pobiera wskaźnik raz
+ * i do końca działa na tej samej wersji, więc zapytania w toku nie są blokowane ani nie widzą
+ * częściowo zastosowanych zmian.
+ */
+class query_executor {
+public:
+    /// Buduje rozkład z listy krawędzi (lista jest przejmowana i zwalniana po zbudowaniu rozkładu).
+    /// @param data_path Plik, z którego wczytano rozkład – migawki indeksów zapisywane są obok niego
+    ///                  (np. connection_graph.trip_based.bin); pusta ścieżka wyłącza migawki.
+    /// @throws std::runtime_error Jak konstruktor timetable.
+    explicit query_executor(std::vector<edge> edges, const service_calendar &calendar = service_calendar(),
+                            const footpath_options &walking = footpath_options(),
+                            const std::string &data_path = std::string());
+    ~query_executor();
+
+    /**
+     * @brief Wczytuje z migawek albo buduje indeksy Trip-Based i Transfer Patterns, zanim przyjdą zapytania.
+     *
+     * Bez tego indeksy powstają przy pierwszym zapytaniu algorytmem 5 lub 6, które czeka na budowę.
+     * Nic nie robi, jeśli indeksy nie mogą odpowiadać na zapytania (kalendarz kursowania, przejścia piesze).
+     *
+     * @return true, jeśli indeksy są gotowe.
+     */
+    bool prepare_indexes();
+
+    /// Czy przystanek występuje w rozkładzie.
+    bool has_stop(const std::string &name) const;
+
+    /**
+     * @brief Nazwa przystanku z rozkładu dla wpisanego tekstu: ta sama nazwa albo jedyna nazwa równa mu
+     *        bez rozróżniania wielkości liter, znaków diakrytycznych i interpunkcji ("kozanow" -> "KOZANÓW").
+     * @return std::string Nazwa z rozkładu; pusta, jeśli przystanku nie ma lub wpis jest niejednoznaczny.
+     */
+    std::string resolve_stop(const std::string &text) const;
+
+    /// Podpowiedzi nazw przystanków dla wpisanego (także błędnie) tekstu – zob. stop_index::suggest.
+    std::vector<std::string> suggest_stops(const std::string &text, size_t limit = 5) const;
+
+    /// Indeks nazw przystanków (zbudowany raz przy wczytaniu rozkładu).
+    const stop_index &stops() const { return stop_names; }
+
+    /**
+     * @brief Wykonuje zapytanie wybranym algorytmem.
+     *
+     * @param query Parametry zapytania.
+     * @param stats Jeśli podano – liczniki przeszukiwania zapytania (zerowe przy trafieniu w pamięć podręczną;
+     *              bez LISTA1_SEARCH_STATS wypełniane jest tylko bytes_allocated).
+     * @return std::pair<std::vector<edge>, double> Trasa oraz jej koszt (jak w user_cli::execute);
+     *         {pusta trasa, -1.0}, jeśli trasy nie znaleziono lub wybór algorytmu jest niepoprawny.
+     */
+    std::pair<std::vector<edge>, double> execute(const route_query &query, search_stats *stats = nullptr);
+
+    /// Jak execute(query), ale z jawnie podaną przestrzenią roboczą (domyślnie – przestrzeń bieżącego wątku).
+    std::pair<std::vector<edge>, double> execute(const route_query &query, query_workspace &ws,
+                                                 search_stats *stats = nullptr);
+
+    /**
+     * @brief Czy zapytanie można wykonać razem z innymi o tym samym początku (execute_group).
+     *
+     * Dotyczy kryterium czasowego z algorytmem Dijkstry – jego wynik nie zależy od pozostałych celów.
+     */
+    static bool groupable(const route_query &query);
+
+    /**
+     * @brief Wykonuje zapytania o wspólnym przystanku początkowym i czasie jednym przeszukiwaniem jeden-do-wielu
+     *        (dijkstra_time_many) zamiast osobnego przeszukiwania dla każdego celu.
+     *
+     * Zapytania muszą spełniać groupable; jeśli różnią się początkiem albo czasem, wykonywane są po kolei
+     * przez execute. Pamięć podręczna działa jak w execute – przeszukiwanie obejmuje tylko chybione cele.
+     *
+     * @param queries Zapytania grupy.
+     * @param stats Jeśli podano – liczniki całego przeszukiwania grupy.
+     * @return Wynik każdego zapytania (w kolejności `queries`), jak z execute.
+     */
+    std::vector<std::pair<std::vector<edge>, double>> execute_group(const std::vector<route_query> &queries,
+                                                                    search_stats *stats = nullptr);
+
+    /// Łączne przydziały pamięci wykonanych zapytań (arena i globalny alokator).
+    allocation_totals allocations() const;
+
+    /// Bieżąca wersja rozkładu (z nałożonymi aktualizacjami).
+    std::shared_ptr<const timetable> current() const { return live.load(); }
+
+    /**
+     * @brief Publikuje nową wersję rozkładu z opóźnieniami i odwołaniami kursów.
+     *
+     * Aktualizacje nakładane są zawsze na rozkład statyczny – kolejne wywołanie zastępuje
+     * poprzednie. Publikacje są serializowane, zapytania wykonywane są równolegle bez blokad.
+     *
+     * @param updates Aktualizacje kursów (pełny bieżący stan).
+     * @return update_stats Podsumowanie zastosowanych zmian.
+     */
+    update_stats apply_updates(const std::vector<trip_update> &updates);
+
+    /// Włącza pamięć podręczną wyników (przed rozpoczęciem wykonywania zapytań).
+    void enable_cache(const cache_options &options);
+    /// Pamięć podręczna wyników lub nullptr, jeśli jest wyłączona.
+    result_cache *cache() const { return results.get(); }
+
+    /**
+     * @brief Wypisuje rozmiary struktur w pamięci: rozkład, zbudowane indeksy i pamięć podręczną.
+     * @param out Strumień wyjściowy.
+     * @param input_bytes Rozmiar wejściowej listy krawędzi (dla porównania; 0 – pomija wiersz).
+     */
+    void memory_report(std::ostream &out, size_t input_bytes = 0);
+
+private:
+    /// Wykonuje zapytanie z pominięciem pamięci podręcznej.
+    std::pair<std::vector<edge>, double> run(const timetable &tt, const route_query &query, query_workspace &ws);
+
+    const trip_based_index &trip_based();
+    const transfer_patterns &patterns();
+
+    const std::shared_ptr<const timetable> base; ///< Rozkład statyczny wczytany z pliku
+    std::atomic<std::shared_ptr<const timetable>> live;
+    stop_index stop_names;          ///< Przystanki nie zmieniają się przy aktualizacjach, więc indeks jest jeden
+
+    std::mutex update_mutex;
+    std::unique_ptr<realtime_updater> updater;
+    uint64_t last_version = 0;
+
+    // Indeksy budowane raz (std::call_once); po zbudowaniu odczyt wskaźnika nie wymaga blokady,
+    // a index_mutex chroni go tylko przed memory_report w trakcie budowy
+    std::once_flag trip_based_once;
+    std::once_flag patterns_once;
+    std::mutex index_mutex;
+    std::string trip_based_snapshot; ///< Puste – indeksy tylko w pamięci
+    std::string patterns_snapshot;
+    std::unique_ptr<trip_based_index> trip_based_cache;
+    std::unique_ptr<transfer_patterns> patterns_cache;
+    std::unique_ptr<result_cache> results;
+
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> arena_allocations{0};
+    std::atomic<uint64_t> arena_bytes{0};
+    std::atomic<uint64_t> upstream_allocations{0};
+    std::atomic<uint64_t> upstream_bytes{0};
+};
+
+#endif // QUERY_EXECUTOR_H
@@ -0,0 +1,361 @@
+#include "query_server.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+
+int run_server(query_executor &, const server_options &) {
+    std::cerr << "Tryb serwera jest dostępny tylko w systemach POSIX." << std::endl;
+    return 1;
+}
+
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../algorithms_utils/trace.h"
+#include "../io_handling/json_lite.h"
+#include "batch_runner.h"
+#include "result_cache.h"
+
+namespace {
+
+std::atomic<bool> stop_requested{false};
+
+void handle_signal(int) {
+    stop_requested = true;
+}
+
+typedef std::chrono::steady_clock clock_type;
+
+struct pending_connection {
+    int fd;
+    clock_type::time_point accepted;
+};
+
+struct http_request {
+    std::string method;
+    std::string path;
+    std::string body;
+};
+
+struct server_counters {
+    std::atomic<uint64_t> served{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> failed{0};
+};
+
+long long micros(clock_type::duration d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+bool send_all(int fd, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void send_response(int fd, int status, const std::string &reason, const std::string &body,
+                   const std::string &extra_headers = "") {
+    std::ostringstream out;
+    out << "HTTP/1.1 " << status << " " << reason << "\r\n"
+        << "Content-Type: application/json; charset=utf-8\r\n"
+        << "Content-Length: " << body.size() << "\r\n"
+        << "Connection: close\r\n"
+        << extra_headers
+        << "\r\n"
+        << body;
+    send_all(fd, out.str());
+}
+
+// Czyta nagłówek i treść żądania (Content-Length); zwraca kod błędu HTTP lub 0
+int read_request(int fd, size_t max_body, http_request &request) {
+    std::string data;
+    char buf[4096];
+    size_t header_end = std::string::npos;
+    while ((header_end = data.find("\r\n\r\n")) == std::string::npos) {
+        if (data.size() > 16 * 1024) return 431;
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return 400;
+        data.append(buf, static_cast<size_t>(n));
+    }
+
+    std::istringstream head(data.substr(0, header_end));
+    std::string line;
+    std::getline(head, line);
+    std::istringstream request_line(line);
+    request_line >> request.method >> request.path;
+    if (request.method.empty() || request.path.empty()) return 400;
+
+    size_t content_length = 0;
+    while (std::getline(head, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        auto colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        for (auto &c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (name == "content-length") {
+            try {
+                content_length = std::stoul(line.substr(colon + 1));
+            } catch (const std::exception &) {
+                return 400;
+            }
+        }
+    }
+    if (content_length > max_body) return 413;
+
+    request.body = data.substr(header_end + 4);
+    while (request.body.size() < content_length) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return 400;
+        request.body.append(buf, static_cast<size_t>(n));
+    }
+    request.body.resize(content_length);
+    return 0;
+}
+
+// Parametr z części zapytania ścieżki ("/stops?q=...&limit=5") po dekodowaniu %XX i '+'
+std::string query_param(const std::string &path, const std::string &name) {
+    const size_t question = path.find('?');
+    if (question == std::string::npos) return {};
+    std::istringstream params(path.substr(question + 1));
+    std::string pair;
+    while (std::getline(params, pair, '&')) {
+        const size_t eq = pair.find('=');
+        if (pair.substr(0, eq) != name) continue;
+        std::string value;
+        const std::string raw = eq == std::string::npos ? std::string() : pair.substr(eq + 1);
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (raw[i] == '+') {
+                value.push_back(' ');
+            } else if (raw[i] == '%' && i + 2 < raw.size() && std::isxdigit(static_cast<unsigned char>(raw[i + 1])) &&
+                       std::isxdigit(static_cast<unsigned char>(raw[i + 2]))) {
+                value.push_back(static_cast<char>(std::stoi(raw.substr(i + 1, 2), nullptr, 16)));
+                i += 2;
+            } else {
+                value.push_back(raw[i]);
+            }
+        }
+        return value;
+    }
+    return {};
+}
+
+std::string timing_headers(clock_type::duration queue, clock_type::duration exec, clock_type::duration total) {
+    std::ostringstream out;
+    out << "X-Queue-Time-Us: " << micros(queue) << "\r\n"
+        << "X-Exec-Time-Us: " << micros(exec) << "\r\n"
+        << "X-Total-Time-Us: " << micros(total) << "\r\n";
+    return out.str();
+}
+
+void handle_connection(const pending_connection &conn, query_executor &executor,
+                       const server_options &options, server_counters &counters) {
+    TRACE_SCOPE("request");
+    const auto started = clock_type::now();
+    const auto queued = started - conn.accepted;
+
+    // Wolni klienci nie mogą blokować wątku roboczego w nieskończoność
+    timeval timeout{5, 0};
+    setsockopt(conn.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    http_request request;
+    int status = read_request(conn.fd, options.max_body, request);
+    if (status != 0) {
+        ++counters.failed;
+        const char *reason = status == 413 ? "Payload Too Large" : status == 431 ? "Request Header Fields Too Large" : "Bad Request";
+        send_response(conn.fd, status, reason, "{\"error\":\"niepoprawne żądanie\"}",
+                      timing_headers(queued, {}, clock_type::now() - conn.accepted));
+        return;
+    }
+
+    if (request.method == "GET" && request.path == "/health") {
+        send_response(conn.fd, 200, "OK", "{\"status\":\"ok\"}",
+                      timing_headers(queued, {}, clock_type::now() - conn.accepted));
+        return;
+    }
+    if (request.method == "GET" && request.path == "/stats") {
+        std::ostringstream body;
+        body << "{\"served\":" << counters.served << ",\"rejected\":" << counters.rejected
+             << ",\"failed\":" << counters.failed << ",\"workers\":" << options.workers
+             << ",\"timetable_version\":" << executor.current()->version();
+        const allocation_totals allocations = executor.allocations();
+        body << ",\"memory\":{\"queries\":" << allocations.queries
+             << ",\"arena_allocations\":" << allocations.memory.allocations
+             << ",\"arena_bytes\":" << allocations.memory.bytes
+             << ",\"heap_allocations\":" << allocations.memory.upstream_allocations
+             << ",\"heap_bytes\":" << allocations.memory.upstream_bytes << "}";
+        if (const result_cache *cache = executor.cache()) {
+            const cache_stats stats = cache->stats();
+            body << ",\"cache\":{\"hits\":" << stats.hits << ",\"misses\":" << stats.misses
+                 << ",\"stale\":" << stats.stale << ",\"evictions\":" << stats.evictions
+                 << ",\"invalidations\":" << stats.invalidations << ",\"entries\":" << stats.entries
+                 << ",\"bytes\":" << stats.bytes << ",\"hit_rate\":" << stats.hit_rate() << "}";
+        }
+        body << "}";
+        send_response(conn.fd, 200, "OK", body.str(), timing_headers(queued, {}, clock_type::now() - conn.accepted));
+        return;
+    }
+    if (request.method == "GET" && request.path.compare(0, 7, "/stops?") == 0) {
+        size_t limit = 10;
+        try {
+            const std::string text = query_param(request.path, "limit");
+            if (!text.empty()) limit = std::min<size_t>(std::stoul(text), 100);
+        } catch (const std::exception &) {
+        }
+        const std::string text = query_param(request.path, "q");
+        const auto exec_start = clock_type::now();
+        const std::vector<std::string> names = executor.suggest_stops(text, limit);
+        const auto exec = clock_type::now() - exec_start;
+        std::string body = "{\"query\":" + json_quote(text) + ",\"stops\":[";
+        for (size_t i = 0; i < names.size(); ++i) {
+            body += (i ? "," : "") + json_quote(names[i]);
+        }
+        body += "]}";
+        send_response(conn.fd, 200, "OK", body, timing_headers(queued, exec, clock_type::now() - conn.accepted));
+        return;
+    }
+    if (request.method != "POST" || request.path != "/query") {
+        ++counters.failed;
+        send_response(conn.fd, 404, "Not Found", "{\"error\":\"nieznany zasób\"}",
+                      timing_headers(queued, {}, clock_type::now() - conn.accepted));
+        return;
+    }
+
+    route_query query;
+    std::string id, error;
+    bool ok = parse_batch_query(request.body, query, id, error);
+    if (id.empty()) id = "null";
+    if (ok) {
+        ok = resolve_query_stops(executor, query, error);
+    }
+    if (!ok) {
+        ++counters.failed;
+        send_response(conn.fd, 400, "Bad Request", format_batch_error(id, error),
+                      timing_headers(queued, {}, clock_type::now() - conn.accepted));
+        return;
+    }
+
+    search_stats stats;
+    search_stats *counted = search_stats_enabled ? &stats : nullptr;
+    const auto exec_start = clock_type::now();
+    auto result = executor.execute(query, counted);
+    const auto exec = clock_type::now() - exec_start;
+    ++counters.served;
+    send_response(conn.fd, 200, "OK",
+                  format_batch_result(id, query, result, static_cast<double>(micros(exec)), counted),
+                  timing_headers(queued, exec, clock_type::now() - conn.accepted));
+}
+
+} // namespace
+
+int run_server(query_executor &executor, const server_options &options) {
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Nie można utworzyć gniazda." << std::endl;
+        return 1;
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options.port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || ::listen(listener, 128) < 0) {
+        std::cerr << "Nie można nasłuchiwać na 127.0.0.1:" << options.port << std::endl;
+        ::close(listener);
+        return 1;
+    }
+
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<pending_connection> pending;
+    server_counters counters;
+
+    // Rozkład i indeksy są współdzielone; każdy wątek roboczy ma własną przestrzeń roboczą zapytań
+    const unsigned workers = std::max(1u, options.workers);
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < workers; ++i) {
+        pool.emplace_back([&, i]() {
+            if (tracer::enabled()) {
+                tracer::name_thread("worker " + std::to_string(i + 1));
+            }
+            while (true) {
+                pending_connection conn{};
+                {
+                    std::unique_lock<std::mutex> lock(queue_mutex);
+                    queue_cv.wait(lock, [&]() { return stop_requested || !pending.empty(); });
+                    if (pending.empty()) return;
+                    conn = pending.front();
+                    pending.pop_front();
+                }
+                handle_connection(conn, executor, options, counters);
+                ::close(conn.fd);
+            }
+        });
+    }
+
+    std::cerr << "Serwer zapytań nasłuchuje na 127.0.0.1:" << options.port << " (" << workers
+              << " wątków, kolejka " << options.max_pending << ")" << std::endl;
+
+    pollfd pfd{listener, POLLIN, 0};
+    while (!stop_requested) {
+        if (::poll(&pfd, 1, 200) <= 0) continue;
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        const auto accepted = clock_type::now();
+
+        bool admitted = false;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (pending.size() < options.max_pending) {
+                pending.push_back({fd, accepted});
+                admitted = true;
+            }
+        }
+        if (admitted) {
+            queue_cv.notify_one();
+        } else {
+            // Kontrola przyjęć: przepełniona kolejka – odrzucamy od razu, zamiast zwiększać opóźnienia
+            ++counters.rejected;
+            send_response(fd, 503, "Service Unavailable", "{\"error\":\"serwer przeciążony\"}",
+                          "Retry-After: 1\r\n" + timing_headers({}, {}, clock_type::now() - accepted));
+            ::close(fd);
+        }
+    }
+
+    queue_cv.notify_all();
+    for (auto &th : pool) {
+        th.join();
+    }
+    ::close(listener);
+    std::cerr << "Serwer zatrzymany: obsłużono " << counters.served << ", odrzucono " << counters.rejected
+              << ", błędnych " << counters.failed << std::endl;
+    return 0;
+}
+
+#endif
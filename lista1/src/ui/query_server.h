@@ -0,0 +1,45 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "query_executor.h"
+
+/**
+ * @struct server_options
+ * @brief Parametry lokalnego serwera zapytań.
+ */
+struct server_options {
+    uint16_t port = 8080;        ///< Port TCP (serwer nasłuchuje tylko na 127.0.0.1)
+    unsigned workers = 4;        ///< Liczba wątków obsługujących zapytania
+    size_t max_pending = 64;     ///< Maksymalna liczba połączeń czekających w kolejce (kontrola przyjęć)
+    size_t max_body = 64 * 1024; ///< Maksymalny rozmiar treści żądania w bajtach
+};
+
+/**
+ * @brief Uruchamia długo działający serwer zapytań HTTP na 127.0.0.1.
+ *
+ * Rozkład wczytywany jest raz, a zapytania obsługuje stała pula wątków współdzieląca jeden executor. Połączenia, które nie
+ * mieszczą się w kolejce (`max_pending`), są od razu odrzucane odpowiedzią 503.
+ *
+ * Protokół:
+ *  - POST /query – treść w formacie JSON jak w trybie wsadowym; odpowiedź – linia wyniku trybu wsadowego
+ *    (z licznikami przeszukiwania w kompilacji z LISTA1_SEARCH_STATS),
+ *  - GET /health – stan serwera,
+ *  - GET /stops?q=<tekst>[&limit=N] – podpowiedzi nazw przystanków (prefiks, bez znaków diakrytycznych,
+ *    z błędami pisowni), domyślnie 10,
+ *  - GET /stats – liczniki obsłużonych, odrzuconych i błędnych żądań, wersja rozkładu, liczniki pamięci podręcznej
+ *    wyników i przydziałów pamięci zapytań (arena i globalny alokator).
+ *
+ * Każda odpowiedź zawiera nagłówki X-Queue-Time-Us (czas oczekiwania w kolejce),
+ * X-Exec-Time-Us (czas wykonania zapytania) i X-Total-Time-Us.
+ * Serwer kończy pracę po otrzymaniu SIGINT lub SIGTERM.
+ *
+ * @param executor Executor z wczytanym rozkładem.
+ * @param options Parametry serwera.
+ * @return int Kod wyjścia procesu.
+ */
+int run_server(query_executor &executor, const server_options &options);
+
+#endif // QUERY_SERVER_H
@@ -0,0 +1,73 @@
+#include "realtime_feed.h"
+
+#include <fstream>
+#include <iostream>
+
+#include "../algorithms_utils/trace.h"
+#include "../graph/realtime.h"
+
+realtime_feed::realtime_feed(query_executor &executor, std::string path, std::chrono::seconds interval)
+    : executor(executor), path(std::move(path)), interval(interval) {
+}
+
+realtime_feed::~realtime_feed() {
+    stop();
+}
+
+bool realtime_feed::poll() {
+    std::error_code ec;
+    const auto write_time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        std::cerr << "Aktualizacje: nie można odczytać pliku " << path << ": " << ec.message() << std::endl;
+        return false;
+    }
+    if (loaded && write_time == last_write) {
+        return true;
+    }
+
+    std::ifstream in(path);
+    std::vector<trip_update> updates;
+    std::string error;
+    if (!in.is_open() || !parse_trip_updates(in, updates, error)) {
+        std::cerr << "Aktualizacje: pominięto plik " << path << " (" << (error.empty() ? "błąd odczytu" : error)
+                  << ")" << std::endl;
+        return false;
+    }
+    last_write = write_time;
+    loaded = true;
+
+    const update_stats stats = executor.apply_updates(updates);
+    std::cerr << "Aktualizacje: wersja " << executor.current()->version() << ", " << stats.trips << " kursów, "
+              << stats.edges << " połączeń, " << stats.unmatched << " nieznanych kursów (" << stats.elapsed_ms
+              << " ms)" << std::endl;
+    return true;
+}
+
+void realtime_feed::start() {
+    if (worker.joinable()) return;
+    stopping = false;
+    worker = std::thread(&realtime_feed::run, this);
+}
+
+void realtime_feed::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void realtime_feed::run() {
+    if (tracer::enabled()) {
+        tracer::name_thread("realtime_feed");
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+        lock.unlock();
+        poll();
+        lock.lock();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef REALTIME_FEED_H
+#define REALTIME_FEED_H
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "query_executor.h"
+
+/**
+ * @class realtime_feed
+ * @brief Okresowo wczytuje plik z opóźnieniami i odwołaniami kursów.
+ *
+ * Wątek w tle co `interval` sprawdza czas modyfikacji pliku i – jeśli się zmienił – wczytuje go
+ * ponownie i publikuje nową wersję rozkładu przez query_executor::apply_updates. Niepoprawny plik
+ * jest pomijany (obowiązuje poprzednia wersja), a błąd trafia na standardowe wyjście błędów.
+ */
+class realtime_feed {
+public:
+    realtime_feed(query_executor &executor, std::string path, std::chrono::seconds interval);
+    ~realtime_feed();
+
+    realtime_feed(const realtime_feed &) = delete;
+    realtime_feed &operator=(const realtime_feed &) = delete;
+
+    /// Wczytuje plik, jeśli zmienił się od ostatniego odczytu. Zwraca false przy błędzie odczytu lub formatu.
+    bool poll();
+
+    /// Uruchamia wątek odczytujący plik co `interval`.
+    void start();
+    /// Zatrzymuje wątek (wywoływane też przez destruktor).
+    void stop();
+
+private:
+    void run();
+
+    query_executor &executor;
+    const std::string path;
+    const std::chrono::seconds interval;
+    std::filesystem::file_time_type last_write{};
+    bool loaded = false;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+};
+
+#endif // REALTIME_FEED_H
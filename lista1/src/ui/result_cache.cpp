@@ -0,0 +1,156 @@
+#include "result_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+// Kryteria, dla których koszt jest liczbą sekund liczoną od czasu zapytania
+bool time_based_cost(const route_query &query) {
+    if (query.optimization_criteria == 'o') return true;
+    return query.optimization_criteria == 't' && query.algorithm_choice != 3 && query.algorithm_choice != 4;
+}
+
+int64_t seconds_of(const std::chrono::system_clock::time_point &time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+int64_t floor_div(int64_t a, int64_t b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+size_t estimate_bytes(const std::string &key, const std::vector<edge> &route) {
+    size_t bytes = sizeof(std::pair<std::string, void *>) + 2 * key.capacity() + 128; // wpis listy i mapy
+    for (const auto &e : route) {
+        bytes += sizeof(edge);
+        for (const std::string *s : {&e.getCompany(), &e.getLine(), &e.getStartStop(), &e.getEndStop()}) {
+            if (s->capacity() > 15) bytes += s->capacity() + 1; // poza buforem SSO
+        }
+    }
+    return bytes;
+}
+
+} // namespace
+
+result_cache::result_cache(const cache_options &options) : config(options) {
+    config.shards = std::max<size_t>(1, config.shards);
+    config.bucket_seconds = std::max<int64_t>(1, config.bucket_seconds);
+    shard_budget = config.memory_budget / config.shards;
+    for (size_t i = 0; i < config.shards; ++i) {
+        shards.push_back(std::make_unique<shard>());
+    }
+}
+
+std::string result_cache::make_key(const route_query &query) const {
+    // Separator spoza znaków występujących w nazwach przystanków
+    const char sep = '\x1f';
+    std::string key;
+    key.reserve(query.start_stop.size() + query.end_stop.size() + 32);
+    key += query.start_stop;
+    key += sep;
+    key += query.end_stop;
+    key += sep;
+    key += std::to_string(floor_div(seconds_of(query.start_time), config.bucket_seconds));
+    key += sep;
+    key += query.optimization_criteria;
+    key += std::to_string(query.algorithm_choice);
+    for (const auto &stop : query.required_stops) {
+        key += sep;
+        key += stop;
+    }
+    return key;
+}
+
+result_cache::shard &result_cache::shard_for(const std::string &key) {
+    return *shards[std::hash<std::string>{}(key) % shards.size()];
+}
+
+bool result_cache::lookup(const route_query &query, uint64_t version, result_type &result) {
+    const std::string key = make_key(query);
+    shard &s = shard_for(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto it = s.index.find(key);
+    if (it == s.index.end()) {
+        ++misses;
+        return false;
+    }
+    const entry &e = *it->second;
+    if (e.version < version) {
+        // Wpis sprzed zmiany rozkładu
+        s.bytes -= e.bytes;
+        s.lru.erase(it->second);
+        s.index.erase(it);
+        ++invalidations;
+        ++stale;
+        return false;
+    }
+    if (e.version > version) {
+        // Zapytanie działa jeszcze na poprzedniej wersji rozkładu
+        ++stale;
+        return false;
+    }
+
+    const auto &route = e.result.first;
+    const bool backward = query.optimization_criteria == 'o';
+    bool valid;
+    if (backward) {
+        valid = query.start_time <= e.time && (route.empty() || route.back().getArrivalTime() <= query.start_time);
+    } else {
+        valid = query.start_time >= e.time && (route.empty() || route.front().getDepartureTime() >= query.start_time);
+    }
+    if (!valid) {
+        ++stale;
+        return false;
+    }
+
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    result = e.result;
+    if (time_based_cost(query) && !route.empty() && result.second >= 0) {
+        const double shift = static_cast<double>(seconds_of(query.start_time) - seconds_of(e.time));
+        result.second += backward ? shift : -shift;
+    }
+    ++hits;
+    return true;
+}
+
+void result_cache::store(const route_query &query, uint64_t version, const result_type &result) {
+    std::string key = make_key(query);
+    shard &s = shard_for(key);
+    const size_t bytes = estimate_bytes(key, result.first);
+    if (bytes > shard_budget) return;
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.index.find(key);
+    if (it != s.index.end()) {
+        if (it->second->version > version) return;
+        s.bytes -= it->second->bytes;
+        s.lru.erase(it->second);
+        s.index.erase(it);
+    }
+    while (!s.lru.empty() && s.bytes + bytes > shard_budget) {
+        const entry &victim = s.lru.back();
+        s.bytes -= victim.bytes;
+        s.index.erase(victim.key);
+        s.lru.pop_back();
+        ++evictions;
+    }
+    s.lru.push_front({key, version, query.start_time, result, bytes});
+    s.index.emplace(std::move(key), s.lru.begin());
+    s.bytes += bytes;
+}
+
+cache_stats result_cache::stats() const {
+    cache_stats out;
+    out.hits = hits;
+    out.misses = misses;
+    out.stale = stale;
+    out.evictions = evictions;
+    out.invalidations = invalidations;
+    for (const auto &s : shards) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        out.entries += s->lru.size();
+        out.bytes += s->bytes;
+    }
+    return out;
+}
@@ -0,0 +1,113 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../graph/edge.h"
+#include "query_executor.h"
+
+/**
+ * @struct cache_options
+ * @brief Parametry pamięci podręcznej wyników zapytań.
+ */
+struct cache_options {
+    size_t memory_budget = 64u << 20; ///< Przybliżony limit pamięci wszystkich segmentów (bajty)
+    size_t shards = 16;               ///< Liczba niezależnie blokowanych segmentów
+    int64_t bucket_seconds = 300;     ///< Szerokość przedziału czasu odjazdu w kluczu (sekundy)
+};
+
+/**
+ * @struct cache_stats
+ * @brief Liczniki pamięci podręcznej.
+ */
+struct cache_stats {
+    uint64_t hits = 0;          ///< Trafienia zwrócone bez wykonywania zapytania
+    uint64_t misses = 0;        ///< Brak wpisu dla klucza
+    uint64_t stale = 0;         ///< Wpis istniał, ale nie był ważny dla czasu zapytania lub wersji rozkładu
+    uint64_t evictions = 0;     ///< Wpisy usunięte z powodu limitu pamięci
+    uint64_t invalidations = 0; ///< Wpisy usunięte, bo wyznaczono je na starszej wersji rozkładu
+    size_t entries = 0;
+    size_t bytes = 0;
+
+    double hit_rate() const {
+        const uint64_t lookups = hits + misses + stale;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+};
+
+/**
+ * @class result_cache
+ * @brief Współbieżna pamięć podręczna wyników zapytań z wyrzucaniem najdawniej używanych (LRU).
+ *
+ * Kluczem jest (start, cel, przedział czasu odjazdu, kryterium, algorytm, przystanki pośrednie).
+ * Klucze rozdzielane są funkcją skrótu na segmenty z własnym muteksem, listą LRU i częścią limitu pamięci.
+ *
+ * Wynik zapisany dla czasu t0 zwracany jest dla czasu t z tego samego przedziału tylko wtedy, gdy jest
+ * dla t nadal optymalny: przy wyszukiwaniu w przód musi zachodzić t0 <= t <= pierwszy odjazd trasy
+ * (każda trasa dostępna od t jest dostępna także od t0), a przy wyszukiwaniu wstecznym ('o') –
+ * ostatni przyjazd <= t <= t0. Koszt czasowy jest wtedy przeliczany względem t.
+ *
+ * Każdy wpis pamięta wersję rozkładu (timetable::version()), na której go wyznaczono. Po publikacji
+ * nowej wersji wpisy starsze są traktowane jak brak i usuwane przy następnym odczycie albo wyrzucane
+ * przez LRU, więc zmiana rozkładu unieważnia pamięć w O(1). Zapytania w toku, które działają jeszcze
+ * na poprzedniej wersji, nie nadpisują i nie usuwają wpisów nowszych.
+ */
+class result_cache {
+public:
+    typedef std::pair<std::vector<edge>, double> result_type;
+
+    explicit result_cache(const cache_options &options = cache_options());
+
+    /**
+     * @brief Szuka wyniku ważnego dla zapytania.
+     * @param query Zapytanie.
+     * @param version Wersja rozkładu, na której wykonywane jest zapytanie.
+     * @param result Wypełniany wynikiem (z kosztem przeliczonym na czas zapytania).
+     * @return true przy trafieniu.
+     */
+    bool lookup(const route_query &query, uint64_t version, result_type &result);
+
+    /// Zapisuje wynik zapytania wyznaczony na wersji `version` rozkładu, wyrzucając najdawniej używane wpisy segmentu ponad limit pamięci.
+    void store(const route_query &query, uint64_t version, const result_type &result);
+
+    cache_stats stats() const;
+    const cache_options &options() const { return config; }
+
+private:
+    struct entry {
+        std::string key;
+        uint64_t version;
+        std::chrono::system_clock::time_point time; ///< Czas zapytania, dla którego wyznaczono wynik
+        result_type result;
+        size_t bytes;
+    };
+
+    struct shard {
+        std::mutex mutex;
+        std::list<entry> lru; ///< Najświeżej użyte na początku
+        std::unordered_map<std::string, std::list<entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    std::string make_key(const route_query &query) const;
+    shard &shard_for(const std::string &key);
+
+    cache_options config;
+    size_t shard_budget;
+    std::vector<std::unique_ptr<shard>> shards;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> stale{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> invalidations{0};
+};
+
+#endif // RESULT_CACHE_H
@@ -5,14 +5,11 @@
 #include <chrono>
 #include <vector>
 
-// Zakładamy, że funkcje algorytmów zostały zaktualizowane tak, aby przyjmowały gotową listę sąsiedztwa
-#include "../algorithms/dijkstra.h"
-#include "../algorithms/astar.h"
-#include "../algorithms/tabu_search.h"
-#include "../algorithms/tabu_search_knox.h"  // Dodajemy nagłówek dla nowej funkcji
+#include <iomanip>
 
-// Do budowy grafu wykorzystamy naszą klasę Graph:
-#include "../graph/graph.h"
+// Wykonanie zapytania (graf, algorytmy i indeksy) jest wspólne z trybem wsadowym
+#include "query_executor.h"
+#include "../algorithms_utils/trace.h"
 
 using namespace std;
 using namespace chrono;
@@ -65,7 +62,8 @@ void user_cli::gatherBasicData() {
             start_time = now;
         }
 
-        std::cout << "Wybierz kryterium (t - najkrótszy dojazd, p - najmniej przesiadek): ";
+        std::cout << "Wybierz kryterium (t - najkrótszy dojazd, p - najmniej przesiadek, "
+                     "o - najpóźniejszy odjazd przy przyjeździe o podanej godzinie): ";
         std::string crit;
         std::getline(std::cin, crit);
         if (!crit.empty()) {
@@ -77,9 +75,16 @@ void user_cli::gatherBasicData() {
 void user_cli::gatherAlgorithmChoice() {
     std::cout << "\nWybrano trasę: " << start_stop << " -> " << end_stop << std::endl;
     std::cout << "Kryterium optymalizacji: "
-              << (optimization_criteria == 't' ? "czasowe" : "przesiadkowe")
+              << (optimization_criteria == 't' ? "czasowe" : optimization_criteria == 'o' ? "przyjazd na czas" : "przesiadkowe")
               << std::endl;
 
+    if (optimization_criteria == 'o') {
+        // Dla zapytania "przyjazd na czas" dostępne jest tylko wyszukiwanie wsteczne
+        std::cout << "\nAlgorytm: wyszukiwanie wsteczne (najpóźniejszy odjazd)" << std::endl;
+        algorithm_choice = 1;
+        return;
+    }
+
     std::cout << "\nWybierz algorytm do wykonania:" << std::endl;
     if (optimization_criteria == 't') {
         std::cout << "1. Dijkstra (czasowy)" << std::endl;
@@ -90,7 +95,11 @@ void user_cli::gatherAlgorithmChoice() {
     }
     std::cout << "3. Tabu Search (klasyczny)" << std::endl;
     std::cout << "4. Tabu Search Knox" << std::endl;  // Dodana opcja dla tabu_search_knox
-    std::cout << "Wybierz opcję (1, 2, 3 lub 4): ";
+    if (optimization_criteria == 't') {
+        std::cout << "5. Trip-Based (z prekomputacją przesiadek)" << std::endl;
+        std::cout << "6. Transfer Patterns (indeks wzorców przesiadek)" << std::endl;
+    }
+    std::cout << "Wybierz opcję (1-6): ";
     std::string algo_str;
     std::getline(std::cin, algo_str);
     if (!algo_str.empty())
@@ -108,70 +117,62 @@ void user_cli::gatherAlgorithmChoice() {
     }
 }
 
-bool validateStops(const std::vector<edge>& edges, const std::string& start, const std::string& end) {
-    std::unordered_set<std::string> stops;
-    for (const auto& e : edges) {
-        stops.insert(e.getStartStop());
-        stops.insert(e.getEndStop());
+bool user_cli::resolveStop(const query_executor &executor, std::string &stop, const char *label) {
+    while (true) {
+        {
+            TRACE_SCOPE("stop_validation");
+            if (executor.has_stop(stop)) {
+                return true;
+            }
+            std::string resolved = executor.resolve_stop(stop);
+            if (!resolved.empty()) {
+                std::cout << "Przystanek " << label << ": " << resolved << std::endl;
+                stop = std::move(resolved);
+                return true;
+            }
+        }
+        std::cerr << "Błąd: Nieprawidłowa nazwa przystanku: " << stop << std::endl;
+        const std::vector<std::string> similar = executor.suggest_stops(stop, 5);
+        if (!similar.empty()) {
+            std::cout << "Czy chodziło o:";
+            for (size_t i = 0; i < similar.size(); ++i) {
+                std::cout << (i ? ", " : " ") << similar[i];
+            }
+            std::cout << "?" << std::endl;
+        }
+        std::cout << "Podaj przystanek " << label << " ponownie (Enter – przerwij): ";
+        if (!std::getline(std::cin, stop) || stop.empty()) {
+            return false;
+        }
     }
-    return stops.count(start) && stops.count(end);
 }
 
-std::pair<std::vector<edge>, double> user_cli::execute(const std::vector<edge>& edges) {
-    if (!validateStops(edges, start_stop, end_stop)) {
-        std::cerr << "Błąd: Nieprawidłowe nazwy przystanków." << std::endl;
-        std::cerr << start_stop << ", " << end_stop << std::endl;
+std::pair<std::vector<edge>, double> user_cli::execute(query_executor& executor) {
+    // Pomyłka w nazwie nie przerywa programu – rozkład jest już wczytany
+    if (!resolveStop(executor, start_stop, "początkowy") || !resolveStop(executor, end_stop, "końcowy")) {
         return {};
     }
+    for (auto &stop : excluded_stops) {
+        std::string resolved = executor.resolve_stop(stop);
+        if (!resolved.empty()) stop = std::move(resolved);
+    }
 
-    // Budujemy graf na podstawie krawędzi – tworzymy listę sąsiedztwa
-    Graph graph;
-    graph.buildGraph(edges);
-    auto adj = graph.getAdjacencyList();
-
-    std::pair<std::vector<edge>, double> route;
-
-    if (algorithm_choice == 1) {
-        if (optimization_criteria == 't') {
-            auto start = chrono::high_resolution_clock::now();
-            route = dijkstra_time(adj, start_stop, end_stop, start_time);
-            auto duration = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - start);
-            std::cerr << "Czas wykonania: " << duration.count() << " ms\n";
-        } else {
-            auto res = dijkstra_change(adj, start_stop, end_stop, start_time);
-            route = {res.first, static_cast<double>(res.second)};
-        }
-    } else if (algorithm_choice == 2) {
-        if (optimization_criteria == 't') {
-            auto start = chrono::high_resolution_clock::now();
-            route = astar_time(adj, edges, start_stop, end_stop, start_time);
-            auto duration = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - start);
-            std::cerr << "Czas wykonania: " << duration.count() << " ms\n";
-        } else {
-            auto res = astar_change(adj, edges, start_stop, end_stop, start_time);
-            route = {res.first, static_cast<double>(res.second)};
-        }
-    } else if (algorithm_choice == 3) {
-        auto start = chrono::high_resolution_clock::now();
-        // Klasyczny Tabu Search – wersja zależna od kryterium
-        if (optimization_criteria == 't') {
-            auto res = tabu_search(adj, edges, start_stop, end_stop, excluded_stops, start_time, 100);
-            route = {res.first, static_cast<double>(res.second)};
-        } else if (optimization_criteria == 'p') {
-            auto res = tabu_search_change(adj, edges, start_stop, end_stop, excluded_stops, start_time, 100);
-            route = {res.first, static_cast<double>(res.second)};
-        }
-        auto duration = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - start);
-        std::cerr << "Czas wykonania: " << duration.count() << " ms\n";
-    } else if (algorithm_choice == 4) {
-        auto start = chrono::high_resolution_clock::now();
-        // Użycie nowej funkcji Tabu Search Knox – przykładowe parametry: step_limit = 100, op_limit = 10
-        auto res = tabu_search_knox(adj, edges, start_stop, end_stop, excluded_stops, start_time, 100, 10);
-        route = {res.first, static_cast<double>(res.second)};
-        auto duration = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - start);
-        std::cerr << "Czas wykonania: " << duration.count() << " ms\n";
-    } else {
-        std::cerr << "Niepoprawny wybór algorytmu." << std::endl;
+    route_query query;
+    query.start_stop = start_stop;
+    query.end_stop = end_stop;
+    query.start_time = start_time;
+    query.optimization_criteria = optimization_criteria;
+    query.algorithm_choice = algorithm_choice;
+    query.required_stops = excluded_stops;
+
+    auto start = chrono::high_resolution_clock::now();
+    std::pair<std::vector<edge>, double> route = executor.execute(query);
+    auto duration = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start);
+    std::cerr << "Czas wykonania: " << duration.count() / 1000.0 << " ms\n";
+
+    if (optimization_criteria == 'o' && !route.first.empty()) {
+        std::time_t departure = chrono::system_clock::to_time_t(route.first.front().getDepartureTime());
+        std::cout << "Najpóźniejszy odjazd: " << std::put_time(std::localtime(&departure), "%F %T") << std::endl;
     }
     return route;
 }
@@ -11,6 +11,8 @@
 #include <vector>
 #include <chrono>
 #include "../graph/edge.h"
+
+class query_executor;
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -18,7 +20,8 @@
 class user_cli {
 public:
     user_cli();
-std::pair<std::vector<edge>,double> execute(const std::vector<edge>& edges);
+// Wykonuje zebrane zapytanie na rozkładzie wczytanym raz przez wywołującego
+std::pair<std::vector<edge>,double> execute(query_executor& executor);
 
     std::string get_start_stop() const;
     std::string get_end_stop() const;
@@ -30,12 +33,14 @@ std::pair<std::vector<edge>,double> execute(const std::vector<edge>& edges);
 private:
     void gatherBasicData();
     void gatherAlgorithmChoice();
+    // Nazwa z rozkładu dla wpisanego przystanku; przy nieznanej nazwie podpowiada i pyta ponownie
+    bool resolveStop(const query_executor &executor, std::string &stop, const char *label);
 
     std::string start_stop;
     std::string end_stop;
-    char optimization_criteria; // 't' - czasowe, 'p' - przesiadkowe
+    char optimization_criteria; // 't' - czasowe, 'p' - przesiadkowe, 'o' - przyjazd na czas
     std::chrono::system_clock::time_point start_time;
-    int algorithm_choice; // 1 - Dijkstra, 2 - A*, 3 - Tabu Search
+    int algorithm_choice; // 1 - Dijkstra, 2 - A*, 3 - Tabu Search, 4 - Tabu Search Knox, 5 - Trip-Based, 6 - Transfer Patterns
     std::vector<std::string> excluded_stops;
 };
 